@@ -0,0 +1,322 @@
+/// @file
+/// @brief Defines and implements a minimal JSON value, writer and parser for benchmark reports
+
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Kvs { namespace Bench { namespace Json {
+
+/// @brief A JSON value; only what the benchmark reports need
+/// @note Numbers are held as double, objects keep their keys sorted
+class Value
+{
+public:
+
+    /// @brief The kinds of JSON value
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    /// @brief Constructs a null value
+    Value() : m_type(Type::Null), m_bool(false), m_number(0) { }
+    /// @brief Constructs a boolean value
+    Value(bool value) : m_type(Type::Bool), m_bool(value), m_number(0) { }
+    /// @brief Constructs a number value
+    Value(double value) : m_type(Type::Number), m_bool(false), m_number(value) { }
+    /// @brief Constructs a number value
+    Value(int value) : Value(static_cast<double>(value)) { }
+    /// @brief Constructs a number value
+    Value(size_t value) : Value(static_cast<double>(value)) { }
+    /// @brief Constructs a string value
+    Value(const std::string& value) : m_type(Type::String), m_bool(false), m_number(0), m_string(value) { }
+    /// @brief Constructs a string value
+    Value(const char* value) : Value(std::string(value)) { }
+
+    /// @brief Returns an empty array value
+    static Value Array() { Value value; value.m_type = Type::Array; return value; }
+    /// @brief Returns an empty object value
+    static Value Object() { Value value; value.m_type = Type::Object; return value; }
+
+    /// @brief The kind of this value
+    Type GetType() const { return m_type; }
+    /// @brief The boolean held, false if not a boolean
+    bool AsBool() const { return m_bool; }
+    /// @brief The number held, zero if not a number
+    double AsNumber() const { return m_number; }
+    /// @brief The string held, empty if not a string
+    const std::string& AsString() const { return m_string; }
+    /// @brief The elements held, empty if not an array
+    const std::vector<Value>& AsArray() const { return m_array; }
+    /// @brief The members held, empty if not an object
+    const std::map<std::string, Value>& AsObject() const { return m_object; }
+
+    /// @brief Appends an element to an array value
+    Value& Append(const Value& element) { m_array.push_back(element); return m_array.back(); }
+
+    /// @brief Returns the member with the provided name, inserting null if absent
+    Value& operator[](const std::string& name) { return m_object[name]; }
+
+    /// @brief Returns the member with the provided name, or null if absent
+    const Value& Get(const std::string& name) const
+    {
+        static const Value null;
+        auto iter = m_object.find(name);
+        return iter != m_object.end() ? iter->second : null;
+    }
+
+    /// @brief Writes this value as indented JSON
+    void Write(std::ostream& stream, size_t indent = 0) const
+    {
+        const std::string padding(indent + 2, ' ');
+        switch (m_type)
+        {
+            case Type::Null:   stream << "null"; break;
+            case Type::Bool:   stream << (m_bool ? "true" : "false"); break;
+            case Type::Number: WriteNumber(stream, m_number); break;
+            case Type::String: WriteString(stream, m_string); break;
+            case Type::Array:
+                stream << "[";
+                for (size_t i = 0; i < m_array.size(); ++i)
+                {
+                    stream << (i ? ",\n" : "\n") << padding;
+                    m_array[i].Write(stream, indent + 2);
+                }
+                stream << (m_array.empty() ? "" : "\n" + std::string(indent, ' ')) << "]";
+                break;
+            case Type::Object:
+            {
+                stream << "{";
+                bool first = true;
+                for (const auto& member : m_object)
+                {
+                    stream << (first ? "\n" : ",\n") << padding;
+                    WriteString(stream, member.first);
+                    stream << ": ";
+                    member.second.Write(stream, indent + 2);
+                    first = false;
+                }
+                stream << (m_object.empty() ? "" : "\n" + std::string(indent, ' ')) << "}";
+                break;
+            }
+        }
+    }
+
+    /// @brief Parses a JSON document, returning false if it is malformed
+    static bool Parse(const std::string& text, Value& value)
+    {
+        size_t position = 0;
+        if (!ParseValue(text, position, value))
+        {
+            return false;
+        }
+        SkipWhitespace(text, position);
+        return position == text.size();
+    }
+
+protected:
+
+    /// @brief Writes a number, integral values without a fraction
+    static void WriteNumber(std::ostream& stream, double number)
+    {
+        std::ostringstream text;
+        if (number == static_cast<double>(static_cast<long long>(number)))
+        {
+            text << static_cast<long long>(number);
+        }
+        else
+        {
+            text.precision(15);
+            text << number;
+        }
+        stream << text.str();
+    }
+
+    /// @brief Writes an escaped string
+    static void WriteString(std::ostream& stream, const std::string& text)
+    {
+        stream << '"';
+        for (char c : text)
+        {
+            switch (c)
+            {
+                case '"':  stream << "\\\""; break;
+                case '\\': stream << "\\\\"; break;
+                case '\n': stream << "\\n"; break;
+                case '\t': stream << "\\t"; break;
+                default:   stream << c; break;
+            }
+        }
+        stream << '"';
+    }
+
+    /// @brief Advances past any whitespace
+    static void SkipWhitespace(const std::string& text, size_t& position)
+    {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+        {
+            ++position;
+        }
+    }
+
+    /// @brief Consumes the provided literal if it is next
+    static bool Consume(const std::string& text, size_t& position, const char* literal)
+    {
+        std::string expected(literal);
+        if (text.compare(position, expected.size(), expected) == 0)
+        {
+            position += expected.size();
+            return true;
+        }
+        return false;
+    }
+
+    /// @brief Parses a string starting at its opening quote
+    static bool ParseString(const std::string& text, size_t& position, std::string& result)
+    {
+        if (position >= text.size() || text[position] != '"')
+        {
+            return false;
+        }
+        ++position;
+        while (position < text.size() && text[position] != '"')
+        {
+            char c = text[position++];
+            if (c == '\\' && position < text.size())
+            {
+                char escaped = text[position++];
+                switch (escaped)
+                {
+                    case 'n': result += '\n'; break;
+                    case 't': result += '\t'; break;
+                    case 'r': result += '\r'; break;
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    default:  result += escaped; break;
+                }
+            }
+            else
+            {
+                result += c;
+            }
+        }
+        if (position >= text.size())
+        {
+            return false;
+        }
+        ++position; // closing quote
+        return true;
+    }
+
+    /// @brief Parses any value
+    static bool ParseValue(const std::string& text, size_t& position, Value& value)
+    {
+        SkipWhitespace(text, position);
+        if (position >= text.size())
+        {
+            return false;
+        }
+        char c = text[position];
+        if (c == '{')
+        {
+            value = Object();
+            ++position;
+            SkipWhitespace(text, position);
+            if (Consume(text, position, "}"))
+            {
+                return true;
+            }
+            do
+            {
+                std::string name;
+                SkipWhitespace(text, position);
+                if (!ParseString(text, position, name))
+                {
+                    return false;
+                }
+                SkipWhitespace(text, position);
+                if (!Consume(text, position, ":") || !ParseValue(text, position, value.m_object[name]))
+                {
+                    return false;
+                }
+                SkipWhitespace(text, position);
+            } while (Consume(text, position, ","));
+            return Consume(text, position, "}");
+        }
+        if (c == '[')
+        {
+            value = Array();
+            ++position;
+            SkipWhitespace(text, position);
+            if (Consume(text, position, "]"))
+            {
+                return true;
+            }
+            do
+            {
+                value.m_array.emplace_back();
+                if (!ParseValue(text, position, value.m_array.back()))
+                {
+                    return false;
+                }
+                SkipWhitespace(text, position);
+            } while (Consume(text, position, ","));
+            return Consume(text, position, "]");
+        }
+        if (c == '"')
+        {
+            std::string result;
+            if (!ParseString(text, position, result))
+            {
+                return false;
+            }
+            value = Value(result);
+            return true;
+        }
+        if (Consume(text, position, "true"))
+        {
+            value = Value(true);
+            return true;
+        }
+        if (Consume(text, position, "false"))
+        {
+            value = Value(false);
+            return true;
+        }
+        if (Consume(text, position, "null"))
+        {
+            value = Value();
+            return true;
+        }
+        const char* begin = text.c_str() + position;
+        char* end = nullptr;
+        double number = std::strtod(begin, &end);
+        if (end == begin)
+        {
+            return false;
+        }
+        position += end - begin;
+        value = Value(number);
+        return true;
+    }
+
+    /// @brief The kind of value held
+    Type m_type;
+    /// @brief Held when m_type is Type::Bool
+    bool m_bool;
+    /// @brief Held when m_type is Type::Number
+    double m_number;
+    /// @brief Held when m_type is Type::String
+    std::string m_string;
+    /// @brief Held when m_type is Type::Array
+    std::vector<Value> m_array;
+    /// @brief Held when m_type is Type::Object
+    std::map<std::string, Value> m_object;
+};
+
+} } } // namespace Kvs::Bench::Json
@@ -0,0 +1,456 @@
+/// @file
+/// @brief A configurable benchmark runner for the key->value stores with JSON output and regression compare
+
+#include "Registry.h"
+#include "Json.h"
+#include "Workload.h"
+#include "Footprint.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Everything the command line can configure
+struct Options
+{
+    size_t keys = 10000;
+    size_t valueSize = sizeof(Kvs::Test::Schema::ValueType);
+    std::vector<size_t> threads = { 1, 2, 4 };
+    double duration = 3.0;
+    std::string workload = "A";
+    std::string distribution;
+    double theta = 0.99;
+    std::vector<std::string> stores = { "*" };
+    uint64_t seed = static_cast<uint64_t>(time(nullptr));
+    std::string output;
+    std::string compare;
+    double threshold = 10.0;
+    bool list = false;
+    bool memory = false;
+};
+
+void Usage(std::ostream& stream)
+{
+    stream <<
+        "Usage: KeyValueStoreBench [options]\n"
+        "  --keys N              keys loaded before each run (default 10000)\n"
+        "  --value-size N        bytes per value; fixed at compile time by Kvs::Test::Schema::ValueType ("
+                                 << sizeof(Kvs::Test::Schema::ValueType) << ")\n"
+        "  --threads LIST        comma-separated thread counts (default 1,2,4)\n"
+        "  --duration SECONDS    time per run (default 3)\n"
+        "  --workload A-F        YCSB core workload (default A)\n"
+        "  --distribution NAME   uniform, zipfian, latest or hotspot (default: the workload's own)\n"
+        "  --theta T             Zipfian skew in (0, 1) (default 0.99)\n"
+        "  --stores LIST         comma-separated shell patterns selecting stores (default *)\n"
+        "  --seed N              seed for keys and request streams (default: time)\n"
+        "  --output FILE         write the JSON report to FILE instead of stdout\n"
+        "  --compare FILE        compare against a saved JSON report, exit 1 on regression\n"
+        "  --threshold PERCENT   tolerated throughput drop or p99 latency rise (default 10)\n"
+        "  --memory              report bytes per entry, allocations and peak RSS after\n"
+        "                        loading --keys keys, instead of running a workload\n"
+        "  --list                list the registered stores and exit\n";
+}
+
+std::vector<std::string> Split(const std::string& text)
+{
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ','))
+    {
+        if (!part.empty())
+        {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--list")
+        {
+            options.list = true;
+            continue;
+        }
+        if (argument == "--memory")
+        {
+            options.memory = true;
+            continue;
+        }
+        if (argument == "--help" || argument == "-h")
+        {
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (argument == "--keys")
+        {
+            options.keys = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (argument == "--value-size")
+        {
+            options.valueSize = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (argument == "--threads")
+        {
+            options.threads.clear();
+            for (const auto& count : Split(value))
+            {
+                options.threads.push_back(std::strtoull(count.c_str(), nullptr, 10));
+            }
+        }
+        else if (argument == "--duration")
+        {
+            options.duration = std::strtod(value.c_str(), nullptr);
+        }
+        else if (argument == "--workload")
+        {
+            options.workload = value;
+        }
+        else if (argument == "--distribution")
+        {
+            options.distribution = value;
+        }
+        else if (argument == "--theta")
+        {
+            options.theta = std::strtod(value.c_str(), nullptr);
+        }
+        else if (argument == "--stores")
+        {
+            options.stores = Split(value);
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (argument == "--output")
+        {
+            options.output = value;
+        }
+        else if (argument == "--compare")
+        {
+            options.compare = value;
+        }
+        else if (argument == "--threshold")
+        {
+            options.threshold = std::strtod(value.c_str(), nullptr);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MakeMix(const Options& options, Kvs::Test::Workload::Mix& mix)
+{
+    using namespace Kvs::Test::Workload;
+    if      (options.workload == "A") mix = WorkloadA();
+    else if (options.workload == "B") mix = WorkloadB();
+    else if (options.workload == "C") mix = WorkloadC();
+    else if (options.workload == "D") mix = WorkloadD();
+    else if (options.workload == "E") mix = WorkloadE();
+    else if (options.workload == "F") mix = WorkloadF();
+    else
+    {
+        std::cerr << "Unknown workload " << options.workload << std::endl;
+        return false;
+    }
+    if (!options.distribution.empty())
+    {
+        const Distribution distributions[] =
+            { Distribution::Uniform, Distribution::Zipfian, Distribution::Latest, Distribution::Hotspot };
+        bool found = false;
+        for (auto distribution : distributions)
+        {
+            if (options.distribution == Name(distribution))
+            {
+                mix = mix.With(distribution);
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            std::cerr << "Unknown distribution " << options.distribution << std::endl;
+            return false;
+        }
+    }
+    mix.zipfianTheta = options.theta;
+    return true;
+}
+
+/// @brief Builds the JSON description of one run
+Kvs::Bench::Json::Value MakeResult(const std::string& store, size_t threads,
+                                   const Kvs::Test::Workload::Result& result)
+{
+    using Kvs::Bench::Json::Value;
+    Value json = Value::Object();
+    json["store"] = store;
+    json["threads"] = threads;
+    json["seconds"] = result.seconds;
+    json["opsPerSec"] = result.Throughput();
+    Value operations = Value::Object();
+    for (size_t op = 0; op < result.operations.size(); ++op)
+    {
+        operations[Kvs::Test::Workload::Name(static_cast<Kvs::Test::Workload::Operation>(op))] = result.operations[op];
+    }
+    json["operations"] = operations;
+    Value latency = Value::Object();
+    latency["samples"] = static_cast<size_t>(result.latency.Count());
+    latency["mean"] = result.latency.Mean();
+    latency["p50"] = static_cast<size_t>(result.latency.Percentile(50));
+    latency["p99"] = static_cast<size_t>(result.latency.Percentile(99));
+    latency["p999"] = static_cast<size_t>(result.latency.Percentile(99.9));
+    latency["max"] = static_cast<size_t>(result.latency.Max());
+    json["latencyNs"] = latency;
+    if (result.counters.Any())
+    {
+        Value counters = Value::Object();
+        for (size_t event = 0; event < Kvs::Test::PerfCounters::EventCount; ++event)
+        {
+            if (result.counters.valid[event])
+            {
+                counters[Kvs::Test::PerfCounters::Name(event)] =
+                    static_cast<double>(result.counters.counts[event]) / std::max<size_t>(1, result.Total());
+            }
+        }
+        json["countersPerOp"] = counters;
+    }
+    else
+    {
+        json["countersError"] = result.counterError;
+    }
+    return json;
+}
+
+/// @brief Builds the JSON description of one memory measurement
+Kvs::Bench::Json::Value MakeFootprintResult(const std::string& store, const Kvs::Test::Footprint& footprint)
+{
+    using Kvs::Bench::Json::Value;
+    Value json = Value::Object();
+    json["store"] = store;
+    json["entries"] = footprint.entries;
+    json["heapBytes"] = static_cast<double>(footprint.heapBytes);
+    json["peakHeapBytes"] = static_cast<double>(footprint.peakHeapBytes);
+    json["bytesPerEntry"] = footprint.BytesPerEntry();
+    json["allocations"] = static_cast<double>(footprint.allocations);
+    json["allocationsPerEntry"] = footprint.AllocationsPerEntry();
+    json["peakRssBytes"] = footprint.rssAvailable ? Value(footprint.peakRssBytes) : Value();
+    return json;
+}
+
+/// @brief Adds frontEndBytesPerEntry to every Compound result whose back-end was measured on its own
+void AddFrontEndOverhead(Kvs::Bench::Json::Value& results)
+{
+    using Kvs::Bench::Json::Value;
+    Value updated = Value::Array();
+    for (auto result : results.AsArray())
+    {
+        auto backEnd = Kvs::Test::CompoundBackEndName(result.Get("store").AsString());
+        for (const auto& other : results.AsArray())
+        {
+            if (!backEnd.empty() && other.Get("store").AsString() == backEnd)
+            {
+                result["frontEndBytesPerEntry"] =
+                    result.Get("bytesPerEntry").AsNumber() - other.Get("bytesPerEntry").AsNumber();
+            }
+        }
+        updated.Append(result);
+    }
+    results = updated;
+}
+
+/// @brief Compares a report against a baseline, printing a table; returns the number of regressions
+size_t Compare(const Kvs::Bench::Json::Value& baseline, const Kvs::Bench::Json::Value& current, double threshold)
+{
+    size_t regressions = 0;
+    for (const auto& setting : { "keys", "workload", "distribution", "theta" })
+    {
+        const auto& before = baseline.Get("config").Get(setting);
+        const auto& after = current.Get("config").Get(setting);
+        if (before.AsString() != after.AsString() || before.AsNumber() != after.AsNumber())
+        {
+            std::cerr << "Warning: baseline was run with a different " << setting << std::endl;
+        }
+    }
+    std::cerr << std::left << std::setw(52) << "store" << std::right
+              << std::setw(8) << "threads" << std::setw(12) << "ops/sec" << std::setw(10) << "change"
+              << std::setw(10) << "p99 ns" << std::setw(10) << "change" << std::endl;
+    for (const auto& result : current.Get("results").AsArray())
+    {
+        const auto& store = result.Get("store").AsString();
+        size_t threads = static_cast<size_t>(result.Get("threads").AsNumber());
+        const Kvs::Bench::Json::Value* match = nullptr;
+        for (const auto& candidate : baseline.Get("results").AsArray())
+        {
+            if (candidate.Get("store").AsString() == store && candidate.Get("threads").AsNumber() == static_cast<double>(threads))
+            {
+                match = &candidate;
+            }
+        }
+        std::cerr << std::left << std::setw(52) << store << std::right << std::setw(8) << threads;
+        if (!match)
+        {
+            std::cerr << "  (not in baseline)" << std::endl;
+            continue;
+        }
+        double baseOps = match->Get("opsPerSec").AsNumber();
+        double ops = result.Get("opsPerSec").AsNumber();
+        double baseP99 = match->Get("latencyNs").Get("p99").AsNumber();
+        double p99 = result.Get("latencyNs").Get("p99").AsNumber();
+        double opsChange = baseOps > 0 ? (ops - baseOps) / baseOps * 100.0 : 0.0;
+        double p99Change = baseP99 > 0 ? (p99 - baseP99) / baseP99 * 100.0 : 0.0;
+        bool regressed = opsChange < -threshold || p99Change > threshold;
+        std::cerr << std::fixed << std::setprecision(1)
+                  << std::setw(12) << static_cast<size_t>(ops) << std::setw(9) << opsChange << "%"
+                  << std::setw(10) << static_cast<size_t>(p99) << std::setw(9) << p99Change << "%"
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+        regressions += regressed;
+    }
+    return regressions;
+}
+
+} // namespace anonymous
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        Usage(std::cerr);
+        return 2;
+    }
+    if (options.list)
+    {
+        for (const auto& store : Kvs::Bench::Registry())
+        {
+            std::cout << store.name << std::endl;
+        }
+        return 0;
+    }
+    if (options.valueSize != sizeof(Kvs::Test::Schema::ValueType))
+    {
+        std::cerr << "Value size is fixed at compile time by Kvs::Test::Schema::ValueType ("
+                  << sizeof(Kvs::Test::Schema::ValueType) << " bytes)" << std::endl;
+        return 2;
+    }
+    if (options.memory && !options.compare.empty())
+    {
+        std::cerr << "--compare applies to throughput reports only" << std::endl;
+        return 2;
+    }
+    if (options.keys == 0 || options.threads.empty() || options.duration <= 0)
+    {
+        Usage(std::cerr);
+        return 2;
+    }
+    Kvs::Test::Workload::Mix mix;
+    if (!MakeMix(options, mix))
+    {
+        return 2;
+    }
+    auto stores = Kvs::Bench::Select(options.stores);
+    if (stores.empty())
+    {
+        std::cerr << "No registered store matches --stores" << std::endl;
+        return 2;
+    }
+
+    using Kvs::Bench::Json::Value;
+    Value report = Value::Object();
+    Value config = Value::Object();
+    config["mode"] = options.memory ? "memory" : "throughput";
+    config["keys"] = options.keys;
+    config["valueSize"] = options.valueSize;
+    config["seed"] = static_cast<size_t>(options.seed);
+    if (!options.memory)
+    {
+        config["duration"] = options.duration;
+        config["workload"] = options.workload;
+        config["distribution"] = Kvs::Test::Workload::Name(mix.distribution);
+        config["theta"] = mix.zipfianTheta;
+    }
+    report["config"] = config;
+    report["results"] = Value::Array();
+
+    auto keys = Kvs::Test::Workload::GenerateKeys(options.seed, options.keys * (options.memory ? 1 : 2));
+    auto duration = std::chrono::milliseconds(static_cast<long long>(options.duration * 1000));
+    for (const auto& store : stores)
+    {
+        if (options.memory)
+        {
+            auto footprint = Kvs::Test::MeasureFootprint(store.create, keys, options.keys);
+            std::cerr << std::left << std::setw(52) << store.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << footprint.BytesPerEntry() << " bytes/entry "
+                      << std::setw(6) << footprint.AllocationsPerEntry() << " allocs/entry" << std::endl;
+            report["results"].Append(MakeFootprintResult(store.name, footprint));
+            continue;
+        }
+        for (auto threads : options.threads)
+        {
+            Kvs::Test::Workload::Driver driver(store.create(), keys, mix, options.keys);
+            driver.Load();
+            auto result = driver.Run(threads, duration, options.seed);
+            std::cerr << std::left << std::setw(52) << store.name << std::right << std::setw(4) << threads
+                      << " threads " << std::setw(12) << result.Throughput() << " ops/sec  p99 "
+                      << result.latency.Percentile(99) << " ns" << std::endl;
+            report["results"].Append(MakeResult(store.name, threads, result));
+        }
+    }
+
+    if (options.memory)
+    {
+        AddFrontEndOverhead(report["results"]);
+    }
+
+    if (options.output.empty())
+    {
+        report.Write(std::cout);
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::ofstream file(options.output);
+        report.Write(file);
+        file << std::endl;
+    }
+
+    if (!options.compare.empty())
+    {
+        std::ifstream file(options.compare);
+        std::stringstream text;
+        text << file.rdbuf();
+        Value baseline;
+        if (!file || !Value::Parse(text.str(), baseline))
+        {
+            std::cerr << "Could not read baseline report " << options.compare << std::endl;
+            return 2;
+        }
+        size_t regressions = Compare(baseline, report, options.threshold);
+        if (regressions)
+        {
+            std::cerr << regressions << " regression(s) beyond " << options.threshold << "%" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
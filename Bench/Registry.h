@@ -0,0 +1,108 @@
+/// @file
+/// @brief Defines and implements the runtime registry of benchmarkable key->value stores
+
+#pragma once
+
+#include "Schema.h"
+#include "Factories.h"
+#include <fnmatch.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Kvs { namespace Bench {
+
+/// @brief A named factory for a key->value store
+struct RegisteredStore
+{
+    /// @brief Name used on the command line and in reports
+    std::string name;
+
+    /// @brief Creates a fresh, empty instance of the store
+    std::function<Kvs::Test::Schema::KeyValueStoreSharedPtr()> create;
+};
+
+/// @brief Helper that names and registers a Factories.h store type with each lock policy
+template <template <typename> class StoreType>
+void Register(std::vector<RegisteredStore>& registry, const std::string& name)
+{
+    registry.push_back({ name + "<StdMutex>", &Kvs::Test::Factory<StoreType<Kvs::Lock::StdMutex>>::Create });
+    registry.push_back({ name + "<Spin>", &Kvs::Test::Factory<StoreType<Kvs::Lock::Spin>>::Create });
+}
+
+/// @brief Returns every store the benchmark knows how to build
+/// @note Only thread-safe lock policies are registered since runs are multi-threaded
+inline const std::vector<RegisteredStore>& Registry()
+{
+    static std::vector<RegisteredStore> registry;
+    if (registry.empty())
+    {
+        registry.push_back({ "NoOp", &Kvs::Test::Factory<Kvs::Test::NoOp<Kvs::Lock::None>>::Create });
+        Register<Kvs::Test::StdMap>(registry, "StdMap");
+        Register<Kvs::Test::StdUnorderedMap>(registry, "StdUnorderedMap");
+        Register<Kvs::Test::GnuTree>(registry, "GnuTree");
+        Register<Kvs::Test::GnuTrie>(registry, "GnuTrie");
+        Register<Kvs::Test::GnuCcHashTable>(registry, "GnuCcHashTable");
+        Register<Kvs::Test::GnuGpHashTable>(registry, "GnuGpHashTable");
+        Register<Kvs::Test::EpochHashTable>(registry, "EpochHashTable");
+        Register<Kvs::Test::Rcu_StdUnorderedMap>(registry, "Rcu_StdUnorderedMap");
+        Register<Kvs::Test::Mvcc>(registry, "Mvcc");
+        Register<Kvs::Test::SkipList>(registry, "SkipList");
+        Register<Kvs::Test::Art>(registry, "Art");
+        registry.push_back({ "BTree", &Kvs::Test::Factory<Kvs::Test::BTree<Kvs::Lock::None>>::Create });
+        registry.push_back({ "Cuckoo", &Kvs::Test::Factory<Kvs::Test::Cuckoo<Kvs::Lock::None>>::Create });
+        Register<Kvs::Test::RobinHood>(registry, "RobinHood");
+        Register<Kvs::Test::Hopscotch>(registry, "Hopscotch");
+        Register<Kvs::Test::Cache_Clock>(registry, "Cache_Clock");
+        Register<Kvs::Test::Cache_SegmentedLru>(registry, "Cache_SegmentedLru");
+        Register<Kvs::Test::Cache_S3Fifo>(registry, "Cache_S3Fifo");
+        Register<Kvs::Test::Expiring_StdUnorderedMap>(registry, "Expiring_StdUnorderedMap");
+        Register<Kvs::Test::Lsm_StdMap>(registry, "Lsm_StdMap");
+        Register<Kvs::Test::BlockedBloom_Compound_ArrayTable_StdMap>(registry, "BlockedBloom_Compound_ArrayTable_StdMap");
+        Register<Kvs::Test::CountingBloom_Compound_ArrayTable_StdMap>(registry, "CountingBloom_Compound_ArrayTable_StdMap");
+        Register<Kvs::Test::Compound_StdUnorderedMap_StdMap>(registry, "Compound_StdUnorderedMap_StdMap");
+        Register<Kvs::Test::Compound_StdUnorderedMap_StdUnorderedMap>(registry, "Compound_StdUnorderedMap_StdUnorderedMap");
+        Register<Kvs::Test::Compound_StdUnorderedMap_GnuTree>(registry, "Compound_StdUnorderedMap_GnuTree");
+        Register<Kvs::Test::Compound_StdUnorderedMap_GnuTrie>(registry, "Compound_StdUnorderedMap_GnuTrie");
+        Register<Kvs::Test::Compound_StdUnorderedMap_GnuCcHashTable>(registry, "Compound_StdUnorderedMap_GnuCcHashTable");
+        Register<Kvs::Test::Compound_StdUnorderedMap_GnuGpHashTable>(registry, "Compound_StdUnorderedMap_GnuGpHashTable");
+        Register<Kvs::Test::Compound_ArrayTable_StdMap>(registry, "Compound_ArrayTable_StdMap");
+        Register<Kvs::Test::Compound_ArrayTable_StdUnorderedMap>(registry, "Compound_ArrayTable_StdUnorderedMap");
+        Register<Kvs::Test::Compound_ArrayTable_GnuTree>(registry, "Compound_ArrayTable_GnuTree");
+        Register<Kvs::Test::Compound_ArrayTable_GnuTrie>(registry, "Compound_ArrayTable_GnuTrie");
+        Register<Kvs::Test::Compound_ArrayTable_GnuCcHashTable>(registry, "Compound_ArrayTable_GnuCcHashTable");
+        Register<Kvs::Test::Compound_ArrayTable_GnuGpHashTable>(registry, "Compound_ArrayTable_GnuGpHashTable");
+        Register<Kvs::Test::Compound_ArrayTable_Art>(registry, "Compound_ArrayTable_Art");
+        Register<Kvs::Test::Compound_GnuTrie_StdMap>(registry, "Compound_GnuTrie_StdMap");
+        Register<Kvs::Test::Compound_GnuTrie_StdUnorderedMap>(registry, "Compound_GnuTrie_StdUnorderedMap");
+        Register<Kvs::Test::Compound_GnuTrie_GnuTree>(registry, "Compound_GnuTrie_GnuTree");
+        Register<Kvs::Test::Compound_GnuTrie_GnuTrie>(registry, "Compound_GnuTrie_GnuTrie");
+        Register<Kvs::Test::Compound_GnuTrie_GnuCcHashTable>(registry, "Compound_GnuTrie_GnuCcHashTable");
+        Register<Kvs::Test::Compound_GnuTrie_GnuGpHashTable>(registry, "Compound_GnuTrie_GnuGpHashTable");
+        Register<Kvs::Test::Compound_Art_StdMap>(registry, "Compound_Art_StdMap");
+        Register<Kvs::Test::Compound_Art_StdUnorderedMap>(registry, "Compound_Art_StdUnorderedMap");
+        Register<Kvs::Test::Compound_Art_Art>(registry, "Compound_Art_Art");
+        Register<Kvs::Test::Compound_EpochHashTable_EpochHashTable>(registry, "Compound_EpochHashTable_EpochHashTable");
+    }
+    return registry;
+}
+
+/// @brief Returns the registered stores whose name matches any of the provided shell-style patterns
+inline std::vector<RegisteredStore> Select(const std::vector<std::string>& patterns)
+{
+    std::vector<RegisteredStore> selected;
+    for (const auto& store : Registry())
+    {
+        for (const auto& pattern : patterns)
+        {
+            if (fnmatch(pattern.c_str(), store.name.c_str(), 0) == 0)
+            {
+                selected.push_back(store);
+                break;
+            }
+        }
+    }
+    return selected;
+}
+
+} } // namespace Kvs::Bench
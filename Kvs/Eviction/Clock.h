@@ -0,0 +1,102 @@
+/// @file
+/// @brief Defines and implements the Kvs::Eviction::Clock class
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kvs { namespace Eviction {
+
+/// @brief The CLOCK eviction policy, a cheap approximation of LRU
+/// Slots sit on a circle swept by a hand. A hit only sets the slot's
+/// reference bit; the hand clears set bits as it passes, giving those slots
+/// a second chance, and evicts the first slot it finds clear.
+/// @note Touch() may be called from any thread at any time, without locking.
+/// Every other call must be serialized by the caller, e.g. KeyValueStore::Cache.
+class Clock
+{
+public:
+
+    /// @brief What Admit() sets its victim to when nothing had to be evicted
+    static const size_t NoSlot = SIZE_MAX;
+
+    /// @brief Constructor
+    /// @param capacity number of slots, at least one
+    explicit Clock(size_t capacity)
+        : m_referenced(new std::atomic<uint8_t>[capacity]), m_free(), m_capacity(capacity), m_hand(0)
+    {
+        for (size_t slot = capacity; slot-- > 0; )
+        {
+            m_referenced[slot].store(0, std::memory_order_relaxed);
+            m_free.push_back(slot);
+        }
+    }
+
+    /// @brief Returns the slot for a new key, evicting the key of the same slot if all are taken
+    /// @param hash the new key's hash, unused
+    /// @param victim set to the slot whose key must be evicted, or NoSlot
+    size_t Admit(uint64_t hash, size_t& victim)
+    {
+        if (!m_free.empty())
+        {
+            victim = NoSlot;
+            size_t slot = m_free.back();
+            m_free.pop_back();
+            return slot;
+        }
+        while (m_referenced[m_hand].load(std::memory_order_relaxed))
+        {
+            m_referenced[m_hand].store(0, std::memory_order_relaxed);
+            Advance();
+        }
+        victim = m_hand;
+        Advance();
+        return victim;
+    }
+
+    /// @brief Records a hit on the provided slot
+    void Touch(size_t slot)
+    {
+        // read first, so the hot slots' cache lines are not written on every hit
+        if (!m_referenced[slot].load(std::memory_order_relaxed))
+        {
+            m_referenced[slot].store(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Frees the provided slot, whose key was removed
+    void Forget(size_t slot)
+    {
+        m_referenced[slot].store(0, std::memory_order_relaxed);
+        m_free.push_back(slot);
+    }
+
+protected:
+
+    /// @brief Moves the hand on to the next slot
+    void Advance()
+    {
+        if (++m_hand == m_capacity)
+        {
+            m_hand = 0;
+        }
+    }
+
+    /// @brief The reference bit of each slot
+    std::unique_ptr<std::atomic<uint8_t>[]> m_referenced;
+
+    /// @brief Slots holding no key
+    std::vector<size_t> m_free;
+
+    /// @brief Number of slots
+    size_t m_capacity;
+
+    /// @brief The slot the hand points at
+    size_t m_hand;
+};
+
+} } // namespace Kvs::Eviction
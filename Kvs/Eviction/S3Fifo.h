@@ -0,0 +1,203 @@
+/// @file
+/// @brief Defines and implements the Kvs::Eviction::S3Fifo class
+
+#pragma once
+
+#include "SlotLists.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Kvs { namespace Eviction {
+
+/// @brief The S3-FIFO eviction policy of Yang et al., "FIFO queues are all you need for cache eviction"
+/// New keys enter a small FIFO queue holding SmallPercent of the slots.
+/// A key leaving it is evicted unless it was hit meanwhile, in which case it
+/// moves to the main FIFO queue; most keys of skewed workloads are never read
+/// again and so leave after a short stay. The main queue gives keys that were
+/// hit another lap, one per hit up to MaxFrequency, before evicting them.
+/// The hashes of keys evicted from the small queue are remembered in a ghost
+/// queue as long as the main queue, and such a key coming back goes straight
+/// to the main queue. A hit only bumps a small saturating counter.
+/// @note Touch() may be called from any thread at any time, without locking.
+/// Every other call must be serialized by the caller, e.g. KeyValueStore::Cache.
+class S3Fifo
+{
+public:
+
+    /// @brief What Admit() sets its victim to when nothing had to be evicted
+    static const size_t NoSlot = SIZE_MAX;
+
+    /// @brief Share of the slots the small queue aims to hold
+    static const size_t SmallPercent = 10;
+
+    /// @brief Hits counted per key; more give no more laps of the main queue
+    static const uint8_t MaxFrequency = 3;
+
+    /// @brief Constructor
+    /// @param capacity number of slots, at least one
+    explicit S3Fifo(size_t capacity)
+        : m_lists(capacity)
+        , m_queues(capacity, Free)
+        , m_frequencies(new std::atomic<uint8_t>[capacity])
+        , m_hashes(capacity, 0)
+        , m_free()
+        , m_small()
+        , m_main()
+        , m_smallCapacity(capacity * SmallPercent / 100 ? capacity * SmallPercent / 100 : 1)
+        , m_ghost()
+        , m_ghostCounts()
+    {
+        for (size_t slot = capacity; slot-- > 0; )
+        {
+            m_frequencies[slot].store(0, std::memory_order_relaxed);
+            m_free.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    /// @brief Returns the slot for a new key, evicting the key of the same slot if all are taken
+    /// @param hash the new key's hash, looked up in the ghost queue
+    /// @param victim set to the slot whose key must be evicted, or NoSlot
+    size_t Admit(uint64_t hash, size_t& victim)
+    {
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            victim = NoSlot;
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            slot = Evict();
+            victim = slot;
+        }
+        m_frequencies[slot].store(0, std::memory_order_relaxed);
+        m_hashes[slot] = hash;
+        if (m_ghostCounts.count(hash))
+        {
+            m_queues[slot] = Main;
+            m_lists.PushFront(m_main, slot);
+        }
+        else
+        {
+            m_queues[slot] = Small;
+            m_lists.PushFront(m_small, slot);
+        }
+        return slot;
+    }
+
+    /// @brief Records a hit on the provided slot
+    void Touch(size_t slot)
+    {
+        // a plain load and store rather than an increment: racing hits may count once
+        uint8_t frequency = m_frequencies[slot].load(std::memory_order_relaxed);
+        if (frequency < MaxFrequency)
+        {
+            m_frequencies[slot].store(frequency + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Frees the provided slot, whose key was removed
+    void Forget(size_t slot)
+    {
+        m_lists.Unlink(m_queues[slot] == Main ? m_main : m_small, static_cast<uint32_t>(slot));
+        m_queues[slot] = Free;
+        m_free.push_back(static_cast<uint32_t>(slot));
+    }
+
+protected:
+
+    /// @brief Which queue a slot is on
+    enum Queue : uint8_t
+    {
+        Free,
+        Small,
+        Main
+    };
+
+    /// @brief Takes the slot of the key to evict off its queue
+    uint32_t Evict()
+    {
+        for (;;)
+        {
+            if (m_small.size >= m_smallCapacity || !m_main.size)
+            {
+                uint32_t slot = m_small.back;
+                m_lists.Unlink(m_small, slot);
+                if (m_frequencies[slot].load(std::memory_order_relaxed))
+                {
+                    m_frequencies[slot].store(0, std::memory_order_relaxed);
+                    m_queues[slot] = Main;
+                    m_lists.PushFront(m_main, slot);
+                    continue;
+                }
+                Remember(m_hashes[slot]);
+                return slot;
+            }
+            uint32_t slot = m_main.back;
+            m_lists.Unlink(m_main, slot);
+            uint8_t frequency = m_frequencies[slot].load(std::memory_order_relaxed);
+            if (frequency)
+            {
+                m_frequencies[slot].store(frequency - 1, std::memory_order_relaxed);
+                m_lists.PushFront(m_main, slot);
+                continue;
+            }
+            return slot;
+        }
+    }
+
+    /// @brief Adds the hash of a key evicted from the small queue to the ghost queue
+    void Remember(uint64_t hash)
+    {
+        m_ghost.push_back(hash);
+        ++m_ghostCounts[hash];
+        // as long as the main queue could be
+        while (m_ghost.size() > m_queues.size() - m_smallCapacity)
+        {
+            auto oldest = m_ghostCounts.find(m_ghost.front());
+            if (--oldest->second == 0)
+            {
+                m_ghostCounts.erase(oldest);
+            }
+            m_ghost.pop_front();
+        }
+    }
+
+    /// @brief The links of both queues
+    SlotLists m_lists;
+
+    /// @brief The queue of each slot
+    std::vector<Queue> m_queues;
+
+    /// @brief Hits of each slot's key, up to MaxFrequency
+    std::unique_ptr<std::atomic<uint8_t>[]> m_frequencies;
+
+    /// @brief The hash of each slot's key, remembered in the ghost queue if it is evicted
+    std::vector<uint64_t> m_hashes;
+
+    /// @brief Slots holding no key
+    std::vector<uint32_t> m_free;
+
+    /// @brief New keys, oldest at the back
+    SlotLists::List m_small;
+
+    /// @brief Keys hit while in the small queue or let back in from the ghost queue, oldest at the back
+    SlotLists::List m_main;
+
+    /// @brief Keys the small queue holds before it evicts rather than the main queue
+    size_t m_smallCapacity;
+
+    /// @brief Hashes of keys recently evicted from the small queue, oldest first
+    std::deque<uint64_t> m_ghost;
+
+    /// @brief How many times each hash is in m_ghost
+    std::unordered_map<uint64_t, size_t> m_ghostCounts;
+};
+
+} } // namespace Kvs::Eviction
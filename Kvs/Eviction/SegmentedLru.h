@@ -0,0 +1,199 @@
+/// @file
+/// @brief Defines and implements the Kvs::Eviction::SegmentedLru class
+
+#pragma once
+
+#include "SlotLists.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kvs { namespace Eviction {
+
+/// @brief The segmented LRU eviction policy
+/// New keys enter a probationary LRU list and move to a protected LRU list
+/// on their first hit; the protected list is capped at ProtectedPercent of
+/// the slots and demotes its least recent key back to probation. Evicting
+/// from probation only lets keys read once, e.g. by a scan, pass through
+/// without flushing the keys that are read again and again.
+/// A hit only records its slot in a small lossy buffer, at an entry picked by
+/// the slot, so readers never take the lists' lock. Each Admit() drains the
+/// next DrainWindow entries to reorder the lists, plus the entry of the key it
+/// is about to evict. A hit overwritten by one on another slot before a drain
+/// is lost, which only makes the order approximate.
+/// @note Touch() may be called from any thread at any time, without locking.
+/// Every other call must be serialized by the caller, e.g. KeyValueStore::Cache.
+class SegmentedLru
+{
+public:
+
+    /// @brief What Admit() sets its victim to when nothing had to be evicted
+    static const size_t NoSlot = SIZE_MAX;
+
+    /// @brief Share of the slots the protected segment may hold
+    static const size_t ProtectedPercent = 80;
+
+    /// @brief Entries of the buffer hits are recorded in between drains
+    /// @note Must be a power of two
+    static const size_t ReadBufferSize = 1024;
+
+    /// @brief Entries of the buffer each Admit() drains
+    /// @note Must divide ReadBufferSize
+    static const size_t DrainWindow = 64;
+
+    /// @brief Constructor
+    /// @param capacity number of slots, at least one
+    explicit SegmentedLru(size_t capacity)
+        : m_lists(capacity)
+        , m_segments(capacity, Free)
+        , m_free()
+        , m_probation()
+        , m_protected()
+        , m_protectedCapacity(capacity * ProtectedPercent / 100)
+        , m_reads(new std::atomic<uint32_t>[ReadBufferSize])
+        , m_drained(0)
+    {
+        for (size_t slot = capacity; slot-- > 0; )
+        {
+            m_free.push_back(static_cast<uint32_t>(slot));
+        }
+        for (size_t read = 0; read < ReadBufferSize; ++read)
+        {
+            m_reads[read].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Returns the slot for a new key, evicting the key of the same slot if all are taken
+    /// @param hash the new key's hash, unused
+    /// @param victim set to the slot whose key must be evicted, or NoSlot
+    size_t Admit(uint64_t hash, size_t& victim)
+    {
+        Drain();
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            victim = NoSlot;
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            // a hit on the key about to leave probation, not drained yet, still saves it
+            while (m_probation.size && Drain(m_probation.back & (ReadBufferSize - 1)))
+            {
+            }
+            auto& segment = m_probation.size ? m_probation : m_protected;
+            slot = segment.back;
+            m_lists.Unlink(segment, slot);
+            victim = slot;
+        }
+        m_segments[slot] = Probation;
+        m_lists.PushFront(m_probation, slot);
+        return slot;
+    }
+
+    /// @brief Records a hit on the provided slot
+    void Touch(size_t slot)
+    {
+        // no shared position to bump, and read first, so hits on hot slots write nothing
+        auto& read = m_reads[slot & (ReadBufferSize - 1)];
+        const uint32_t recorded = static_cast<uint32_t>(slot) + 1;
+        if (read.load(std::memory_order_relaxed) != recorded)
+        {
+            read.store(recorded, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Frees the provided slot, whose key was removed
+    void Forget(size_t slot)
+    {
+        m_lists.Unlink(m_segments[slot] == Protected ? m_protected : m_probation, static_cast<uint32_t>(slot));
+        m_segments[slot] = Free;
+        m_free.push_back(static_cast<uint32_t>(slot));
+    }
+
+protected:
+
+    /// @brief Which list a slot is on
+    enum Segment : uint8_t
+    {
+        Free,
+        Probation,
+        Protected
+    };
+
+    /// @brief Applies the hits recorded in the next DrainWindow entries
+    void Drain()
+    {
+        for (size_t read = m_drained; read < m_drained + DrainWindow; ++read)
+        {
+            Drain(read);
+        }
+        m_drained = (m_drained + DrainWindow) & (ReadBufferSize - 1);
+    }
+
+    /// @brief Applies the hit recorded in the provided entry, returning whether there was one
+    bool Drain(size_t read)
+    {
+        // read first, so entries with nothing recorded cost a load rather than a locked exchange
+        if (!m_reads[read].load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        uint32_t recorded = m_reads[read].exchange(0, std::memory_order_relaxed);
+        if (!recorded)
+        {
+            return false;
+        }
+        Promote(recorded - 1);
+        return true;
+    }
+
+    /// @brief Moves a slot that was hit to the front of the protected list
+    void Promote(uint32_t slot)
+    {
+        if (m_segments[slot] == Free)
+        {
+            // its key was removed after the hit
+            return;
+        }
+        m_lists.Unlink(m_segments[slot] == Protected ? m_protected : m_probation, slot);
+        m_segments[slot] = Protected;
+        m_lists.PushFront(m_protected, slot);
+        if (m_protected.size > m_protectedCapacity)
+        {
+            uint32_t demoted = m_protected.back;
+            m_lists.Unlink(m_protected, demoted);
+            m_segments[demoted] = Probation;
+            m_lists.PushFront(m_probation, demoted);
+        }
+    }
+
+    /// @brief The links of both segments
+    SlotLists m_lists;
+
+    /// @brief The segment of each slot
+    std::vector<Segment> m_segments;
+
+    /// @brief Slots holding no key
+    std::vector<uint32_t> m_free;
+
+    /// @brief Slots not hit since they came in or were demoted, least recent at the back
+    SlotLists::List m_probation;
+
+    /// @brief Slots hit again, least recent at the back
+    SlotLists::List m_protected;
+
+    /// @brief Most slots the protected segment holds
+    size_t m_protectedCapacity;
+
+    /// @brief Hits not applied yet, each a slot plus one, zero for none
+    std::unique_ptr<std::atomic<uint32_t>[]> m_reads;
+
+    /// @brief The first entry the next Admit() drains
+    size_t m_drained;
+};
+
+} } // namespace Kvs::Eviction
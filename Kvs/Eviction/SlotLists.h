@@ -0,0 +1,86 @@
+/// @file
+/// @brief Defines and implements the Kvs::Eviction::SlotLists class
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kvs { namespace Eviction {
+
+/// @brief Doubly linked lists of cache slots that share one set of links
+/// For the eviction policies that keep their slots in order: a slot is on
+/// at most one list at a time, so one previous and one next link per slot
+/// serve every list, and moving a slot between lists allocates nothing.
+class SlotLists
+{
+public:
+
+    /// @brief The link of a slot at either end of its list
+    static const uint32_t None = UINT32_MAX;
+
+    /// @brief One list, most recently pushed first
+    struct List
+    {
+        uint32_t front = None;
+        uint32_t back = None;
+        size_t size = 0;
+    };
+
+    /// @brief Constructor
+    explicit SlotLists(size_t slots)
+        : m_previous(slots, uint32_t(None)), m_next(slots, uint32_t(None))
+    {
+
+    }
+
+    /// @brief Puts an unlisted slot at the front of the provided list
+    void PushFront(List& list, uint32_t slot)
+    {
+        m_previous[slot] = None;
+        m_next[slot] = list.front;
+        if (list.front != None)
+        {
+            m_previous[list.front] = slot;
+        }
+        else
+        {
+            list.back = slot;
+        }
+        list.front = slot;
+        ++list.size;
+    }
+
+    /// @brief Takes a slot off the provided list, which must hold it
+    void Unlink(List& list, uint32_t slot)
+    {
+        if (m_previous[slot] != None)
+        {
+            m_next[m_previous[slot]] = m_next[slot];
+        }
+        else
+        {
+            list.front = m_next[slot];
+        }
+        if (m_next[slot] != None)
+        {
+            m_previous[m_next[slot]] = m_previous[slot];
+        }
+        else
+        {
+            list.back = m_previous[slot];
+        }
+        --list.size;
+    }
+
+protected:
+
+    /// @brief The slot before each slot on its list
+    std::vector<uint32_t> m_previous;
+
+    /// @brief The slot after each slot on its list
+    std::vector<uint32_t> m_next;
+};
+
+} } // namespace Kvs::Eviction
@@ -0,0 +1,87 @@
+/// @file
+/// @brief Defines and implements the Kvs::Expiry::Reaper class
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Kvs { namespace Expiry {
+
+/// @brief A background thread that calls Reap() on a store at a fixed interval
+/// For stores that expire keys, e.g. KeyValueStore::Expiring, in front of
+/// which nobody else would remove the expired keys. The thread keeps the
+/// store alive and is stopped and joined by the destructor.
+template <typename StoreType>
+class Reaper
+{
+public:
+
+    /// @brief Constructor, starts the thread
+    /// @param store the store to reap
+    /// @param interval how long the thread sleeps between calls
+    Reaper(std::shared_ptr<StoreType> store, std::chrono::milliseconds interval)
+        : m_store(store), m_interval(interval), m_mutex(), m_wakeUp(), m_stopped(false), m_reaped(0), m_thread()
+    {
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    /// @brief Destructor, stops and joins the thread
+    ~Reaper()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_wakeUp.notify_one();
+        m_thread.join();
+    }
+
+    /// @brief Returns the number of keys reaped so far
+    size_t GetReaped() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reaped;
+    }
+
+protected:
+
+    /// @brief The thread's loop
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wakeUp.wait_for(lock, m_interval, [this] { return m_stopped; }))
+        {
+            lock.unlock();
+            size_t reaped = m_store->Reap();
+            lock.lock();
+            m_reaped += reaped;
+        }
+    }
+
+    /// @brief The store to reap
+    std::shared_ptr<StoreType> m_store;
+
+    /// @brief How long the thread sleeps between calls
+    std::chrono::milliseconds m_interval;
+
+    /// @brief Guards m_stopped and m_reaped
+    mutable std::mutex m_mutex;
+
+    /// @brief Wakes the thread up early to stop
+    std::condition_variable m_wakeUp;
+
+    /// @brief Whether the thread should stop
+    bool m_stopped;
+
+    /// @brief Keys reaped so far
+    size_t m_reaped;
+
+    /// @brief The thread
+    std::thread m_thread;
+};
+
+} } // namespace Kvs::Expiry
@@ -0,0 +1,212 @@
+/// @file
+/// @brief Defines and implements the Kvs::Expiry::TimerWheel class
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kvs { namespace Expiry {
+
+/// @brief A hierarchical timing wheel of key deadlines, after Varghese and Lauck
+/// Time is counted in ticks. Level 0 has a slot per tick for the next
+/// SlotsPerLevel ticks, and every level above has a slot per whole turn of
+/// the level below, so Levels levels cover SlotsPerLevel^Levels ticks and
+/// farther deadlines wait in an overflow list. A timer is filed in the lowest
+/// level whose current turn holds its deadline; when the time reaches one of
+/// its slots it is filed again, one level lower or more, and it fires from
+/// level 0 at exactly its tick. Scheduling is O(1), and advancing costs one
+/// step per tick with timers due within the next SlotsPerLevel ticks, or per
+/// SlotsPerLevel ticks when none are, plus O(1) per timer per level it
+/// cascades through.
+/// @note Timers cannot be cancelled: whoever fires them checks that the key
+/// still has the deadline, e.g. KeyValueStore::Expiring.
+/// @note Not thread-safe: calls must be serialized by the caller.
+template <typename Key>
+class TimerWheel
+{
+public:
+
+    /// @brief A key and the tick it is due at
+    struct Timer
+    {
+        Key key;
+        uint64_t deadline;
+    };
+
+    /// @brief Bits of a deadline that pick its slot in one level
+    static const size_t SlotBits = 6;
+
+    /// @brief Slots per level
+    static const size_t SlotsPerLevel = size_t(1) << SlotBits;
+
+    /// @brief Number of levels, covering 2^24 ticks: about four and a half hours of milliseconds
+    static const size_t Levels = 4;
+
+    /// @brief Constructor
+    TimerWheel()
+        : m_levels(), m_overflow(), m_due(), m_now(0), m_timers(0), m_levelZeroTimers(0)
+    {
+
+    }
+
+    /// @brief Adds a timer for the provided key, due at the provided tick
+    /// @note A timer due no later than the current tick fires on the next Advance()
+    void Schedule(const Key& key, uint64_t deadline)
+    {
+        File(Timer { key, deadline });
+        ++m_timers;
+    }
+
+    /// @brief Moves the current tick forward, appending every timer that became due
+    /// @param now the new current tick; moving backward does nothing
+    /// @param due where the due timers are appended, in no particular order
+    void Advance(uint64_t now, std::vector<Timer>& due)
+    {
+        TakeDue(due);
+        while (m_now < now && m_timers)
+        {
+            if (!m_levelZeroTimers)
+            {
+                // nothing in level 0: straight to the last tick of its turn
+                uint64_t lastOfTurn = m_now | (SlotsPerLevel - 1);
+                m_now = lastOfTurn < now ? lastOfTurn : now;
+                if (m_now == now)
+                {
+                    break;
+                }
+            }
+            Step();
+            TakeDue(due);
+        }
+        if (m_now < now)
+        {
+            m_now = now;
+        }
+    }
+
+    /// @brief Returns the current tick
+    uint64_t GetNow() const
+    {
+        return m_now;
+    }
+
+    /// @brief Returns the number of timers not fired yet
+    size_t Size() const
+    {
+        return m_timers;
+    }
+
+protected:
+
+    /// @brief The timers of one level, by slot
+    using Level = std::array<std::vector<Timer>, SlotsPerLevel>;
+
+    /// @brief Returns the slot of a deadline in the provided level
+    static size_t SlotOf(uint64_t deadline, size_t level)
+    {
+        return (deadline >> (SlotBits * level)) & (SlotsPerLevel - 1);
+    }
+
+    /// @brief Puts a timer in the lowest level whose current turn holds its deadline
+    void File(Timer&& timer)
+    {
+        if (timer.deadline <= m_now)
+        {
+            m_due.push_back(std::move(timer));
+            return;
+        }
+        for (size_t level = 0; level < Levels; ++level)
+        {
+            const size_t turnBits = SlotBits * (level + 1);
+            if ((timer.deadline >> turnBits) == (m_now >> turnBits))
+            {
+                m_levels[level][SlotOf(timer.deadline, level)].push_back(std::move(timer));
+                m_levelZeroTimers += level == 0;
+                return;
+            }
+        }
+        m_overflow.push_back(std::move(timer));
+    }
+
+    /// @brief Files again the timers of a slot the current tick just reached
+    void Cascade(std::vector<Timer>& timers)
+    {
+        std::vector<Timer> cascading;
+        cascading.swap(timers);
+        for (auto& timer : cascading)
+        {
+            File(std::move(timer));
+        }
+    }
+
+    /// @brief Moves on one tick, cascading the higher levels' slots it reaches and firing level 0's
+    void Step()
+    {
+        ++m_now;
+        if ((m_now & ((uint64_t(1) << (SlotBits * Levels)) - 1)) == 0)
+        {
+            Cascade(m_overflow);
+        }
+        // from the top down, since a cascading timer only ever moves down
+        for (size_t level = Levels - 1; level > 0; --level)
+        {
+            if ((m_now & ((uint64_t(1) << (SlotBits * level)) - 1)) == 0)
+            {
+                Cascade(m_levels[level][SlotOf(m_now, level)]);
+            }
+        }
+        auto& firing = m_levels[0][SlotOf(m_now, 0)];
+        m_levelZeroTimers -= firing.size();
+        if (m_due.empty())
+        {
+            m_due.swap(firing);
+        }
+        else
+        {
+            m_due.insert(m_due.end(), firing.begin(), firing.end());
+            firing.clear();
+        }
+    }
+
+    /// @brief Hands the due timers over to the caller
+    void TakeDue(std::vector<Timer>& due)
+    {
+        if (m_due.empty())
+        {
+            return;
+        }
+        m_timers -= m_due.size();
+        if (due.empty())
+        {
+            due.swap(m_due);
+        }
+        else
+        {
+            due.insert(due.end(), m_due.begin(), m_due.end());
+        }
+        m_due.clear();
+    }
+
+    /// @brief The levels, finest first
+    std::array<Level, Levels> m_levels;
+
+    /// @brief Timers due beyond the top level's current turn
+    std::vector<Timer> m_overflow;
+
+    /// @brief Timers due but not handed over yet
+    std::vector<Timer> m_due;
+
+    /// @brief The current tick
+    uint64_t m_now;
+
+    /// @brief Timers not handed over yet, wherever they are
+    size_t m_timers;
+
+    /// @brief Timers in level 0
+    size_t m_levelZeroTimers;
+};
+
+} } // namespace Kvs::Expiry
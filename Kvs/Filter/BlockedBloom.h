@@ -0,0 +1,142 @@
+/// @file
+/// @brief Defines and implements the Kvs::Filter::BlockedBloom class
+
+#pragma once
+
+#include "Probe.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Kvs { namespace Filter {
+
+/// @brief A blocked Bloom filter over key hashes, each key's bits in one 32-byte block
+/// A key sets one bit in each of the eight 32-bit words of its block, so a
+/// lookup touches a single cache line, and tests the block with one AVX2 or
+/// two SSE2 loads where available. At ten bits per key about one percent of
+/// the hashes never added are reported as maybe present.
+/// @note Add() may run concurrently with MayContain(): bits are set atomically
+/// and a lookup racing with the Add() of its hash may or may not see it.
+/// Add()s are not serialized with each other.
+/// @note Bits can not be cleared, so Remove() does nothing and removed keys
+/// stay possible positives; see CountingBloom for a filter that forgets them.
+class BlockedBloom
+{
+public:
+
+    /// @brief Constructor of a filter that holds nothing and rejects every hash
+    BlockedBloom()
+        : m_storage(), m_words(nullptr), m_blocks(0)
+    {
+
+    }
+
+    /// @brief Constructor
+    /// @param keys number of keys to be added
+    /// @param bitsPerKey bits spent per key
+    BlockedBloom(size_t keys, size_t bitsPerKey)
+        : m_storage(), m_words(nullptr), m_blocks((keys * bitsPerKey + BlockBits - 1) / BlockBits)
+    {
+        m_blocks = m_blocks ? m_blocks : 1;
+        // one spare block to align the first one to its size, so no block straddles two cache lines
+        m_storage.resize((m_blocks + 1) * Probe::Lanes, 0);
+        const uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+        m_words = m_storage.data() + ((BlockBytes - address % BlockBytes) % BlockBytes) / sizeof(uint32_t);
+    }
+
+    /// @brief make non-copyable, since m_words points into m_storage
+    BlockedBloom(const BlockedBloom&) = delete;
+
+    /// @brief make non-assignable
+    BlockedBloom& operator=(const BlockedBloom&) = delete;
+
+    /// @brief Adds a key's hash
+    void Add(uint64_t hash)
+    {
+        const uint64_t mixed = Probe::Mix(hash);
+        uint32_t* block = m_words + Probe::Block(mixed, m_blocks) * Probe::Lanes;
+        for (size_t lane = 0; lane < Probe::Lanes; ++lane)
+        {
+            __atomic_fetch_or(&block[lane], uint32_t(1) << Probe::Lane(mixed, lane, 5), __ATOMIC_RELAXED);
+        }
+    }
+
+    /// @brief Returns false if the key of the provided hash was surely never added
+    bool MayContain(uint64_t hash) const
+    {
+        if (!m_blocks)
+        {
+            return false;
+        }
+        const uint64_t mixed = Probe::Mix(hash);
+        const uint32_t* block = m_words + Probe::Block(mixed, m_blocks) * Probe::Lanes;
+#if defined(__AVX2__)
+        // the lane's bit index is the top five bits of the salted hash
+        const __m256i salts = _mm256_setr_epi32(Probe::Salt(0), Probe::Salt(1), Probe::Salt(2), Probe::Salt(3),
+                                                Probe::Salt(4), Probe::Salt(5), Probe::Salt(6), Probe::Salt(7));
+        const __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<uint32_t>(mixed)), salts), 27);
+        const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+        return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), mask);
+#else
+        uint32_t mask[Probe::Lanes];
+        for (size_t lane = 0; lane < Probe::Lanes; ++lane)
+        {
+            mask[lane] = uint32_t(1) << Probe::Lane(mixed, lane, 5);
+        }
+#if defined(__SSE2__)
+        // a mask bit missing from the block leaves a non-zero byte in mask & ~block
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low = _mm_andnot_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(block)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+        const __m128i high = _mm_andnot_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(block + 4)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + 4)));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(low, high), zero)) == 0xFFFF;
+#else
+        for (size_t lane = 0; lane < Probe::Lanes; ++lane)
+        {
+            if (!(__atomic_load_n(&block[lane], __ATOMIC_RELAXED) & mask[lane]))
+            {
+                return false;
+            }
+        }
+        return true;
+#endif
+#endif
+    }
+
+    /// @brief Does nothing since bits can not be cleared
+    void Remove(uint64_t hash)
+    {
+
+    }
+
+    /// @brief Returns the bytes taken by the blocks
+    size_t GetBytes() const
+    {
+        return m_blocks * BlockBytes;
+    }
+
+protected:
+
+    /// @brief Bytes per block
+    static const size_t BlockBytes = Probe::Lanes * sizeof(uint32_t);
+
+    /// @brief Bits per block
+    static const size_t BlockBits = BlockBytes * 8;
+
+    /// @brief The blocks, and a spare one for alignment
+    std::vector<uint32_t> m_storage;
+
+    /// @brief The first block, aligned to BlockBytes
+    uint32_t* m_words;
+
+    /// @brief Number of blocks
+    size_t m_blocks;
+};
+
+} } // namespace Kvs::Filter
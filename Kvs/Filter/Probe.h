@@ -0,0 +1,56 @@
+/// @file
+/// @brief Defines and implements the Kvs::Filter::Probe helpers
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kvs { namespace Filter {
+
+/// @brief How the blocked filters turn a key's hash into a block and one probe per lane of the block
+/// The hash is mixed first, since hash functions such as Jenkins::OneAtATime
+/// fill only the low 32 bits. The high half picks the block and the low half,
+/// multiplied by a different odd salt per lane, picks the probe in each lane,
+/// as in the split block Bloom filter of Apache Parquet.
+struct Probe
+{
+    /// @brief Lanes per block, and probes per key
+    static const size_t Lanes = 8;
+
+    /// @brief Spreads a hash over all 64 bits
+    static uint64_t Mix(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /// @brief Returns the block of a mixed hash among the provided number of blocks
+    static size_t Block(uint64_t mixed, size_t blocks)
+    {
+        return static_cast<size_t>(((mixed >> 32) * blocks) >> 32);
+    }
+
+    /// @brief Returns the probe of a mixed hash in a lane, among 2^bits
+    static uint32_t Lane(uint64_t mixed, size_t lane, unsigned bits)
+    {
+        return (static_cast<uint32_t>(mixed) * Salt(lane)) >> (32 - bits);
+    }
+
+    /// @brief Returns the multiplier of a lane
+    static uint32_t Salt(size_t lane)
+    {
+        static const uint32_t salts[Lanes] =
+        {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        return salts[lane];
+    }
+};
+
+} } // namespace Kvs::Filter
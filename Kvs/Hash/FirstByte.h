@@ -3,18 +3,30 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
 namespace Kvs { namespace Hash {
 
 /// @brief A hash functor wrapping the retrieval of the first byte
 template<typename T>
 struct FirstByte
 {
+    /// @brief Declares that the characters spelling a key may be hashed too
+    using is_transparent = void;
+
     /// @brief The hash function implementing the retrieval of the first byte
     size_t operator()(const T& key) const
     {
         auto buffer = reinterpret_cast<const uint8_t*>(&key);
         return buffer[0];
     }
+
+    /// @brief The first byte of the key spelled by the provided characters, zero if there are none
+    size_t operator()(std::string_view key) const
+    {
+        return key.empty() ? 0 : static_cast<uint8_t>(key[0]);
+    }
 };
 
 } } // namespace Kvs::Hash
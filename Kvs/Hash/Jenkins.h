@@ -3,24 +3,50 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
 namespace Kvs { namespace Hash { namespace Jenkins {
 
 /// @brief A hash functor wrapping the Jenkins One-at-a-time hash
+/// It is transparent: the characters spelling a key hash as the key holding
+/// them followed by zeros, so stores can look them up without a key.
 template<typename T, size_t length = sizeof(T)>
 struct OneAtATime
 {
+    /// @brief Declares that the characters spelling a key may be hashed too
+    using is_transparent = void;
+
     /// @brief The hash function implementing the Jenkins One-at-a-time hash
     size_t operator()(const T& key) const
     {
-        auto buffer = reinterpret_cast<const uint8_t*>(&key);
+        return Hash(reinterpret_cast<const uint8_t*>(&key), length);
+    }
+
+    /// @brief The hash of the key spelled by the provided characters, without constructing it
+    size_t operator()(std::string_view key) const
+    {
+        return Hash(reinterpret_cast<const uint8_t*>(key.data()), std::min(key.size(), length));
+    }
+
+    /// @brief Hashes the provided bytes followed by zeros up to the hashed length
+    static size_t Hash(const uint8_t* buffer, size_t size)
+    {
         size_t i = 0;
         uint32_t hash = 0;
-        while (i != length)
+        while (i != size)
         {
             hash += buffer[i++];
             hash += hash << 10;
             hash ^= hash >> 6;
         }
+        // the zeros only stir the hash
+        while (i++ != length)
+        {
+            hash += hash << 10;
+            hash ^= hash >> 6;
+        }
         hash += hash << 3;
         hash ^= hash >> 11;
         hash += hash << 15;
@@ -0,0 +1,60 @@
+/// @file
+/// @brief Defines and implements Murmur hash functions
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Kvs { namespace Hash { namespace Murmur {
+
+/// @brief A hash functor wrapping Austin Appleby's 64-bit MurmurHash64A
+/// Unlike Jenkins::OneAtATime it takes a seed, so that a user such as
+/// KeyValueStore::PerfectHash can draw a fresh, independent hash function
+/// when the current one happens to collide, and it consumes 8 bytes at a time.
+template<typename T, size_t length = sizeof(T)>
+struct Hash64A
+{
+    /// @brief Constructor
+    explicit Hash64A(uint64_t seed = 0) : m_seed(seed) { }
+
+    /// @brief The hash function implementing MurmurHash64A
+    size_t operator()(const T& key) const
+    {
+        const uint64_t multiplier = 0xc6a4a7935bd1e995ULL;
+        const int shift = 47;
+        auto buffer = reinterpret_cast<const uint8_t*>(&key);
+        uint64_t hash = m_seed ^ (length * multiplier);
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, buffer + i, sizeof(word));
+            word *= multiplier;
+            word ^= word >> shift;
+            word *= multiplier;
+            hash ^= word;
+            hash *= multiplier;
+        }
+        if (i != length)
+        {
+            // the remaining bytes, little-endian
+            uint64_t tail = 0;
+            for (size_t j = length; j-- > i; )
+            {
+                tail = (tail << 8) | buffer[j];
+            }
+            hash ^= tail;
+            hash *= multiplier;
+        }
+        hash ^= hash >> shift;
+        hash *= multiplier;
+        hash ^= hash >> shift;
+        return hash;
+    }
+
+    /// @brief The seed selecting the hash function
+    uint64_t m_seed;
+};
+
+} } } // namespace Kvs::Hash::Murmur
@@ -37,32 +37,51 @@ public:
     /// @copydoc TypedKeyValueStore::Put()
     bool Put(const Key& key, const Value& value)
     {
-        ScopedLock lock(m_lock);
-        size_t index = m_hash(key);
-        auto& element = m_table[index];
-        auto& isValid = std::get<ValidField>(element);
-        if (!isValid)
-        {
-            isValid = true;
-            ++m_size;
-        }
-        std::get<ValueField>(element) = value;
-        return true;
+        return Write(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        return Write(std::move(key), std::move(value));
     }
 
     /// @copydoc TypedKeyValueStore::Get()
     bool Get(const Key& key, Value& value) const
     {
-        ScopedLock lock(m_lock);
-        size_t index = m_hash(key);
-        auto& element = m_table[index];
-        auto& isValid = std::get<ValidField>(element);
-        if (isValid)
+        return Find(key, &value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get(std::string_view, Value&) const
+    bool Get(std::string_view key, Value& value) const
+    {
+        if constexpr (IsTransparent<Hash>::value)
         {
-            value = std::get<ValueField>(element);
-            return true;
+            return Find(key, &value);
+        }
+        else
+        {
+            return TypedKeyValueStore<Key,Value>::Get(key, value);
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(const Key&) const
+    bool Contains(const Key& key) const
+    {
+        return Find(key, nullptr);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(std::string_view) const
+    bool Contains(std::string_view key) const
+    {
+        if constexpr (IsTransparent<Hash>::value)
+        {
+            return Find(key, nullptr);
+        }
+        else
+        {
+            return TypedKeyValueStore<Key,Value>::Contains(key);
         }
-        return false;
     }
 
     /// @copydoc TypedKeyValueStore::Remove()
@@ -116,8 +135,68 @@ public:
         }
     }
 
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        size_t index = m_hash(key);
+        auto& element = m_table[index];
+        auto& isValid = std::get<ValidField>(element);
+        Value value = isValid ? std::get<ValueField>(element) : Value();
+        if (!funcObj(value, isValid))
+        {
+            return false;
+        }
+        if (!isValid)
+        {
+            isValid = true;
+            ++m_size;
+        }
+        std::get<KeyField>(element) = key;
+        std::get<ValueField>(element) = value;
+        return true;
+    }
+
 protected:
 
+    /// @brief Finds the element at the hash of a key, or of the characters spelling one,
+    /// and retrieves its value if asked to
+    template <typename KeyLike>
+    bool Find(const KeyLike& key, Value* value) const
+    {
+        ScopedLock lock(m_lock);
+        size_t index = m_hash(key);
+        auto& element = m_table[index];
+        if (!std::get<ValidField>(element))
+        {
+            return false;
+        }
+        if (value)
+        {
+            *value = std::get<ValueField>(element);
+        }
+        return true;
+    }
+
+    /// @brief Stores the key and value in the element at the key's hash,
+    /// copying or moving from the provided ones as they were passed
+    template <typename KeyArg, typename ValueArg>
+    bool Write(KeyArg&& key, ValueArg&& value)
+    {
+        ScopedLock lock(m_lock);
+        size_t index = m_hash(key);
+        auto& element = m_table[index];
+        auto& isValid = std::get<ValidField>(element);
+        if (!isValid)
+        {
+            isValid = true;
+            ++m_size;
+        }
+        std::get<KeyField>(element) = std::forward<KeyArg>(key);
+        std::get<ValueField>(element) = std::forward<ValueArg>(value);
+        return true;
+    }
+
     /// tuple to hold information for each element in the array
     using Element = std::tuple<bool, Key, Value>;
 
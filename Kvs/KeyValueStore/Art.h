@@ -0,0 +1,952 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Art class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store using an adaptive radix tree (ART)
+/// Keys are split into bytes by ElementAccess, the same element-access traits
+/// GnuTrie uses, so a traits class that stops after a few characters makes a
+/// prefix front-end for a Compound store. Inner nodes grow and shrink between
+/// four sizes (Node4, Node16, Node48 and Node256) as children come and go,
+/// so a node is never much larger than its fanout, and Node16 is searched
+/// with SSE2 where available. Runs of single-child nodes are collapsed into
+/// the prefix of the node below (path compression): up to MaxPrefix bytes
+/// are stored in the node and any more are checked against a leaf.
+/// A key that ends at an inner node, because it is a prefix of longer keys,
+/// is kept as that node's terminal leaf. ForEach() and ForEachPrefix() visit
+/// keys in byte order.
+/// @note Follows Leis, Kemper and Neumann, "The Adaptive Radix Tree: ARTful
+/// Indexing for Main-Memory Databases".
+template <typename Key, typename Value, typename ElementAccess, typename LockPolicy>
+class Art : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief The most prefix bytes stored in an inner node
+    static const size_t MaxPrefix = 8;
+
+    /// @brief Constructor
+    Art()
+        : m_root(nullptr), m_size(0), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Art()
+    {
+        Free(m_root);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        Insert(m_root, key, value, BytesOf(key), 0);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        ScopedLock lock(m_lock);
+        auto leaf = Find(BytesOf(key));
+        if (leaf)
+        {
+            value = leaf->value;
+            return true;
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        return Erase(m_root, BytesOf(key), 0);
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        ScopedLock lock(m_lock);
+        return m_size;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        ScopedLock lock(m_lock);
+        Visit(m_root, [&funcObj] (Leaf* leaf) { funcObj(leaf->key, leaf->value); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        Visit(m_root, [&funcObj] (Leaf* leaf) { funcObj(leaf->key, leaf->value); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note A new key descends the tree twice, once to miss and once to insert
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto bytes = BytesOf(key);
+        auto leaf = Find(bytes);
+        Value value = leaf ? leaf->value : Value();
+        if (!funcObj(value, leaf != nullptr))
+        {
+            return false;
+        }
+        if (leaf)
+        {
+            leaf->value = value;
+            return true;
+        }
+        Insert(m_root, key, value, bytes, 0);
+        return true;
+    }
+
+    /// @brief Applies the provided function against each key whose elements
+    /// start with the elements of the provided prefix, in byte order
+    /// @note Only descends into the subtree under the prefix
+    void ForEachPrefix(const Key& prefix, const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        ScopedLock lock(m_lock);
+        auto visit = [&funcObj] (Leaf* leaf) { funcObj(leaf->key, leaf->value); };
+        auto bytes = BytesOf(prefix);
+        auto node = m_root;
+        size_t depth = 0;
+        while (node)
+        {
+            if (node->type == LeafType)
+            {
+                auto leaf = static_cast<Leaf*>(node);
+                auto leafBytes = BytesOf(leaf->key);
+                if (leafBytes.length >= bytes.length && memcmp(leafBytes.data, bytes.data, bytes.length) == 0)
+                {
+                    visit(leaf);
+                }
+                return;
+            }
+            auto inner = static_cast<Inner*>(node);
+            if (depth == bytes.length)
+            {
+                break;
+            }
+            if (inner->prefixLength)
+            {
+                auto rest = bytes.length - depth;
+                if (PrefixMismatch(inner, bytes, depth) < std::min<size_t>(inner->prefixLength, rest))
+                {
+                    return;
+                }
+                if (inner->prefixLength >= rest)
+                {
+                    break;
+                }
+                depth += inner->prefixLength;
+            }
+            auto child = FindChild(inner, bytes.data[depth]);
+            node = child ? *child : nullptr;
+            ++depth;
+        }
+        Visit(node, visit);
+    }
+
+protected:
+
+    /// @brief A byte of a key
+    using Byte = uint8_t;
+
+    /// @brief The elements of a key as bytes
+    struct Bytes
+    {
+        const Byte* data;
+        size_t length;
+    };
+
+    /// @brief The kinds of node
+    enum Type : uint8_t
+    {
+        LeafType,
+        Node4Type,
+        Node16Type,
+        Node48Type,
+        Node256Type
+    };
+
+    /// @brief What every node starts with
+    struct Node
+    {
+        explicit Node(Type type_) : type(type_) { }
+        Type type;
+    };
+
+    /// @brief A key and its value
+    struct Leaf : Node
+    {
+        Leaf(const Key& key_, const Value& value_) : Node(LeafType), key(key_), value(value_) { }
+        Key key;
+        Value value;
+    };
+
+    /// @brief What every inner node starts with
+    struct Inner : Node
+    {
+        explicit Inner(Type type_) : Node(type_), count(0), prefixLength(0), prefix(), terminal(nullptr) { }
+
+        /// @brief The number of children, not counting the terminal leaf
+        uint16_t count;
+
+        /// @brief The number of bytes skipped before the children are indexed
+        uint32_t prefixLength;
+
+        /// @brief The first bytes skipped, up to MaxPrefix of them
+        Byte prefix[MaxPrefix];
+
+        /// @brief The key that ends at this node, if any
+        Leaf* terminal;
+    };
+
+    /// @brief Up to 4 children with their bytes, kept sorted
+    struct Node4 : Inner
+    {
+        Node4() : Inner(Node4Type), keys(), children() { }
+        Byte keys[4];
+        Node* children[4];
+    };
+
+    /// @brief Up to 16 children with their bytes, kept sorted
+    struct Node16 : Inner
+    {
+        Node16() : Inner(Node16Type), keys(), children() { }
+        Byte keys[16];
+        Node* children[16];
+    };
+
+    /// @brief Up to 48 children, indexed by byte through one-based slot numbers
+    struct Node48 : Inner
+    {
+        Node48() : Inner(Node48Type), index(), children() { }
+        Byte index[256];
+        Node* children[48];
+    };
+
+    /// @brief A child slot for every byte
+    struct Node256 : Inner
+    {
+        Node256() : Inner(Node256Type), children() { }
+        Node* children[256];
+    };
+
+    /// @brief Returns the elements of a key as bytes
+    static Bytes BytesOf(const Key& key)
+    {
+        auto begin = ElementAccess::begin(key);
+        return Bytes{ reinterpret_cast<const Byte*>(begin), size_t(ElementAccess::end(key) - begin) };
+    }
+
+    /// @brief Whether a leaf holds the key with the provided bytes
+    static bool Matches(const Leaf* leaf, Bytes bytes)
+    {
+        auto leafBytes = BytesOf(leaf->key);
+        return leafBytes.length == bytes.length && memcmp(leafBytes.data, bytes.data, bytes.length) == 0;
+    }
+
+    /// @brief Frees a node and everything under it
+    static void Free(Node* node)
+    {
+        if (!node)
+        {
+            return;
+        }
+        if (node->type == LeafType)
+        {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        auto inner = static_cast<Inner*>(node);
+        delete inner->terminal;
+        ForEachChild(inner, [] (Byte, Node*& child) { Free(child); });
+        Delete(inner);
+    }
+
+    /// @brief Frees an inner node alone
+    static void Delete(Inner* inner)
+    {
+        switch (inner->type)
+        {
+            case Node4Type:   delete static_cast<Node4*>(inner); break;
+            case Node16Type:  delete static_cast<Node16*>(inner); break;
+            case Node48Type:  delete static_cast<Node48*>(inner); break;
+            case Node256Type: delete static_cast<Node256*>(inner); break;
+            default: break;
+        }
+    }
+
+    /// @brief Applies the provided function against each child slot of a node in byte order
+    template <typename FuncObj>
+    static void ForEachChild(Inner* inner, FuncObj funcObj)
+    {
+        switch (inner->type)
+        {
+            case Node4Type:
+            {
+                auto node = static_cast<Node4*>(inner);
+                for (size_t i = 0; i < node->count; ++i)
+                {
+                    funcObj(node->keys[i], node->children[i]);
+                }
+                break;
+            }
+            case Node16Type:
+            {
+                auto node = static_cast<Node16*>(inner);
+                for (size_t i = 0; i < node->count; ++i)
+                {
+                    funcObj(node->keys[i], node->children[i]);
+                }
+                break;
+            }
+            case Node48Type:
+            {
+                auto node = static_cast<Node48*>(inner);
+                for (size_t byte = 0; byte < 256; ++byte)
+                {
+                    if (node->index[byte])
+                    {
+                        funcObj(Byte(byte), node->children[node->index[byte] - 1]);
+                    }
+                }
+                break;
+            }
+            case Node256Type:
+            {
+                auto node = static_cast<Node256*>(inner);
+                for (size_t byte = 0; byte < 256; ++byte)
+                {
+                    if (node->children[byte])
+                    {
+                        funcObj(Byte(byte), node->children[byte]);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /// @brief Applies the provided function against each leaf under a node in byte order
+    template <typename FuncObj>
+    static void Visit(Node* node, const FuncObj& funcObj)
+    {
+        if (!node)
+        {
+            return;
+        }
+        if (node->type == LeafType)
+        {
+            funcObj(static_cast<Leaf*>(node));
+            return;
+        }
+        auto inner = static_cast<Inner*>(node);
+        if (inner->terminal)
+        {
+            // a key sorts before every longer key it is a prefix of
+            funcObj(inner->terminal);
+        }
+        ForEachChild(inner, [&funcObj] (Byte, Node*& child) { Visit(child, funcObj); });
+    }
+
+    /// @brief Returns the slot of the child for the provided byte, or null
+    static Node** FindChild(Inner* inner, Byte byte)
+    {
+        switch (inner->type)
+        {
+            case Node4Type:
+            {
+                auto node = static_cast<Node4*>(inner);
+                for (size_t i = 0; i < node->count; ++i)
+                {
+                    if (node->keys[i] == byte)
+                    {
+                        return &node->children[i];
+                    }
+                }
+                return nullptr;
+            }
+            case Node16Type:
+            {
+                auto node = static_cast<Node16*>(inner);
+#ifdef __SSE2__
+                // compare all 16 bytes at once and keep the matches among the used ones
+                auto matches = _mm_cmpeq_epi8(_mm_set1_epi8(char(byte)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys)));
+                unsigned bits = _mm_movemask_epi8(matches) & ((1u << node->count) - 1);
+                return bits ? &node->children[__builtin_ctz(bits)] : nullptr;
+#else
+                for (size_t i = 0; i < node->count; ++i)
+                {
+                    if (node->keys[i] == byte)
+                    {
+                        return &node->children[i];
+                    }
+                }
+                return nullptr;
+#endif
+            }
+            case Node48Type:
+            {
+                auto node = static_cast<Node48*>(inner);
+                return node->index[byte] ? &node->children[node->index[byte] - 1] : nullptr;
+            }
+            case Node256Type:
+            {
+                auto node = static_cast<Node256*>(inner);
+                return node->children[byte] ? &node->children[byte] : nullptr;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    /// @brief Returns the leaf of the smallest key under a node
+    static Leaf* Minimum(Node* node)
+    {
+        while (node->type != LeafType)
+        {
+            auto inner = static_cast<Inner*>(node);
+            if (inner->terminal)
+            {
+                return inner->terminal;
+            }
+            Node* first = nullptr;
+            switch (inner->type)
+            {
+                case Node4Type:  first = static_cast<Node4*>(inner)->children[0]; break;
+                case Node16Type: first = static_cast<Node16*>(inner)->children[0]; break;
+                default:
+                    ForEachChild(inner, [&first] (Byte, Node*& child) { if (!first) first = child; });
+                    break;
+            }
+            node = first;
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    /// @brief Returns how many bytes of a node's prefix match the key from the provided depth
+    /// @note Bytes past MaxPrefix are compared against a leaf under the node
+    static size_t PrefixMismatch(Inner* inner, Bytes bytes, size_t depth)
+    {
+        size_t limit = std::min<size_t>(inner->prefixLength, bytes.length - depth);
+        size_t stored = std::min(limit, MaxPrefix);
+        size_t index = 0;
+        for (; index < stored; ++index)
+        {
+            if (inner->prefix[index] != bytes.data[depth + index])
+            {
+                return index;
+            }
+        }
+        if (index < limit)
+        {
+            auto leafBytes = BytesOf(Minimum(inner)->key);
+            for (; index < limit; ++index)
+            {
+                if (leafBytes.data[depth + index] != bytes.data[depth + index])
+                {
+                    return index;
+                }
+            }
+        }
+        return index;
+    }
+
+    /// @brief Returns the leaf for the key with the provided bytes, or null
+    Leaf* Find(Bytes bytes) const
+    {
+        auto node = m_root;
+        size_t depth = 0;
+        while (node)
+        {
+            if (node->type == LeafType)
+            {
+                auto leaf = static_cast<Leaf*>(node);
+                return Matches(leaf, bytes) ? leaf : nullptr;
+            }
+            auto inner = static_cast<Inner*>(node);
+            if (inner->prefixLength)
+            {
+                // only the stored bytes are checked here, the leaf checks the whole key
+                if (bytes.length - depth < inner->prefixLength)
+                {
+                    return nullptr;
+                }
+                size_t stored = std::min<size_t>(inner->prefixLength, MaxPrefix);
+                if (memcmp(inner->prefix, bytes.data + depth, stored) != 0)
+                {
+                    return nullptr;
+                }
+                depth += inner->prefixLength;
+            }
+            if (depth == bytes.length)
+            {
+                return inner->terminal && Matches(inner->terminal, bytes) ? inner->terminal : nullptr;
+            }
+            auto child = FindChild(inner, bytes.data[depth]);
+            node = child ? *child : nullptr;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    /// @brief Copies what every inner node has from one node to another
+    static void CopyHeader(Inner* to, const Inner* from)
+    {
+        to->count = from->count;
+        to->prefixLength = from->prefixLength;
+        memcpy(to->prefix, from->prefix, MaxPrefix);
+        to->terminal = from->terminal;
+    }
+
+    /// @brief Stores a prefix in a node, only the first MaxPrefix bytes of which are kept
+    static void SetPrefix(Inner* inner, const Byte* prefix, size_t length)
+    {
+        inner->prefixLength = uint32_t(length);
+        memcpy(inner->prefix, prefix, std::min(length, MaxPrefix));
+    }
+
+    /// @brief Inserts a byte and child into sorted arrays with room for one more
+    static void InsertSorted(Byte* keys, Node** children, size_t count, Byte byte, Node* child)
+    {
+        size_t index = 0;
+        while (index < count && keys[index] < byte)
+        {
+            ++index;
+        }
+        memmove(keys + index + 1, keys + index, count - index);
+        memmove(children + index + 1, children + index, (count - index) * sizeof(Node*));
+        keys[index] = byte;
+        children[index] = child;
+    }
+
+    /// @brief Adds a child for a byte the node does not have yet, growing the node if it is full
+    /// @param ref the slot holding the node, updated if the node is replaced
+    static void AddChild(Node*& ref, Byte byte, Node* child)
+    {
+        auto inner = static_cast<Inner*>(ref);
+        switch (inner->type)
+        {
+            case Node4Type:
+            {
+                auto node = static_cast<Node4*>(inner);
+                if (node->count < 4)
+                {
+                    InsertSorted(node->keys, node->children, node->count++, byte, child);
+                    return;
+                }
+                auto bigger = new Node16();
+                CopyHeader(bigger, node);
+                memcpy(bigger->keys, node->keys, sizeof(node->keys));
+                memcpy(bigger->children, node->children, sizeof(node->children));
+                delete node;
+                ref = bigger;
+                InsertSorted(bigger->keys, bigger->children, bigger->count++, byte, child);
+                return;
+            }
+            case Node16Type:
+            {
+                auto node = static_cast<Node16*>(inner);
+                if (node->count < 16)
+                {
+                    InsertSorted(node->keys, node->children, node->count++, byte, child);
+                    return;
+                }
+                auto bigger = new Node48();
+                CopyHeader(bigger, node);
+                for (size_t i = 0; i < node->count; ++i)
+                {
+                    bigger->index[node->keys[i]] = Byte(i + 1);
+                    bigger->children[i] = node->children[i];
+                }
+                delete node;
+                ref = bigger;
+                bigger->index[byte] = Byte(bigger->count + 1);
+                bigger->children[bigger->count++] = child;
+                return;
+            }
+            case Node48Type:
+            {
+                auto node = static_cast<Node48*>(inner);
+                if (node->count < 48)
+                {
+                    // removals leave holes, so take the first free slot
+                    size_t slot = 0;
+                    while (node->children[slot])
+                    {
+                        ++slot;
+                    }
+                    node->index[byte] = Byte(slot + 1);
+                    node->children[slot] = child;
+                    ++node->count;
+                    return;
+                }
+                auto bigger = new Node256();
+                CopyHeader(bigger, node);
+                for (size_t i = 0; i < 256; ++i)
+                {
+                    if (node->index[i])
+                    {
+                        bigger->children[i] = node->children[node->index[i] - 1];
+                    }
+                }
+                delete node;
+                ref = bigger;
+                bigger->children[byte] = child;
+                ++bigger->count;
+                return;
+            }
+            case Node256Type:
+            {
+                auto node = static_cast<Node256*>(inner);
+                node->children[byte] = child;
+                ++node->count;
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    /// @brief Hangs a leaf off a node at the provided depth: as its terminal
+    /// if the key ends there, else as the child for the next byte
+    static void AddLeaf(Node*& ref, Leaf* leaf, Bytes bytes, size_t depth)
+    {
+        if (depth == bytes.length)
+        {
+            static_cast<Inner*>(ref)->terminal = leaf;
+        }
+        else
+        {
+            AddChild(ref, bytes.data[depth], leaf);
+        }
+    }
+
+    /// @brief Inserts or overwrites a key under the node in the provided slot
+    void Insert(Node*& ref, const Key& key, const Value& value, Bytes bytes, size_t depth)
+    {
+        auto node = ref;
+        if (!node)
+        {
+            ref = new Leaf(key, value);
+            ++m_size;
+            return;
+        }
+        if (node->type == LeafType)
+        {
+            auto leaf = static_cast<Leaf*>(node);
+            if (Matches(leaf, bytes))
+            {
+                leaf->value = value;
+                return;
+            }
+            // split the leaf: a new node holds the bytes both keys share
+            auto leafBytes = BytesOf(leaf->key);
+            size_t common = 0;
+            size_t limit = std::min(leafBytes.length, bytes.length) - depth;
+            while (common < limit && leafBytes.data[depth + common] == bytes.data[depth + common])
+            {
+                ++common;
+            }
+            Node* split = new Node4();
+            SetPrefix(static_cast<Inner*>(split), bytes.data + depth, common);
+            AddLeaf(split, leaf, leafBytes, depth + common);
+            AddLeaf(split, new Leaf(key, value), bytes, depth + common);
+            ref = split;
+            ++m_size;
+            return;
+        }
+        auto inner = static_cast<Inner*>(node);
+        if (inner->prefixLength)
+        {
+            size_t mismatch = PrefixMismatch(inner, bytes, depth);
+            if (mismatch < inner->prefixLength)
+            {
+                // split the prefix: a new node holds the bytes before the mismatch
+                Node* split = new Node4();
+                SetPrefix(static_cast<Inner*>(split), inner->prefix, std::min(size_t(mismatch), MaxPrefix));
+                static_cast<Inner*>(split)->prefixLength = uint32_t(mismatch);
+                size_t remaining = inner->prefixLength - mismatch - 1;
+                Byte byte;
+                if (inner->prefixLength <= MaxPrefix)
+                {
+                    byte = inner->prefix[mismatch];
+                    memmove(inner->prefix, inner->prefix + mismatch + 1, remaining);
+                }
+                else
+                {
+                    // the stored bytes run out before the end, so take them from a leaf
+                    auto leafBytes = BytesOf(Minimum(inner)->key);
+                    byte = leafBytes.data[depth + mismatch];
+                    memcpy(inner->prefix, leafBytes.data + depth + mismatch + 1, std::min(remaining, MaxPrefix));
+                }
+                inner->prefixLength = uint32_t(remaining);
+                AddChild(split, byte, inner);
+                AddLeaf(split, new Leaf(key, value), bytes, depth + mismatch);
+                ref = split;
+                ++m_size;
+                return;
+            }
+            depth += inner->prefixLength;
+        }
+        if (depth == bytes.length)
+        {
+            if (inner->terminal)
+            {
+                inner->terminal->value = value;
+            }
+            else
+            {
+                inner->terminal = new Leaf(key, value);
+                ++m_size;
+            }
+            return;
+        }
+        auto child = FindChild(inner, bytes.data[depth]);
+        if (child)
+        {
+            Insert(*child, key, value, bytes, depth + 1);
+            return;
+        }
+        AddChild(ref, bytes.data[depth], new Leaf(key, value));
+        ++m_size;
+    }
+
+    /// @brief Removes the child for a byte the node has
+    static void RemoveChild(Inner* inner, Byte byte)
+    {
+        switch (inner->type)
+        {
+            case Node4Type:
+            case Node16Type:
+            {
+                auto keys = inner->type == Node4Type ? static_cast<Node4*>(inner)->keys : static_cast<Node16*>(inner)->keys;
+                auto children = inner->type == Node4Type ? static_cast<Node4*>(inner)->children : static_cast<Node16*>(inner)->children;
+                size_t index = 0;
+                while (keys[index] != byte)
+                {
+                    ++index;
+                }
+                memmove(keys + index, keys + index + 1, inner->count - index - 1);
+                memmove(children + index, children + index + 1, (inner->count - index - 1) * sizeof(Node*));
+                break;
+            }
+            case Node48Type:
+            {
+                auto node = static_cast<Node48*>(inner);
+                node->children[node->index[byte] - 1] = nullptr;
+                node->index[byte] = 0;
+                break;
+            }
+            case Node256Type:
+                static_cast<Node256*>(inner)->children[byte] = nullptr;
+                break;
+            default:
+                break;
+        }
+        --inner->count;
+    }
+
+    /// @brief Replaces a node that lost a child with a smaller one, or with
+    /// what is left under it when that is a single leaf or child
+    /// @note Shrinks only well below the size that grew the node, so a key
+    /// added and removed at the boundary does not resize it every time
+    static void Shrink(Node*& ref)
+    {
+        auto inner = static_cast<Inner*>(ref);
+        switch (inner->type)
+        {
+            case Node4Type:
+            {
+                auto node = static_cast<Node4*>(inner);
+                if (node->count == 0)
+                {
+                    ref = node->terminal;
+                    delete node;
+                }
+                else if (node->count == 1 && !node->terminal)
+                {
+                    // merge with the only child, whose prefix grows by ours and its byte
+                    auto child = node->children[0];
+                    if (child->type != LeafType)
+                    {
+                        auto below = static_cast<Inner*>(child);
+                        Byte prefix[MaxPrefix];
+                        size_t length = 0;
+                        for (size_t i = 0; i < std::min<size_t>(node->prefixLength, MaxPrefix); ++i)
+                        {
+                            prefix[length++] = node->prefix[i];
+                        }
+                        if (length < MaxPrefix)
+                        {
+                            prefix[length++] = node->keys[0];
+                        }
+                        for (size_t i = 0; length < MaxPrefix && i < std::min<size_t>(below->prefixLength, MaxPrefix); ++i)
+                        {
+                            prefix[length++] = below->prefix[i];
+                        }
+                        memcpy(below->prefix, prefix, length);
+                        below->prefixLength += node->prefixLength + 1;
+                    }
+                    ref = child;
+                    delete node;
+                }
+                return;
+            }
+            case Node16Type:
+            {
+                auto node = static_cast<Node16*>(inner);
+                if (node->count < 3)
+                {
+                    auto smaller = new Node4();
+                    CopyHeader(smaller, node);
+                    memcpy(smaller->keys, node->keys, node->count);
+                    memcpy(smaller->children, node->children, node->count * sizeof(Node*));
+                    delete node;
+                    ref = smaller;
+                }
+                return;
+            }
+            case Node48Type:
+            {
+                auto node = static_cast<Node48*>(inner);
+                if (node->count < 12)
+                {
+                    auto smaller = new Node16();
+                    CopyHeader(smaller, node);
+                    size_t count = 0;
+                    for (size_t byte = 0; byte < 256; ++byte)
+                    {
+                        if (node->index[byte])
+                        {
+                            smaller->keys[count] = Byte(byte);
+                            smaller->children[count++] = node->children[node->index[byte] - 1];
+                        }
+                    }
+                    delete node;
+                    ref = smaller;
+                }
+                return;
+            }
+            case Node256Type:
+            {
+                auto node = static_cast<Node256*>(inner);
+                if (node->count < 37)
+                {
+                    auto smaller = new Node48();
+                    CopyHeader(smaller, node);
+                    size_t count = 0;
+                    for (size_t byte = 0; byte < 256; ++byte)
+                    {
+                        if (node->children[byte])
+                        {
+                            smaller->index[byte] = Byte(count + 1);
+                            smaller->children[count++] = node->children[byte];
+                        }
+                    }
+                    delete node;
+                    ref = smaller;
+                }
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    /// @brief Removes a key under the node in the provided slot
+    bool Erase(Node*& ref, Bytes bytes, size_t depth)
+    {
+        auto node = ref;
+        if (!node)
+        {
+            return false;
+        }
+        if (node->type == LeafType)
+        {
+            if (!Matches(static_cast<Leaf*>(node), bytes))
+            {
+                return false;
+            }
+            delete static_cast<Leaf*>(node);
+            ref = nullptr;
+            --m_size;
+            return true;
+        }
+        auto inner = static_cast<Inner*>(node);
+        if (inner->prefixLength)
+        {
+            if (PrefixMismatch(inner, bytes, depth) < inner->prefixLength)
+            {
+                return false;
+            }
+            depth += inner->prefixLength;
+        }
+        if (depth == bytes.length)
+        {
+            if (!inner->terminal || !Matches(inner->terminal, bytes))
+            {
+                return false;
+            }
+            delete inner->terminal;
+            inner->terminal = nullptr;
+            --m_size;
+            Shrink(ref);
+            return true;
+        }
+        Byte byte = bytes.data[depth];
+        auto child = FindChild(inner, byte);
+        if (!child || !Erase(*child, bytes, depth + 1))
+        {
+            return false;
+        }
+        if (!*child)
+        {
+            RemoveChild(inner, byte);
+            Shrink(ref);
+        }
+        return true;
+    }
+
+    /// @brief The root node, null when empty
+    Node* m_root;
+
+    /// @brief The number of keys
+    size_t m_size;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+};
+
+template <typename Key, typename Value, typename ElementAccess, typename LockPolicy>
+const size_t Art<Key, Value, ElementAccess, LockPolicy>::MaxPrefix;
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,555 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::BTree class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Optimistic.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief An ordered key->value store using a B+tree with optimistic lock coupling
+/// Nodes are NodeBytes each, page-sized by default, and hold as many sorted
+/// keys as fit, so a lookup makes a few binary searches over contiguous keys
+/// instead of following a pointer per key like a red-black tree. Values live
+/// in the leaves, which are linked left to right for ForEach(). Every node
+/// has a Lock::Optimistic: readers never lock, they note each node's version
+/// on the way down and validate it after reading, starting over if a writer
+/// got in. Writers descend the same way and lock only the leaf they change,
+/// plus its parent when it has to split. Full inner nodes are split on the way
+/// down, so a split never has to go back up more than one level.
+/// @note Follows Leis, Scheibner, Kemper and Neumann, "The ART of Practical
+/// Synchronization". As there, Remove() never merges nodes, so no node is
+/// freed until the store is and readers need no reclamation scheme; a tree
+/// that shrinks keeps its nodes. ForEach() and Transform() go a leaf at a
+/// time and are not snapshots.
+/// @note Key and Value must be trivially copyable, since readers copy them
+/// while a writer may be changing them and only then find out to retry.
+template <typename Key, typename Value, typename Compare, size_t NodeBytes = 4096>
+class BTree : public TypedKeyValueStore<Key, Value>
+{
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "BTree readers copy keys and values optimistically");
+
+public:
+
+    /// @brief Bytes of a node taken by its lock, type, count and link
+    static const size_t OverheadBytes = 32;
+
+    /// @brief The most keys an inner node holds
+    static const size_t InnerCapacity = (NodeBytes - OverheadBytes) / (sizeof(Key) + sizeof(void*));
+
+    /// @brief The most key->value pairs a leaf holds
+    static const size_t LeafCapacity = (NodeBytes - OverheadBytes) / (sizeof(Key) + sizeof(Value));
+
+    static_assert(InnerCapacity >= 3 && LeafCapacity >= 2, "BTree nodes are too small for Key and Value");
+
+    /// @brief Constructor
+    BTree()
+        : m_root(nullptr), m_first(new Leaf()), m_size(0), m_compare()
+    {
+        m_root.store(m_first, std::memory_order_relaxed);
+    }
+
+    /// @brief Destructor
+    ~BTree()
+    {
+        Free(m_root.load(std::memory_order_relaxed));
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        for (size_t attempt = 0; !TryPut(key, value); ++attempt)
+        {
+            Backoff(attempt);
+        }
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        bool found = false;
+        for (size_t attempt = 0; !TryGet(key, value, found); ++attempt)
+        {
+            Backoff(attempt);
+        }
+        return found;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        bool removed = false;
+        for (size_t attempt = 0; !TryRemove(key, removed); ++attempt)
+        {
+            Backoff(attempt);
+        }
+        return removed;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    /// @note Copies each leaf once it validates and calls the function object
+    /// with no lock held, so writers are never held up by a scan
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        std::vector<std::pair<Key, Value>> entries;
+        entries.reserve(LeafCapacity);
+        for (const Leaf* leaf = m_first; leaf; )
+        {
+            const Leaf* next = nullptr;
+            for (size_t attempt = 0; ; ++attempt)
+            {
+                uint64_t version;
+                if (leaf->lock.ReadLock(version))
+                {
+                    entries.clear();
+                    for (size_t index = 0, count = Count(leaf); index < count; ++index)
+                    {
+                        entries.emplace_back(leaf->keys[index], leaf->values[index]);
+                    }
+                    next = leaf->next;
+                    if (leaf->lock.Validate(version))
+                    {
+                        break;
+                    }
+                }
+                Backoff(attempt);
+            }
+            for (const auto& entry : entries)
+            {
+                funcObj(entry.first, entry.second);
+            }
+            leaf = next;
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    /// @note Locks one leaf at a time
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        for (Leaf* leaf = m_first; leaf; )
+        {
+            leaf->lock.Lock();
+            for (size_t index = 0; index < leaf->count; ++index)
+            {
+                funcObj(leaf->keys[index], leaf->values[index]);
+            }
+            Leaf* next = leaf->next;
+            leaf->lock.Unlock();
+            leaf = next;
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        bool stored = false;
+        for (size_t attempt = 0; !TryUpsert(key, funcObj, stored); ++attempt)
+        {
+            Backoff(attempt);
+        }
+        return stored;
+    }
+
+protected:
+
+    /// @brief What every node starts with
+    struct Node
+    {
+        explicit Node(bool leaf_) : lock(), leaf(leaf_), count(0) { }
+
+        /// @brief Writers lock it, readers validate against its version
+        Lock::Optimistic lock;
+
+        /// @brief Whether this is a Leaf rather than an Inner node, never changed
+        const bool leaf;
+
+        /// @brief The number of keys
+        uint16_t count;
+    };
+
+    /// @brief Keys separating count + 1 children: every key under children[i]
+    /// is no greater than keys[i] and greater than keys[i - 1]
+    struct Inner : Node
+    {
+        Inner() : Node(false) { }
+        Key keys[InnerCapacity];
+        Node* children[InnerCapacity + 1];
+    };
+
+    /// @brief Sorted keys with their values, and the leaf to the right
+    struct Leaf : Node
+    {
+        Leaf() : Node(true), next(nullptr) { }
+        Leaf* next;
+        Key keys[LeafCapacity];
+        Value values[LeafCapacity];
+    };
+
+    static_assert(sizeof(Inner) <= NodeBytes && sizeof(Leaf) <= NodeBytes, "BTree OverheadBytes is too small");
+
+    /// @brief Restarts that spin before each further restart yields the processor
+    static const size_t SpinsBeforeYield = 16;
+
+    /// @brief Waits a little before an operation starts over, longer once it
+    /// has started over a few times since the writer in the way may not be running
+    static void Backoff(size_t attempt)
+    {
+        if (attempt >= SpinsBeforeYield)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @brief The number of keys of a node, kept in bounds even when read torn
+    template <typename NodeType>
+    static size_t Count(const NodeType* node)
+    {
+        size_t capacity = sizeof(node->keys) / sizeof(node->keys[0]);
+        return node->count < capacity ? node->count : capacity;
+    }
+
+    /// @brief The index of the first key of a node that is not less than the provided one
+    template <typename NodeType>
+    size_t LowerBound(const NodeType* node, const Key& key) const
+    {
+        size_t lower = 0;
+        size_t upper = Count(node);
+        while (lower < upper)
+        {
+            size_t middle = (lower + upper) / 2;
+            if (m_compare(node->keys[middle], key))
+            {
+                lower = middle + 1;
+            }
+            else
+            {
+                upper = middle;
+            }
+        }
+        return lower;
+    }
+
+    /// @brief Frees a node and everything under it
+    static void Free(Node* node)
+    {
+        if (node->leaf)
+        {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        auto inner = static_cast<Inner*>(node);
+        for (size_t index = 0; index <= inner->count; ++index)
+        {
+            Free(inner->children[index]);
+        }
+        delete inner;
+    }
+
+    /// @brief Descends optimistically from the root to the leaf that holds
+    /// or would hold a key, validating each node before trusting its child
+    /// @param[out] parent the parent of the node returned, or null if it is the root
+    /// @param[out] parentVersion the version of the parent
+    /// @param[out] version the version of the node returned
+    /// @param stopAtFull whether to stop at the first full inner node, for writers to split
+    /// @return the leaf or full inner node, or null to start over
+    Node* Descend(const Key& key, Inner*& parent, uint64_t& parentVersion, uint64_t& version, bool stopAtFull) const
+    {
+        Node* node = m_root.load(std::memory_order_acquire);
+        if (!node->lock.ReadLock(version) || node != m_root.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        parent = nullptr;
+        while (!node->leaf)
+        {
+            auto inner = static_cast<Inner*>(node);
+            if (stopAtFull && inner->count == InnerCapacity)
+            {
+                return inner;
+            }
+            if (parent && !parent->lock.Validate(parentVersion))
+            {
+                return nullptr;
+            }
+            parent = inner;
+            parentVersion = version;
+            node = inner->children[LowerBound(inner, key)];
+            if (!inner->lock.Validate(version) || !node->lock.ReadLock(version))
+            {
+                return nullptr;
+            }
+        }
+        return node;
+    }
+
+    /// @brief Splits a full node in two, adding the new right half to its
+    /// parent, or to a new root if it has none
+    /// @note Takes the locks itself and gives up if either node changed since its version was noted
+    void Split(Inner* parent, uint64_t parentVersion, Node* node, uint64_t version)
+    {
+        if (parent && !parent->lock.Upgrade(parentVersion))
+        {
+            return;
+        }
+        if (!node->lock.Upgrade(version))
+        {
+            if (parent)
+            {
+                parent->lock.Unlock();
+            }
+            return;
+        }
+        if (!parent && node != m_root.load(std::memory_order_relaxed))
+        {
+            // another writer gave it a parent meanwhile
+            node->lock.Unlock();
+            return;
+        }
+        Key separator;
+        Node* right = node->leaf ? static_cast<Node*>(SplitLeaf(static_cast<Leaf*>(node), separator))
+                                 : static_cast<Node*>(SplitInner(static_cast<Inner*>(node), separator));
+        if (parent)
+        {
+            InsertChild(parent, separator, right);
+        }
+        else
+        {
+            auto root = new Inner();
+            root->count = 1;
+            root->keys[0] = separator;
+            root->children[0] = node;
+            root->children[1] = right;
+            m_root.store(root, std::memory_order_release);
+        }
+        node->lock.Unlock();
+        if (parent)
+        {
+            parent->lock.Unlock();
+        }
+    }
+
+    /// @brief Moves the upper half of a locked leaf to a new leaf on its right
+    /// @param[out] separator the greatest key left behind
+    static Leaf* SplitLeaf(Leaf* leaf, Key& separator)
+    {
+        auto right = new Leaf();
+        size_t half = leaf->count / 2;
+        right->count = uint16_t(leaf->count - half);
+        std::copy(leaf->keys + half, leaf->keys + leaf->count, right->keys);
+        std::copy(leaf->values + half, leaf->values + leaf->count, right->values);
+        right->next = leaf->next;
+        leaf->count = uint16_t(half);
+        leaf->next = right;
+        separator = leaf->keys[half - 1];
+        return right;
+    }
+
+    /// @brief Moves the upper half of a locked inner node to a new node on its right
+    /// @param[out] separator the middle key, which moves up to the parent
+    static Inner* SplitInner(Inner* inner, Key& separator)
+    {
+        auto right = new Inner();
+        size_t half = inner->count / 2;
+        right->count = uint16_t(inner->count - half - 1);
+        std::copy(inner->keys + half + 1, inner->keys + inner->count, right->keys);
+        std::copy(inner->children + half + 1, inner->children + inner->count + 1, right->children);
+        separator = inner->keys[half];
+        inner->count = uint16_t(half);
+        return right;
+    }
+
+    /// @brief Adds a separator and the child to its right to a locked inner node with room
+    void InsertChild(Inner* inner, const Key& separator, Node* child)
+    {
+        size_t index = LowerBound(inner, separator);
+        std::copy_backward(inner->keys + index, inner->keys + inner->count, inner->keys + inner->count + 1);
+        std::copy_backward(inner->children + index + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+        inner->keys[index] = separator;
+        inner->children[index + 1] = child;
+        ++inner->count;
+    }
+
+    /// @brief Descends to the leaf where a key is or goes and locks it, splitting full nodes on the way
+    /// @param[out] index where the key is or goes in the leaf
+    /// @param[out] found whether the leaf holds the key
+    /// @return false to start over, with no lock held
+    bool LockLeaf(const Key& key, Leaf*& leaf, size_t& index, bool& found)
+    {
+        Inner* parent;
+        uint64_t parentVersion, version;
+        auto node = Descend(key, parent, parentVersion, version, true);
+        if (!node)
+        {
+            return false;
+        }
+        if (!node->leaf)
+        {
+            // make room on the way down, then start over
+            Split(parent, parentVersion, node, version);
+            return false;
+        }
+        // decided optimistically, and still true once the upgrade proves nothing changed
+        leaf = static_cast<Leaf*>(node);
+        index = LowerBound(leaf, key);
+        found = index < Count(leaf) && !m_compare(key, leaf->keys[index]);
+        if (!found && Count(leaf) == LeafCapacity)
+        {
+            Split(parent, parentVersion, leaf, version);
+            return false;
+        }
+        if (!leaf->lock.Upgrade(version))
+        {
+            return false;
+        }
+        if (parent && !parent->lock.Validate(parentVersion))
+        {
+            leaf->lock.Unlock();
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief Adds a key->value pair at the provided index of a locked leaf with room
+    void InsertAt(Leaf* leaf, size_t index, const Key& key, const Value& value)
+    {
+        std::copy_backward(leaf->keys + index, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::copy_backward(leaf->values + index, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[index] = key;
+        leaf->values[index] = value;
+        ++leaf->count;
+        m_size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief One optimistic attempt at Put()
+    /// @return false to start over
+    bool TryPut(const Key& key, const Value& value)
+    {
+        Leaf* leaf;
+        size_t index;
+        bool found;
+        if (!LockLeaf(key, leaf, index, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            leaf->values[index] = value;
+        }
+        else
+        {
+            InsertAt(leaf, index, key, value);
+        }
+        leaf->lock.Unlock();
+        return true;
+    }
+
+    /// @brief One optimistic attempt at Upsert()
+    /// @return false to start over
+    bool TryUpsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj, bool& stored)
+    {
+        Leaf* leaf;
+        size_t index;
+        bool found;
+        if (!LockLeaf(key, leaf, index, found))
+        {
+            return false;
+        }
+        // the function runs with the leaf locked, so nothing changes the value in between
+        Value value = found ? leaf->values[index] : Value();
+        stored = funcObj(value, found);
+        if (stored && found)
+        {
+            leaf->values[index] = value;
+        }
+        else if (stored)
+        {
+            InsertAt(leaf, index, key, value);
+        }
+        leaf->lock.Unlock();
+        return true;
+    }
+
+    /// @brief One optimistic attempt at Get()
+    /// @return false to start over
+    bool TryGet(const Key& key, Value& value, bool& found) const
+    {
+        Inner* parent;
+        uint64_t parentVersion, version;
+        auto leaf = static_cast<const Leaf*>(Descend(key, parent, parentVersion, version, false));
+        if (!leaf)
+        {
+            return false;
+        }
+        size_t index = LowerBound(leaf, key);
+        found = index < Count(leaf) && !m_compare(key, leaf->keys[index]);
+        if (found)
+        {
+            value = leaf->values[index];
+        }
+        return leaf->lock.Validate(version) && (!parent || parent->lock.Validate(parentVersion));
+    }
+
+    /// @brief One optimistic attempt at Remove()
+    /// @return false to start over
+    bool TryRemove(const Key& key, bool& removed)
+    {
+        Inner* parent;
+        uint64_t parentVersion, version;
+        auto leaf = static_cast<Leaf*>(Descend(key, parent, parentVersion, version, false));
+        if (!leaf)
+        {
+            return false;
+        }
+        if (!leaf->lock.Upgrade(version))
+        {
+            return false;
+        }
+        if (parent && !parent->lock.Validate(parentVersion))
+        {
+            leaf->lock.Unlock();
+            return false;
+        }
+        size_t index = LowerBound(leaf, key);
+        removed = index < leaf->count && !m_compare(key, leaf->keys[index]);
+        if (removed)
+        {
+            std::copy(leaf->keys + index + 1, leaf->keys + leaf->count, leaf->keys + index);
+            std::copy(leaf->values + index + 1, leaf->values + leaf->count, leaf->values + index);
+            --leaf->count;
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+        }
+        leaf->lock.Unlock();
+        return true;
+    }
+
+    /// @brief The root node, replaced when the root splits
+    std::atomic<Node*> m_root;
+
+    /// @brief The leftmost leaf, where scans start: splits only add leaves to its right
+    Leaf* const m_first;
+
+    /// @brief The number of keys
+    std::atomic<size_t> m_size;
+
+    /// @brief The key ordering
+    Compare m_compare;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,265 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Cache class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief What a Cache keeps in the store it decorates for each key
+template <typename Value>
+struct CacheEntry
+{
+    /// @brief The cached value
+    Value value;
+    /// @brief The key's slot in the cache's eviction policy
+    uint32_t slot;
+};
+
+/// @brief A snapshot of the counters of a Cache
+struct CacheStats
+{
+    /// @brief Get calls that found their key
+    uint64_t hits;
+    /// @brief Get calls that did not
+    uint64_t misses;
+    /// @brief Keys removed to make room for new ones
+    uint64_t evictions;
+
+    /// @brief Fraction of Get calls that found their key
+    double HitRatio() const
+    {
+        return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+/// @brief A key->value store decorator that holds at most a fixed number of keys
+/// Every key takes one of capacity slots of an EvictionPolicy, e.g.
+/// Eviction::Clock, Eviction::SegmentedLru or Eviction::S3Fifo, and a Put()
+/// of a new key into a full cache removes the key of the slot the policy
+/// evicts from the decorated store. The slot is kept next to the value in the
+/// decorated store, so a Get() is the decorated store's Get() plus a hit
+/// recorded by the policy without any lock: with a decorated store whose
+/// readers take no lock either, e.g. Cuckoo, readers never wait for anyone.
+/// Put(), Remove() and Upsert() are serialized by LockPolicy.
+/// @note The decorated store must allow Get() concurrently with Put() and
+/// Remove() if the cache is used that way. A Get() racing with the eviction
+/// of its key may record its hit on the slot's next key, which only makes
+/// the eviction order approximate.
+/// @note Hashes are only used by policies that remember evicted keys, e.g. Eviction::S3Fifo.
+template <typename Key, typename Value, typename Hash, typename EvictionPolicy, typename LockPolicy>
+class Cache : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief The decorated key->value store, holding the values and their slots
+    using EntryStoreSharedPtr = typename TypedKeyValueStore<Key, CacheEntry<Value>>::SharedPtr;
+
+    /// @brief Number of hit and miss counter shards
+    static const size_t CounterShards = 16;
+
+    /// @brief Constructor
+    /// @param entryStore the decorated store, which should be empty
+    /// @param capacity most keys held at once
+    Cache(EntryStoreSharedPtr entryStore, size_t capacity)
+        : m_entryStore(entryStore)
+        , m_policy(capacity)
+        , m_keys(capacity)
+        , m_hash()
+        , m_lock()
+        , m_shards(CounterShards)
+        , m_evictions(0)
+        , m_capacity(capacity)
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Cache()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        CacheEntry<Value> entry;
+        return Write(key, m_entryStore->Get(key, entry), entry, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        CacheEntry<Value> entry;
+        Shard& shard = m_shards[ThreadIndex() & (CounterShards - 1)];
+        if (!m_entryStore->Get(key, entry))
+        {
+            Increment(shard.misses);
+            return false;
+        }
+        m_policy.Touch(entry.slot);
+        Increment(shard.hits);
+        value = entry.value;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        CacheEntry<Value> entry;
+        if (!m_entryStore->Get(key, entry) || !m_entryStore->Remove(key))
+        {
+            return false;
+        }
+        m_policy.Forget(entry.slot);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_entryStore->Size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        m_entryStore->ForEach([&funcObj] (const Key& key, const CacheEntry<Value>& entry) {
+            funcObj(key, entry.value);
+        });
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        m_entryStore->Transform([&funcObj] (const Key& key, CacheEntry<Value>& entry) {
+            funcObj(key, entry.value);
+        });
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note A new key takes a slot, and may evict another, as with Put()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        CacheEntry<Value> entry;
+        const bool found = m_entryStore->Get(key, entry);
+        Value value = found ? entry.value : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        return Write(key, found, entry, value);
+    }
+
+    /// @brief Returns the hit, miss and eviction counters
+    /// @note Shards are read while they may be updated, so the snapshot is
+    /// consistent per counter but not across counters
+    CacheStats GetStats() const
+    {
+        CacheStats stats = { 0, 0, m_evictions.load(std::memory_order_relaxed) };
+        for (const auto& shard : m_shards)
+        {
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    /// @brief Returns the most keys held at once
+    size_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+protected:
+
+    /// @brief Stores the value of a key, taking a slot for it if it is new and evicting another key if none is free
+    /// @param found whether the key is held, with entry its entry
+    bool Write(const Key& key, bool found, CacheEntry<Value>& entry, const Value& value)
+    {
+        if (found)
+        {
+            entry.value = value;
+            m_policy.Touch(entry.slot);
+            return m_entryStore->Put(key, entry);
+        }
+        size_t victim;
+        entry.slot = static_cast<uint32_t>(m_policy.Admit(m_hash(key), victim));
+        entry.value = value;
+        if (victim != EvictionPolicy::NoSlot)
+        {
+            m_entryStore->Remove(m_keys[victim]);
+            m_evictions.store(m_evictions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if (!m_entryStore->Put(key, entry))
+        {
+            m_policy.Forget(entry.slot);
+            return false;
+        }
+        m_keys[entry.slot] = key;
+        return true;
+    }
+
+    /// @brief The hit and miss counters of the threads sharing one shard, kept to their own cache line
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> hits { 0 };
+        std::atomic<uint64_t> misses { 0 };
+    };
+
+    /// @brief Adds one to a counter only the calling thread is expected to write
+    static void Increment(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the calling thread's index, handed out round-robin on first use
+    static size_t ThreadIndex()
+    {
+        static std::atomic<size_t> nextIndex(0);
+        static thread_local size_t index = ~size_t(0);
+        if (index == ~size_t(0))
+        {
+            index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        }
+        return index;
+    }
+
+    /// @brief The decorated key->value store
+    EntryStoreSharedPtr m_entryStore;
+
+    /// @brief The eviction policy; mutable since hits are recorded by Get()
+    mutable EvictionPolicy m_policy;
+
+    /// @brief The key of each slot, to remove it from the decorated store when it is evicted
+    std::vector<Key> m_keys;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+    /// @brief The hit and miss counter shards; mutable since they are counted by Get()
+    mutable std::vector<Shard> m_shards;
+
+    /// @brief Keys evicted, only written under m_lock
+    std::atomic<uint64_t> m_evictions;
+
+    /// @brief Most keys held at once
+    size_t m_capacity;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -16,6 +16,8 @@ namespace Kvs { namespace KeyValueStore {
 ///                        |---BackEnd--|
 ///                |-----FrontEnd-------|
 /// @endcode
+/// Get(), Size() and the iterations only take the lock through Lock::ReadScoped,
+/// so with Lock::EpochReaders and lock-free stores on both ends they take none.
 template <typename Key, typename Value, typename LockPolicy>
 class Compound : public TypedKeyValueStore<Key, Value>
 {
@@ -24,6 +26,9 @@ public:
     /// @brief Convenient rename for a scoped lock
     using ScopedLock = typename Lock::Scoped<LockPolicy>;
 
+    /// @brief Convenient rename for a scoped lock on paths that only read
+    using ReadScopedLock = typename Lock::ReadScoped<LockPolicy>;
+
     /// @brief Convenient rename for the overall key->value store
     using KeyValueStoreSharedPtr = typename TypedKeyValueStore<Key, Value>::SharedPtr;
 
@@ -33,6 +38,9 @@ public:
     /// @brief Convenient rename for a factory to construct the back-end key->value store
     using BackEndKeyValueStoreFactory = std::function<KeyValueStoreSharedPtr()>;
 
+    /// @brief Function object type used for iterating over the back-end key->value stores
+    using FuncObjBackEnd = std::function<void(const Key&, const KeyValueStoreSharedPtr&)>;
+
     /// @brief Constructor
     Compound(
         FrontEndKeyValueStoreSharedPtr frontEndKeyValueStore,
@@ -55,27 +63,49 @@ public:
     {
         ScopedLock lock(m_lock);
         KeyValueStoreSharedPtr frontEndValue;
-        if (!m_frontEndKeyValueStore->Get(key, frontEndValue))
+        if (!GetOrCreateBackEnd(key, frontEndValue))
         {
-            frontEndValue = m_backEndKeyValueStoreFactory();
-            if (!m_frontEndKeyValueStore->Put(key, frontEndValue))
-            {
-                return false;
-            }
+            return false;
         }
         return frontEndValue->Put(key, value);
     }
 
-    /// @copydoc TypedKeyValueStore::Get()
-    bool Get(const Key& key, Value& value) const
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    /// @note The key and value are moved into the back-end, whose own Put(Key&&, Value&&) stores them
+    bool Put(Key&& key, Value&& value)
     {
         ScopedLock lock(m_lock);
         KeyValueStoreSharedPtr frontEndValue;
-        if (!m_frontEndKeyValueStore->Get(key, frontEndValue))
+        if (!GetOrCreateBackEnd(key, frontEndValue))
         {
             return false;
         }
-        return frontEndValue->Get(key, value);
+        return frontEndValue->Put(std::move(key), std::move(value));
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        return Find(key, &value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get(std::string_view, Value&) const
+    /// @note Both ends are handed the characters, so neither constructs a key if its lookup is transparent
+    bool Get(std::string_view key, Value& value) const
+    {
+        return Find(key, &value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(const Key&) const
+    bool Contains(const Key& key) const
+    {
+        return Find(key, nullptr);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(std::string_view) const
+    bool Contains(std::string_view key) const
+    {
+        return Find(key, nullptr);
     }
 
     /// @copydoc TypedKeyValueStore::Remove()
@@ -93,7 +123,7 @@ public:
     /// @copydoc TypedKeyValueStore::Size()
     size_t Size() const
     {
-        ScopedLock lock(m_lock);
+        ReadScopedLock lock(m_lock);
         size_t size = 0;
         m_frontEndKeyValueStore->ForEach(
             [&](Key key, KeyValueStoreSharedPtr frontEndValue)
@@ -107,7 +137,7 @@ public:
     /// @copydoc TypedKeyValueStore::ForEach()
     void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
     {
-        ScopedLock lock(m_lock);
+        ReadScopedLock lock(m_lock);
         m_frontEndKeyValueStore->ForEach(
             [&](Key key, KeyValueStoreSharedPtr frontEndValue)
             {
@@ -128,8 +158,60 @@ public:
         );
     }
 
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note Routed to the key's back-end, which reads, modifies and writes the value under its own lock
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        KeyValueStoreSharedPtr frontEndValue;
+        if (!GetOrCreateBackEnd(key, frontEndValue))
+        {
+            return false;
+        }
+        return frontEndValue->Upsert(key, funcObj);
+    }
+
+    /// @brief Iterates over every back-end key->value store with the front-end key that created it
+    void ForEachBackEnd(const FuncObjBackEnd& funcObj) const
+    {
+        ReadScopedLock lock(m_lock);
+        m_frontEndKeyValueStore->ForEach(
+            [&](Key key, KeyValueStoreSharedPtr frontEndValue)
+            {
+                funcObj(key, frontEndValue);
+            }
+        );
+    }
+
 protected:
 
+    /// @brief Finds a key, or the key spelled by the provided characters, in its back-end
+    /// and retrieves its value if asked to
+    template <typename KeyLike>
+    bool Find(const KeyLike& key, Value* value) const
+    {
+        ReadScopedLock lock(m_lock);
+        KeyValueStoreSharedPtr frontEndValue;
+        if (!m_frontEndKeyValueStore->Get(key, frontEndValue))
+        {
+            return false;
+        }
+        return value ? frontEndValue->Get(key, *value) : frontEndValue->Contains(key);
+    }
+
+    /// @brief Retrieves the back-end of a key, creating it with the factory if the front-end has none
+    /// @return false if the front-end refused the new back-end
+    /// @note The lock must be held
+    bool GetOrCreateBackEnd(const Key& key, KeyValueStoreSharedPtr& frontEndValue)
+    {
+        if (m_frontEndKeyValueStore->Get(key, frontEndValue))
+        {
+            return true;
+        }
+        frontEndValue = m_backEndKeyValueStoreFactory();
+        return m_frontEndKeyValueStore->Put(key, frontEndValue);
+    }
+
     /// @brief The frontEnd portion
     FrontEndKeyValueStoreSharedPtr m_frontEndKeyValueStore;
 
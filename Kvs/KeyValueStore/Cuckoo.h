@@ -0,0 +1,698 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Cuckoo class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Optimistic.h"
+#include "../Reclaim/Epoch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store using a concurrent, bucketized cuckoo hash table
+/// In the style of libcuckoo: every key lives in one of two buckets of
+/// SlotsPerBucket slots, so a Get() looks at two buckets at most, and a full
+/// table is only grown once no room can be made by moving other keys to
+/// their own other bucket, which keeps the load factor above 90%. Each slot
+/// keeps a one byte tag of its key's hash, which gives the other bucket of a
+/// key without hashing it again and skips most key comparisons.
+/// Buckets are guarded by StripeCount striped Lock::Optimistic version locks.
+/// Put(), Remove() and Upsert() lock the stripes of the key's two buckets
+/// only, so writers of different stripes run in parallel. Readers lock
+/// nothing: they note the two versions, read and validate, starting over if
+/// a writer got in.
+/// Moving keys around to make room, which a breadth-first search bounded to
+/// MaxPathLength moves plans, and growing the table take every stripe; both
+/// are rare. Replaced tables are retired to a Reclaim::Epoch.
+/// @note Key and Value must be trivially copyable since readers may copy them
+/// while they are written, then throw the copy away. Key must have operator==().
+/// ForEach() is not a snapshot: entries put or removed while it runs may or
+/// may not be visited, and a key moved meanwhile may be visited twice.
+template <typename Key, typename Value, typename Hash, size_t SlotsPerBucket = 4>
+class Cuckoo : public TypedKeyValueStore<Key, Value>
+{
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "Cuckoo readers copy keys and values that may be written meanwhile");
+
+public:
+
+    /// @brief Number of buckets of an empty table
+    static const size_t InitialBucketCount = 16;
+
+    /// @brief Number of version locks guarding the buckets
+    static const size_t StripeCount = 1024;
+
+    /// @brief Most keys moved to make room for one
+    static const size_t MaxPathLength = 5;
+
+    /// @brief Constructor
+    /// @param bucketCount buckets of the empty table, rounded up to a power of two
+    explicit Cuckoo(size_t bucketCount = InitialBucketCount)
+        : m_table(new Table(RoundUp(bucketCount))), m_size(0), m_hash(), m_stripes(new Stripe[StripeCount]), m_steps()
+    {
+
+    }
+
+    /// @brief Destructor
+    /// @note Tables retired earlier are freed by the epoch, not here
+    ~Cuckoo()
+    {
+        delete m_table.load(std::memory_order_relaxed);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        const size_t hash = m_hash(key);
+        const uint8_t tag = Tag(hash);
+        {
+            // the table may be replaced, and freed, until its stripes are held
+            Reclaim::Epoch::Guard epoch;
+            for (;;)
+            {
+                auto table = m_table.load(std::memory_order_acquire);
+                const size_t first = hash & table->mask;
+                const size_t second = Alternate(*table, first, tag);
+                StripeGuard guard(*this, first, second);
+                if (table != m_table.load(std::memory_order_relaxed))
+                {
+                    // grown while this waited for the stripes
+                    continue;
+                }
+                if (PutInBuckets(*table, first, second, tag, key, value))
+                {
+                    return true;
+                }
+                break;
+            }
+        }
+        // both buckets are full: make room with every stripe held
+        AllStripesGuard guard(*this);
+        auto table = m_table.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const size_t first = hash & table->mask;
+            const size_t second = Alternate(*table, first, tag);
+            if (PutInBuckets(*table, first, second, tag, key, value))
+            {
+                return true;
+            }
+            size_t bucket, slot;
+            if (MakeRoom(*table, first, second, bucket, slot))
+            {
+                Store(table->buckets[bucket], slot, tag, key, value);
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            table = Grow(*table);
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        const size_t hash = m_hash(key);
+        const uint8_t tag = Tag(hash);
+        Reclaim::Epoch::Guard guard;
+        for (size_t attempt = 0; ; ++attempt)
+        {
+            auto table = m_table.load(std::memory_order_acquire);
+            const size_t first = hash & table->mask;
+            const size_t second = Alternate(*table, first, tag);
+            // the second bucket loads while the first is searched
+            Prefetch(table->buckets[second]);
+            const auto& firstStripe = StripeOf(first);
+            const auto& secondStripe = StripeOf(second);
+            uint64_t firstVersion, secondVersion;
+            if (firstStripe.ReadLock(firstVersion) && secondStripe.ReadLock(secondVersion) &&
+                table == m_table.load(std::memory_order_acquire))
+            {
+                bool found = Find(table->buckets[first], tag, key, value) || Find(table->buckets[second], tag, key, value);
+                if (firstStripe.Validate(firstVersion) && secondStripe.Validate(secondVersion))
+                {
+                    return found;
+                }
+            }
+            Backoff(attempt);
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        const size_t hash = m_hash(key);
+        const uint8_t tag = Tag(hash);
+        // the table may be replaced, and freed, until its stripes are held
+        Reclaim::Epoch::Guard epoch;
+        for (;;)
+        {
+            auto table = m_table.load(std::memory_order_acquire);
+            const size_t first = hash & table->mask;
+            const size_t second = Alternate(*table, first, tag);
+            StripeGuard guard(*this, first, second);
+            if (table != m_table.load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+            for (size_t bucket : { first, second })
+            {
+                size_t slot = Locate(table->buckets[bucket], tag, key);
+                if (slot != SlotsPerBucket)
+                {
+                    table->buckets[bucket].tags[slot] = 0;
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Retrieves the number of slots, the size the table can reach before it grows
+    size_t Capacity() const
+    {
+        Reclaim::Epoch::Guard guard;
+        return (m_table.load(std::memory_order_acquire)->mask + 1) * SlotsPerBucket;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Reclaim::Epoch::Guard guard;
+        auto table = m_table.load(std::memory_order_acquire);
+        Bucket copy;
+        for (size_t index = 0; index <= table->mask; ++index)
+        {
+            // copy the bucket so the function object runs with no version to validate
+            const auto& stripe = StripeOf(index);
+            for (size_t attempt = 0; ; ++attempt)
+            {
+                uint64_t version;
+                if (stripe.ReadLock(version))
+                {
+                    copy = table->buckets[index];
+                    if (stripe.Validate(version))
+                    {
+                        break;
+                    }
+                }
+                Backoff(attempt);
+            }
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot)
+            {
+                if (copy.tags[slot])
+                {
+                    funcObj(copy.slots[slot].key, copy.slots[slot].value);
+                }
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        AllStripesGuard guard(*this);
+        auto table = m_table.load(std::memory_order_relaxed);
+        for (size_t index = 0; index <= table->mask; ++index)
+        {
+            auto& bucket = table->buckets[index];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot)
+            {
+                if (bucket.tags[slot])
+                {
+                    funcObj(bucket.slots[slot].key, bucket.slots[slot].value);
+                }
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note Holds the stripes of the key's two buckets while the function runs,
+    /// or every stripe if room must be made for a new key
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        const size_t hash = m_hash(key);
+        const uint8_t tag = Tag(hash);
+        bool stored = false;
+        {
+            // the table may be replaced, and freed, until its stripes are held
+            Reclaim::Epoch::Guard epoch;
+            for (;;)
+            {
+                auto table = m_table.load(std::memory_order_acquire);
+                const size_t first = hash & table->mask;
+                const size_t second = Alternate(*table, first, tag);
+                StripeGuard guard(*this, first, second);
+                if (table != m_table.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+                if (UpsertInBuckets(*table, first, second, tag, key, funcObj, stored))
+                {
+                    return stored;
+                }
+                break;
+            }
+        }
+        // a new key and both buckets are full: make room with every stripe held
+        AllStripesGuard guard(*this);
+        auto table = m_table.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const size_t first = hash & table->mask;
+            const size_t second = Alternate(*table, first, tag);
+            if (UpsertInBuckets(*table, first, second, tag, key, funcObj, stored))
+            {
+                return stored;
+            }
+            size_t bucket, slot;
+            if (MakeRoom(*table, first, second, bucket, slot))
+            {
+                Value value = Value();
+                if (!funcObj(value, false))
+                {
+                    return false;
+                }
+                Store(table->buckets[bucket], slot, tag, key, value);
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            table = Grow(*table);
+        }
+    }
+
+protected:
+
+    /// @brief A key and its value, side by side so that finding the key brings the value's first bytes along
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+    /// @brief The slots of a bucket, after the tag of each slot's key or 0 if it is empty
+    struct Bucket
+    {
+        uint8_t tags[SlotsPerBucket];
+        Slot slots[SlotsPerBucket];
+    };
+
+    /// @brief The buckets, a power of two of them
+    struct Table
+    {
+        explicit Table(size_t bucketCount)
+            : mask(bucketCount - 1), buckets(new Bucket[bucketCount]())
+        {
+
+        }
+
+        const size_t mask;
+        std::unique_ptr<Bucket[]> buckets;
+    };
+
+    /// @brief A version lock alone on its cache line, so that stripes do not share one
+    struct Stripe : Lock::Optimistic
+    {
+        char padding[64 - sizeof(Lock::Optimistic)];
+    };
+
+    /// @brief Holds the stripes of two buckets, taken in order so writers cannot deadlock
+    class StripeGuard
+    {
+    public:
+        StripeGuard(const Cuckoo& store, size_t first, size_t second)
+            : m_first(&store.StripeOf(std::min(first & (StripeCount - 1), second & (StripeCount - 1)))),
+              m_second(&store.StripeOf(std::max(first & (StripeCount - 1), second & (StripeCount - 1))))
+        {
+            m_first->Lock();
+            if (m_second != m_first)
+            {
+                m_second->Lock();
+            }
+        }
+
+        ~StripeGuard()
+        {
+            if (m_second != m_first)
+            {
+                m_second->Unlock();
+            }
+            m_first->Unlock();
+        }
+
+        StripeGuard(const StripeGuard&) = delete;
+        StripeGuard& operator=(const StripeGuard&) = delete;
+
+    private:
+        const Lock::Optimistic* m_first;
+        const Lock::Optimistic* m_second;
+    };
+
+    /// @brief Holds every stripe, which only moving keys around and growing need
+    class AllStripesGuard
+    {
+    public:
+        explicit AllStripesGuard(const Cuckoo& store) : m_store(store)
+        {
+            for (size_t stripe = 0; stripe < StripeCount; ++stripe)
+            {
+                m_store.m_stripes[stripe].Lock();
+            }
+        }
+
+        ~AllStripesGuard()
+        {
+            for (size_t stripe = StripeCount; stripe-- > 0; )
+            {
+                m_store.m_stripes[stripe].Unlock();
+            }
+        }
+
+        AllStripesGuard(const AllStripesGuard&) = delete;
+        AllStripesGuard& operator=(const AllStripesGuard&) = delete;
+
+    private:
+        const Cuckoo& m_store;
+    };
+
+    /// @brief A bucket reached by the search for room, and how
+    struct Step
+    {
+        /// @brief The bucket reached
+        size_t bucket;
+        /// @brief The step of the bucket whose key would move here, or Root
+        size_t parent;
+        /// @brief The slot of that key in its bucket
+        size_t slot;
+        /// @brief How many keys would move to get here
+        size_t depth;
+    };
+
+    /// @brief The parent of the two buckets the search starts from
+    static const size_t Root = static_cast<size_t>(-1);
+
+    /// @brief Restarts that spin before each further restart yields the processor
+    static const size_t SpinsBeforeYield = 16;
+
+    /// @brief Waits a little before a reader starts over, longer once it
+    /// has started over a few times since the writer in the way may not be running
+    static void Backoff(size_t attempt)
+    {
+        if (attempt >= SpinsBeforeYield)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @brief The power of two at least as large as the provided count
+    static size_t RoundUp(size_t count)
+    {
+        size_t rounded = 1;
+        while (rounded < count)
+        {
+            rounded *= 2;
+        }
+        return rounded;
+    }
+
+    /// @brief The tag of a hash, never 0
+    static uint8_t Tag(size_t hash)
+    {
+        // bits the bucket index only uses in tables of over 16M buckets
+        auto tag = static_cast<uint8_t>(hash >> 24);
+        return tag ? tag : 1;
+    }
+
+    /// @brief The other bucket of a key, given one of its buckets and its tag
+    /// @note Applied twice it gives back the bucket it started from
+    static size_t Alternate(const Table& table, size_t bucket, uint8_t tag)
+    {
+        return (bucket ^ ((tag + 1) * 0xc6a4a7935bd1e995ULL)) & table.mask;
+    }
+
+    /// @brief Hints the cache to load the tags of a bucket
+    static void Prefetch(const Bucket& bucket)
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(&bucket);
+#endif
+    }
+
+    /// @brief The stripe guarding the provided bucket
+    const Lock::Optimistic& StripeOf(size_t bucket) const
+    {
+        return m_stripes[bucket & (StripeCount - 1)];
+    }
+
+    /// @brief The slot of the provided key in the provided bucket, SlotsPerBucket if absent
+    static size_t Locate(const Bucket& bucket, uint8_t tag, const Key& key)
+    {
+        for (size_t slot = 0; slot < SlotsPerBucket; ++slot)
+        {
+            if (bucket.tags[slot] == tag && bucket.slots[slot].key == key)
+            {
+                return slot;
+            }
+        }
+        return SlotsPerBucket;
+    }
+
+    /// @brief Copies the value of the provided key if it is in the provided bucket
+    static bool Find(const Bucket& bucket, uint8_t tag, const Key& key, Value& value)
+    {
+        size_t slot = Locate(bucket, tag, key);
+        if (slot == SlotsPerBucket)
+        {
+            return false;
+        }
+        value = bucket.slots[slot].value;
+        return true;
+    }
+
+    /// @brief Fills a slot
+    static void Store(Bucket& bucket, size_t slot, uint8_t tag, const Key& key, const Value& value)
+    {
+        bucket.slots[slot].key = key;
+        bucket.slots[slot].value = value;
+        bucket.tags[slot] = tag;
+    }
+
+    /// @brief Overwrites the key in either bucket or fills a free slot of either
+    /// @return false if the key is absent and both buckets are full
+    /// @note The stripes of both buckets must be held
+    bool PutInBuckets(Table& table, size_t first, size_t second, uint8_t tag, const Key& key, const Value& value)
+    {
+        for (size_t bucket : { first, second })
+        {
+            size_t slot = Locate(table.buckets[bucket], tag, key);
+            if (slot != SlotsPerBucket)
+            {
+                table.buckets[bucket].slots[slot].value = value;
+                return true;
+            }
+        }
+        size_t bucket, slot;
+        if (!FreeSlot(table, first, second, bucket, slot))
+        {
+            return false;
+        }
+        Store(table.buckets[bucket], slot, tag, key, value);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @brief Reads, modifies and writes the key in either bucket or fills a free slot of either
+    /// @param[out] stored whether the function's value was stored
+    /// @return false if the key is absent and both buckets are full, without calling the function
+    /// @note The stripes of both buckets must be held
+    bool UpsertInBuckets(Table& table, size_t first, size_t second, uint8_t tag, const Key& key,
+                         const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj, bool& stored)
+    {
+        for (size_t bucket : { first, second })
+        {
+            size_t slot = Locate(table.buckets[bucket], tag, key);
+            if (slot != SlotsPerBucket)
+            {
+                Value value = table.buckets[bucket].slots[slot].value;
+                stored = funcObj(value, true);
+                if (stored)
+                {
+                    table.buckets[bucket].slots[slot].value = value;
+                }
+                return true;
+            }
+        }
+        size_t bucket, slot;
+        if (!FreeSlot(table, first, second, bucket, slot))
+        {
+            return false;
+        }
+        Value value = Value();
+        stored = funcObj(value, false);
+        if (stored)
+        {
+            Store(table.buckets[bucket], slot, tag, key, value);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /// @brief Frees a slot in one of the two provided buckets by moving keys to their other bucket
+    /// Searches breadth first so the fewest keys move.
+    /// @return false if no room can be made within MaxPathLength moves
+    /// @note Every stripe must be held
+    bool MakeRoom(Table& table, size_t first, size_t second, size_t& bucket, size_t& slot)
+    {
+        auto& steps = m_steps;
+        steps.clear();
+        steps.push_back(Step { first, Root, 0, 0 });
+        steps.push_back(Step { second, Root, 0, 0 });
+        for (size_t head = 0; head < steps.size(); ++head)
+        {
+            const Step step = steps[head];
+            const auto& reached = table.buckets[step.bucket];
+            for (size_t free = 0; free < SlotsPerBucket; ++free)
+            {
+                if (!reached.tags[free])
+                {
+                    Shift(table, steps, head, free, bucket, slot);
+                    return true;
+                }
+            }
+            if (step.depth == MaxPathLength)
+            {
+                continue;
+            }
+            for (size_t moved = 0; moved < SlotsPerBucket; ++moved)
+            {
+                size_t next = Alternate(table, step.bucket, reached.tags[moved]);
+                // a path through the same bucket twice would move a key out of a slot it just filled
+                bool onPath = false;
+                for (size_t index = head; index != Root && !onPath; index = steps[index].parent)
+                {
+                    onPath = steps[index].bucket == next;
+                }
+                if (!onPath)
+                {
+                    steps.push_back(Step { next, head, moved, step.depth + 1 });
+                }
+            }
+        }
+        return false;
+    }
+
+    /// @brief Moves each key along the path the search found, the last first
+    /// @note Every stripe must be held
+    static void Shift(Table& table, const std::vector<Step>& steps, size_t index, size_t free, size_t& bucket, size_t& slot)
+    {
+        while (steps[index].parent != Root)
+        {
+            const Step& step = steps[index];
+            auto& from = table.buckets[steps[step.parent].bucket];
+            Store(table.buckets[step.bucket], free, from.tags[step.slot], from.slots[step.slot].key, from.slots[step.slot].value);
+            from.tags[step.slot] = 0;
+            free = step.slot;
+            index = step.parent;
+        }
+        bucket = steps[index].bucket;
+        slot = free;
+    }
+
+    /// @brief Publishes a table with twice the buckets holding every key and retires the provided one
+    /// @return the new table
+    /// @note Every stripe must be held
+    Table* Grow(Table& table)
+    {
+        for (size_t bucketCount = (table.mask + 1) * 2; ; bucketCount *= 2)
+        {
+            std::unique_ptr<Table> grown(new Table(bucketCount));
+            if (Rehash(table, *grown))
+            {
+                m_table.store(grown.get(), std::memory_order_release);
+                Reclaim::Epoch::Retire(&table);
+                // a retired table is freed two epochs on: try for both now rather than
+                // keep the last tables, together as large as the new one, until later grows
+                Reclaim::Epoch::Collect();
+                Reclaim::Epoch::Collect();
+                return grown.release();
+            }
+        }
+    }
+
+    /// @brief Puts every key of one table into another, empty one
+    /// @return false if the other table ran out of room
+    bool Rehash(const Table& from, Table& to)
+    {
+        for (size_t index = 0; index <= from.mask; ++index)
+        {
+            const auto& bucket = from.buckets[index];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot)
+            {
+                if (!bucket.tags[slot])
+                {
+                    continue;
+                }
+                const uint8_t tag = bucket.tags[slot];
+                const size_t first = m_hash(bucket.slots[slot].key) & to.mask;
+                const size_t second = Alternate(to, first, tag);
+                size_t toBucket, toSlot;
+                if (!FreeSlot(to, first, second, toBucket, toSlot) && !MakeRoom(to, first, second, toBucket, toSlot))
+                {
+                    return false;
+                }
+                Store(to.buckets[toBucket], toSlot, tag, bucket.slots[slot].key, bucket.slots[slot].value);
+            }
+        }
+        return true;
+    }
+
+    /// @brief Finds a free slot in either of two buckets
+    static bool FreeSlot(const Table& table, size_t first, size_t second, size_t& bucket, size_t& slot)
+    {
+        for (size_t candidate : { first, second })
+        {
+            for (size_t index = 0; index < SlotsPerBucket; ++index)
+            {
+                if (!table.buckets[candidate].tags[index])
+                {
+                    bucket = candidate;
+                    slot = index;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// @brief The current table
+    std::atomic<Table*> m_table;
+
+    /// @brief The number of entries
+    std::atomic<size_t> m_size;
+
+    /// @brief The hash functor
+    Hash m_hash;
+
+    /// @brief The version locks guarding the buckets
+    std::unique_ptr<Stripe[]> m_stripes;
+
+    /// @brief The buckets MakeRoom() reached, kept to spare it an allocation per call
+    /// @note Every stripe must be held
+    std::vector<Step> m_steps;
+
+};
+
+} } // namespace Kvs::KeyValueStore
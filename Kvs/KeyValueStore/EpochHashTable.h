@@ -0,0 +1,271 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::EpochHashTable class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include "../Reclaim/Epoch.h"
+#include <atomic>
+#include <memory>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store using a chained hash table whose readers take no lock
+/// Get(), Size() and ForEach() only enter a Reclaim::Epoch guard. Nodes are
+/// never modified once published: Put() or Upsert() of an existing key and
+/// Transform() link in a copy, and Remove() unlinks, so readers see either
+/// the old or the new node and the replaced one is retired to the epoch.
+/// Growing the table copies every node into a new table, publishes it and
+/// retires the old table with its nodes. Writers are serialized by the locking policy,
+/// which readers never touch.
+/// @note ForEach() is not a snapshot: entries put or removed while it runs
+/// may or may not be visited.
+template <typename Key, typename Value, typename Hash, typename LockPolicy>
+class EpochHashTable : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief Number of buckets of an empty table
+    static const size_t InitialBucketCount = 16;
+
+    /// @brief Constructor
+    EpochHashTable()
+        : m_table(new Table(InitialBucketCount)), m_size(0), m_hash(), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    /// @note Nodes retired earlier are freed by the epoch, not here
+    ~EpochHashTable()
+    {
+        delete m_table.load(std::memory_order_relaxed);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        auto table = m_table.load(std::memory_order_relaxed);
+        auto link = Find(*table, key);
+        auto node = link->load(std::memory_order_relaxed);
+        if (node)
+        {
+            Replace(*link, node, value);
+            return true;
+        }
+        Insert(*table, key, value);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        Reclaim::Epoch::Guard guard;
+        auto table = m_table.load(std::memory_order_acquire);
+        auto node = table->buckets[m_hash(key) & table->mask].load(std::memory_order_acquire);
+        while (node)
+        {
+            if (node->key == key)
+            {
+                value = node->value;
+                return true;
+            }
+            node = node->next.load(std::memory_order_acquire);
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        auto link = Find(*m_table.load(std::memory_order_relaxed), key);
+        auto node = link->load(std::memory_order_relaxed);
+        if (!node)
+        {
+            return false;
+        }
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        Reclaim::Epoch::Retire(node);
+        m_size.store(m_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Reclaim::Epoch::Guard guard;
+        auto table = m_table.load(std::memory_order_acquire);
+        for (size_t index = 0; index <= table->mask; ++index)
+        {
+            for (auto node = table->buckets[index].load(std::memory_order_acquire); node;
+                 node = node->next.load(std::memory_order_acquire))
+            {
+                funcObj(node->key, node->value);
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto table = m_table.load(std::memory_order_relaxed);
+        for (size_t index = 0; index <= table->mask; ++index)
+        {
+            auto link = &table->buckets[index];
+            while (auto node = link->load(std::memory_order_relaxed))
+            {
+                Value value = node->value;
+                funcObj(node->key, value);
+                link = &Replace(*link, node, value)->next;
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto table = m_table.load(std::memory_order_relaxed);
+        auto link = Find(*table, key);
+        auto node = link->load(std::memory_order_relaxed);
+        Value value = node ? node->value : Value();
+        if (!funcObj(value, node != nullptr))
+        {
+            return false;
+        }
+        if (node)
+        {
+            Replace(*link, node, value);
+            return true;
+        }
+        Insert(*table, key, value);
+        return true;
+    }
+
+protected:
+
+    /// @brief An entry, immutable once published except for its next pointer
+    struct Node
+    {
+        Node(const Key& key_, const Value& value_, Node* next_)
+            : key(key_), value(value_), next(next_) { }
+
+        const Key key;
+        const Value value;
+        std::atomic<Node*> next;
+    };
+
+    /// @brief The buckets, which own every node reachable from them
+    struct Table
+    {
+        explicit Table(size_t bucketCount)
+            : mask(bucketCount - 1), buckets(new std::atomic<Node*>[bucketCount])
+        {
+            for (size_t index = 0; index < bucketCount; ++index)
+            {
+                buckets[index].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~Table()
+        {
+            for (size_t index = 0; index <= mask; ++index)
+            {
+                auto node = buckets[index].load(std::memory_order_relaxed);
+                while (node)
+                {
+                    auto next = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+        }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    /// @brief Returns the link pointing at the node of the provided key, or at null
+    /// @note Writers only
+    std::atomic<Node*>* Find(Table& table, const Key& key) const
+    {
+        auto link = &table.buckets[m_hash(key) & table.mask];
+        for (auto node = link->load(std::memory_order_relaxed); node && !(node->key == key);
+             node = link->load(std::memory_order_relaxed))
+        {
+            link = &node->next;
+        }
+        return link;
+    }
+
+    /// @brief Publishes a copy of a node holding the provided value and retires the original
+    /// @note Writers only
+    Node* Replace(std::atomic<Node*>& link, Node* node, const Value& value)
+    {
+        auto replacement = new Node(node->key, value, node->next.load(std::memory_order_relaxed));
+        link.store(replacement, std::memory_order_release);
+        Reclaim::Epoch::Retire(node);
+        return replacement;
+    }
+
+    /// @brief Publishes a node for a key not in the table, growing the table once it holds a key per bucket
+    /// @note Writers only
+    void Insert(Table& table, const Key& key, const Value& value)
+    {
+        auto& bucket = table.buckets[m_hash(key) & table.mask];
+        bucket.store(new Node(key, value, bucket.load(std::memory_order_relaxed)), std::memory_order_release);
+        size_t size = m_size.load(std::memory_order_relaxed) + 1;
+        m_size.store(size, std::memory_order_relaxed);
+        if (size > table.mask + 1)
+        {
+            Grow(table);
+        }
+    }
+
+    /// @brief Publishes a table with twice the buckets and retires the current one
+    /// @note Writers only
+    void Grow(Table& table)
+    {
+        auto grown = new Table((table.mask + 1) * 2);
+        for (size_t index = 0; index <= table.mask; ++index)
+        {
+            for (auto node = table.buckets[index].load(std::memory_order_relaxed); node;
+                 node = node->next.load(std::memory_order_relaxed))
+            {
+                auto& bucket = grown->buckets[m_hash(node->key) & grown->mask];
+                bucket.store(new Node(node->key, node->value, bucket.load(std::memory_order_relaxed)),
+                             std::memory_order_relaxed);
+            }
+        }
+        m_table.store(grown, std::memory_order_release);
+        Reclaim::Epoch::Retire(&table);
+    }
+
+    /// @brief The current table
+    std::atomic<Table*> m_table;
+
+    /// @brief The number of entries, written only by writers
+    std::atomic<size_t> m_size;
+
+    /// @brief The hash functor
+    Hash m_hash;
+
+    /// @brief The locking policy, serializing writers only
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,240 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Expiring class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include "../Expiry/TimerWheel.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief What an Expiring store keeps in the store it decorates for each key
+template <typename Value>
+struct ExpiringEntry
+{
+    /// @brief The value
+    Value value;
+    /// @brief The tick the key expires at, or Expiring::NoDeadline
+    uint64_t deadline;
+};
+
+/// @brief A key->value store decorator whose keys may expire after a time to live
+/// Put() with a time to live files the key in an Expiry::TimerWheel as well as
+/// storing it. An expired key is no longer found by Get(), ForEach() or
+/// Transform() right away, and is removed from the decorated store by Reap(),
+/// which advances the wheel to the current time and removes the keys that
+/// came due, ReapBatch at a time so that Put() and Remove() are only held back
+/// briefly. Reap() is for the caller to run now and then, e.g. from an
+/// Expiry::Reaper thread. Get() adds no lock of its own to the decorated
+/// store's Get() and only reads the clock for keys that have a deadline.
+/// Put() without a time to live, and Remove(), leave the key's timer behind:
+/// it is ignored when it fires since the key no longer has its deadline.
+/// @note Size() counts expired keys until they are reaped.
+/// @note Put(), Remove(), Upsert() and Reap() are serialized by LockPolicy; the decorated
+/// store must allow Get() concurrently with them if the store is used that way.
+template <typename Key, typename Value, typename LockPolicy, typename Clock = std::chrono::steady_clock>
+class Expiring : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief The decorated key->value store, holding the values and their deadlines
+    using EntryStoreSharedPtr = typename TypedKeyValueStore<Key, ExpiringEntry<Value>>::SharedPtr;
+
+    /// @brief The deadline of a key that never expires
+    static const uint64_t NoDeadline = UINT64_MAX;
+
+    /// @brief Keys Reap() removes per hold of the lock
+    static const size_t ReapBatch = 256;
+
+    /// @brief Constructor
+    /// @param entryStore the decorated store, which should be empty
+    /// @param tick the wheel's resolution: keys expire on the first tick at or after their time to live
+    Expiring(EntryStoreSharedPtr entryStore, typename Clock::duration tick = std::chrono::milliseconds(1))
+        : m_entryStore(entryStore)
+        , m_wheel()
+        , m_lock()
+        , m_start(Clock::now())
+        , m_tick(tick)
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Expiring()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    /// @note A key put this way never expires, even if it was put with a time to live before
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        return m_entryStore->Put(key, ExpiringEntry<Value> { value, NoDeadline });
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        ScopedLock lock(m_lock);
+        return m_entryStore->Put(std::move(key), ExpiringEntry<Value> { std::move(value), NoDeadline });
+    }
+
+    /// @brief Puts a key->value pair that expires after the provided time to live
+    bool Put(const Key& key, const Value& value, typename Clock::duration timeToLive)
+    {
+        // rounded up, so a key never expires early
+        auto sinceStart = Clock::now() + timeToLive - m_start;
+        uint64_t deadline = sinceStart.count() > 0 ? (sinceStart + m_tick - typename Clock::duration(1)) / m_tick : 0;
+        ScopedLock lock(m_lock);
+        if (!m_entryStore->Put(key, ExpiringEntry<Value> { value, deadline }))
+        {
+            return false;
+        }
+        m_wheel.Schedule(key, deadline);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        ExpiringEntry<Value> entry;
+        if (!m_entryStore->Get(key, entry) || (entry.deadline != NoDeadline && Expired(entry, Now())))
+        {
+            return false;
+        }
+        value = entry.value;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        return m_entryStore->Remove(key);
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_entryStore->Size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        const uint64_t now = Now();
+        m_entryStore->ForEach([&funcObj, now] (const Key& key, const ExpiringEntry<Value>& entry) {
+            if (!Expired(entry, now))
+            {
+                funcObj(key, entry.value);
+            }
+        });
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        const uint64_t now = Now();
+        m_entryStore->Transform([&funcObj, now] (const Key& key, ExpiringEntry<Value>& entry) {
+            if (!Expired(entry, now))
+            {
+                funcObj(key, entry.value);
+            }
+        });
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note A key held keeps its deadline; an expired key counts as absent and
+    /// is stored again as a key that never expires, as by Put()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        const uint64_t now = Now();
+        ScopedLock lock(m_lock);
+        return m_entryStore->Upsert(key, [&funcObj, now] (ExpiringEntry<Value>& entry, bool found) {
+            if (found && Expired(entry, now))
+            {
+                entry = ExpiringEntry<Value> { Value(), NoDeadline };
+                found = false;
+            }
+            else if (!found)
+            {
+                entry.deadline = NoDeadline;
+            }
+            return funcObj(entry.value, found);
+        });
+    }
+
+    /// @brief Removes the keys that expired since the last call
+    /// @return the number of keys removed
+    size_t Reap()
+    {
+        std::vector<typename Expiry::TimerWheel<Key>::Timer> due;
+        {
+            ScopedLock lock(m_lock);
+            m_wheel.Advance(Now(), due);
+        }
+        size_t removed = 0;
+        for (size_t first = 0; first < due.size(); first += ReapBatch)
+        {
+            const size_t last = first + ReapBatch < due.size() ? first + ReapBatch : due.size();
+            ScopedLock lock(m_lock);
+            for (size_t timer = first; timer < last; ++timer)
+            {
+                // unless the key was removed or put again since
+                ExpiringEntry<Value> entry;
+                if (m_entryStore->Get(due[timer].key, entry) && entry.deadline == due[timer].deadline)
+                {
+                    removed += m_entryStore->Remove(due[timer].key);
+                }
+            }
+        }
+        return removed;
+    }
+
+    /// @brief Returns the number of timers not fired yet, including those of keys put again or removed since
+    size_t GetTimerCount() const
+    {
+        ScopedLock lock(m_lock);
+        return m_wheel.Size();
+    }
+
+protected:
+
+    /// @brief Returns the number of whole ticks since construction
+    uint64_t Now() const
+    {
+        return (Clock::now() - m_start) / m_tick;
+    }
+
+    /// @brief Returns whether an entry expired by the provided tick
+    static bool Expired(const ExpiringEntry<Value>& entry, uint64_t now)
+    {
+        return entry.deadline <= now;
+    }
+
+    /// @brief The decorated key->value store
+    EntryStoreSharedPtr m_entryStore;
+
+    /// @brief The timers of the keys put with a time to live
+    Expiry::TimerWheel<Key> m_wheel;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+    /// @brief When tick zero began
+    typename Clock::time_point m_start;
+
+    /// @brief The length of a tick
+    typename Clock::duration m_tick;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,179 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Filtered class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store decorator that answers Get() of most absent keys without the decorated store
+/// Every key of the decorated store has its hash in a Filter, e.g.
+/// Filter::BlockedBloom or Filter::CountingBloom, and a Get() of a key the
+/// filter rejects returns false before the decorated store is looked at, so
+/// a miss costs a hash and one cache line instead of, for a Compound store,
+/// a front-end lookup plus a locked back-end lookup, or disk reads for a
+/// store on disk. Put(), Remove() and Upsert() are serialized by LockPolicy; Get() adds
+/// no lock of its own.
+/// @note The filter is sized for the expected number of keys: beyond that
+/// more and more absent keys get through to the decorated store.
+/// @note With a filter that can not forget, e.g. Filter::BlockedBloom,
+/// removed keys keep getting through until the filter is rebuilt.
+/// @note The decorated store must allow Get() concurrently with Put() and
+/// Remove() if the store is used that way.
+template <typename Key, typename Value, typename Hash, typename Filter, typename LockPolicy>
+class Filtered : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief The decorated key->value store
+    using KeyValueStoreSharedPtr = typename TypedKeyValueStore<Key, Value>::SharedPtr;
+
+    /// @brief Constructor, adds the keys the decorated store already holds to the filter
+    /// @param keyValueStore the decorated store
+    /// @param expectedKeys most keys expected at once, to size the filter
+    /// @param bitsPerKey bits (or counters) the filter spends per key
+    Filtered(KeyValueStoreSharedPtr keyValueStore, size_t expectedKeys, size_t bitsPerKey = 10)
+        : m_keyValueStore(keyValueStore)
+        , m_filter(expectedKeys, bitsPerKey)
+        , m_hash()
+        , m_lock()
+    {
+        m_keyValueStore->ForEach([this] (const Key& key, const Value&) { m_filter.Add(m_hash(key)); });
+    }
+
+    /// @brief Destructor
+    ~Filtered()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        return Write(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        return Write(std::move(key), std::move(value));
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        return m_filter.MayContain(m_hash(key)) && m_keyValueStore->Get(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        if (!m_filter.MayContain(hash) || !m_keyValueStore->Remove(key))
+        {
+            return false;
+        }
+        m_filter.Remove(hash);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_keyValueStore->Size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        m_keyValueStore->ForEach(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        m_keyValueStore->Transform(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        bool added = false;
+        const bool stored = m_keyValueStore->Upsert(key, [&] (Value& value, bool found)
+            {
+                if (!funcObj(value, found))
+                {
+                    return false;
+                }
+                // in the filter before the decorated store stores the key, as for Put()
+                if (!found && !added)
+                {
+                    m_filter.Add(hash);
+                    added = true;
+                }
+                return true;
+            } );
+        if (added && !stored)
+        {
+            m_filter.Remove(hash);
+        }
+        return stored;
+    }
+
+    /// @brief Returns the bytes taken by the filter
+    size_t GetFilterBytes() const
+    {
+        return m_filter.GetBytes();
+    }
+
+protected:
+
+    /// @brief Adds the key's hash to the filter if the key is new, then puts the key
+    /// in the decorated store, copying or moving from the key and value as they were passed
+    template <typename KeyArg, typename ValueArg>
+    bool Write(KeyArg&& key, ValueArg&& value)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        // a key already held is already in the filter, and must not be counted twice
+        Value previous;
+        const bool added = !m_filter.MayContain(hash) || !m_keyValueStore->Get(key, previous);
+        if (added)
+        {
+            // in the filter before the decorated store, so a Get() that finds the key never misses it
+            m_filter.Add(hash);
+        }
+        if (!m_keyValueStore->Put(std::forward<KeyArg>(key), std::forward<ValueArg>(value)))
+        {
+            if (added)
+            {
+                m_filter.Remove(hash);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief The decorated key->value store
+    KeyValueStoreSharedPtr m_keyValueStore;
+
+    /// @brief The hashes of the keys held
+    Filter m_filter;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,226 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Frozen class and Kvs::KeyValueStore::Freeze()
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief An immutable, ordered key->value store for read-only reference tables
+/// Built once from any other store by Freeze(), it keeps keys and values in
+/// two parallel arrays in Eytzinger (breadth-first) order: the root at index 1
+/// and the children of index k at 2k and 2k+1. A lookup walks down by
+/// computing the next index from the comparison rather than branching on it,
+/// and prefetches the descendants a few levels ahead while it compares. The
+/// top levels that every lookup visits share a few cache lines, there are no
+/// pointers, and values are only touched once their key is found.
+/// Put(), Remove() and Upsert() fail and Transform() does nothing: freeze again to change it.
+/// @note Nothing ever writes after construction, so any number of threads may
+/// read concurrently without locking.
+template <typename Key, typename Value, typename Compare>
+class Frozen : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Constructor, copies every key->value pair of the provided store
+    /// @note The provided store is only read, through ForEach()
+    explicit Frozen(const TypedKeyValueStore<Key, Value>& source)
+        : m_keys(), m_values(), m_compare()
+    {
+        std::vector<std::pair<Key, Value>> sorted;
+        sorted.reserve(source.Size());
+        source.ForEach([&sorted] (const Key& key, const Value& value) {
+            sorted.emplace_back(key, value);
+        });
+        // ForEach() of an unordered store visits in any order
+        std::sort(sorted.begin(), sorted.end(),
+            [this] (const std::pair<Key, Value>& lhs, const std::pair<Key, Value>& rhs) {
+                return m_compare(lhs.first, rhs.first);
+            });
+        // index 0 is unused so that the children of k are 2k and 2k+1
+        m_keys.resize(sorted.size() + 1);
+        m_values.resize(sorted.size() + 1);
+        size_t next = 0;
+        Place(sorted, next, 1);
+    }
+
+    /// @brief Destructor
+    ~Frozen()
+    {
+
+    }
+
+    /// @brief Fails, a frozen store cannot change
+    bool Put(const Key& key, const Value& value)
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        size_t index = LowerBound(key);
+        if (index == 0 || m_compare(key, m_keys[index]))
+        {
+            return false;
+        }
+        value = m_values[index];
+        return true;
+    }
+
+    /// @brief Fails, a frozen store cannot change
+    bool Remove(const Key& key)
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_keys.size() - 1;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    /// @note Visits keys in order
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        for (size_t index = First(); index != 0; index = Next(index))
+        {
+            funcObj(m_keys[index], m_values[index]);
+        }
+    }
+
+    /// @brief Does nothing, a frozen store cannot change
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+
+    }
+
+    /// @brief Fails, a frozen store cannot change
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        return false;
+    }
+
+protected:
+
+    /// @brief How many levels below the current index a lookup prefetches
+    /// The 2^PrefetchLevels descendants there are adjacent, so it takes a few cache lines at most.
+    static const size_t PrefetchLevels = 3;
+
+    /// @brief Bytes in a cache line
+    static const size_t CacheLineBytes = 64;
+
+    /// @brief Fills the subtree rooted at index with the next sorted pairs, in order
+    void Place(std::vector<std::pair<Key, Value>>& sorted, size_t& next, size_t index)
+    {
+        if (index < m_keys.size())
+        {
+            Place(sorted, next, 2 * index);
+            m_keys[index] = sorted[next].first;
+            m_values[index] = std::move(sorted[next].second);
+            ++next;
+            Place(sorted, next, 2 * index + 1);
+        }
+    }
+
+    /// @brief Hints the cache to load the descendants PrefetchLevels below index
+    void Prefetch(size_t index) const
+    {
+#if defined(__GNUC__)
+        const size_t descendant = index << PrefetchLevels;
+        if (descendant < m_keys.size())
+        {
+            const char* begin = reinterpret_cast<const char*>(&m_keys[descendant]);
+            for (size_t offset = 0; offset < (sizeof(Key) << PrefetchLevels); offset += CacheLineBytes)
+            {
+                __builtin_prefetch(begin + offset);
+            }
+        }
+#endif
+    }
+
+    /// @brief Finds the index of the first key not less than the provided key
+    /// @return 0 if every key is less
+    size_t LowerBound(const Key& key) const
+    {
+        size_t index = 1;
+        while (index < m_keys.size())
+        {
+            Prefetch(index);
+            // right when the key here is less, left otherwise
+            index = 2 * index + m_compare(m_keys[index], key);
+        }
+        // the path went right after its last left turn, whose parent is the lower bound:
+        // drop the trailing right turns (ones) and then the left turn (zero)
+#if defined(__GNUC__)
+        return index >> (__builtin_ctzll(~static_cast<unsigned long long>(index)) + 1);
+#else
+        while (index & 1)
+        {
+            index >>= 1;
+        }
+        return index >> 1;
+#endif
+    }
+
+    /// @brief The index of the least key, 0 if empty
+    size_t First() const
+    {
+        if (m_keys.size() < 2)
+        {
+            return 0;
+        }
+        size_t index = 1;
+        while (2 * index < m_keys.size())
+        {
+            index = 2 * index;
+        }
+        return index;
+    }
+
+    /// @brief The index of the key after the one at the provided index, 0 if it was the greatest
+    size_t Next(size_t index) const
+    {
+        if (2 * index + 1 < m_keys.size())
+        {
+            // the least key of the right subtree
+            index = 2 * index + 1;
+            while (2 * index < m_keys.size())
+            {
+                index = 2 * index;
+            }
+            return index;
+        }
+        // up past every ancestor this is the right subtree of
+        while (index & 1)
+        {
+            index >>= 1;
+        }
+        return index >> 1;
+    }
+
+    /// @brief The keys in Eytzinger order, index 0 unused
+    std::vector<Key> m_keys;
+
+    /// @brief The value of each key, at the same index
+    std::vector<Value> m_values;
+
+    /// @brief The comparison function object
+    Compare m_compare;
+};
+
+/// @brief Builds a frozen, read-only copy of the provided store, e.g. Freeze<Schema::CompareKeyType>(store)
+/// @note The provided store is unchanged and may go on being used
+template <typename Compare, typename Key, typename Value>
+std::shared_ptr<Frozen<Key, Value, Compare>> Freeze(const TypedKeyValueStore<Key, Value>& store)
+{
+    return std::make_shared<Frozen<Key, Value, Compare>>(store);
+}
+
+} } // namespace Kvs::KeyValueStore
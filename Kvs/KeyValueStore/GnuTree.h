@@ -39,6 +39,16 @@ public:
         return true;
     }
 
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    /// @note The container copies the key and default-constructs a new value,
+    /// which is cheap for values that own their payload, then moves into it
+    bool Put(Key&& key, Value&& value)
+    {
+        ScopedLock lock(m_lock);
+        m_tree[key] = std::move(value);
+        return true;
+    }
+
     /// @copydoc TypedKeyValueStore::Get()
     bool Get(const Key& key, Value& value) const
     {
@@ -76,7 +86,7 @@ public:
     void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
     {
         ScopedLock lock(m_lock);
-        for (auto iter : m_tree)
+        for (const auto& iter : m_tree)
         {
             funcObj(iter.first, iter.second);
         }
@@ -92,6 +102,28 @@ public:
         }
     }
 
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_tree.find(key);
+        const bool found = iter != m_tree.end();
+        Value value = found ? iter->second : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            iter->second = value;
+        }
+        else
+        {
+            m_tree.insert(std::make_pair(key, value));
+        }
+        return true;
+    }
+
 protected:
 
     /// @brief The underlying implementation
@@ -41,6 +41,16 @@ public:
         return true;
     }
 
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    /// @note The container copies the key and default-constructs a new value,
+    /// which is cheap for values that own their payload, then moves into it
+    bool Put(Key&& key, Value&& value)
+    {
+        ScopedLock lock(m_lock);
+        m_trie[key] = std::move(value);
+        return true;
+    }
+
     /// @copydoc TypedKeyValueStore::Get()
     bool Get(const Key& key, Value& value) const
     {
@@ -78,7 +88,7 @@ public:
     void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
     {
         ScopedLock lock(m_lock);
-        for (auto iter : m_trie)
+        for (const auto& iter : m_trie)
         {
             funcObj(iter.first, iter.second);
         }
@@ -94,10 +104,45 @@ public:
         }
     }
 
+    /// @brief Applies the provided function against each key whose elements
+    /// start with the elements of the provided prefix
+    void ForEachPrefix(const Key& prefix, const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        ScopedLock lock(m_lock);
+        auto range = m_trie.prefix_range(prefix);
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            funcObj(iter->first, iter->second);
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_trie.find(key);
+        const bool found = iter != m_trie.end();
+        Value value = found ? iter->second : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            iter->second = value;
+        }
+        else
+        {
+            m_trie.insert(std::make_pair(key, value));
+        }
+        return true;
+    }
+
 protected:
 
     /// @brief The underlying implementation
-    __gnu_pbds::trie<Key, Value, ElementAccess> m_trie;
+    /// @note The prefix search policy keeps no data in the nodes, it only adds prefix_range()
+    __gnu_pbds::trie<Key, Value, ElementAccess, __gnu_pbds::pat_trie_tag, __gnu_pbds::trie_prefix_search_node_update> m_trie;
 
     /// @brief The locking policy
     LockPolicy m_lock;
@@ -0,0 +1,343 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Hopscotch class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store using an open-addressing hash table with hopscotch hashing
+/// Every key lives within Neighborhood slots of its home slot, and each home
+/// slot keeps a bitmap of which of those slots hold its keys, so a Get()
+/// only compares the keys its bitmap points at. Put() probes linearly for an
+/// empty slot and, while it is too far from home, hops it closer by moving
+/// a key of an earlier neighborhood into it; the table grows when no key can
+/// move. Remove() just clears the slot and its bit, so there are no
+/// tombstones and probes stay as short under Put()/Remove() churn as in a
+/// freshly filled table, at the price of a longer Put() than RobinHood.
+/// @note Key must have operator==().
+template <typename Key, typename Value, typename Hash, typename LockPolicy, size_t Neighborhood = 32>
+class Hopscotch : public TypedKeyValueStore<Key, Value>
+{
+    static_assert(Neighborhood > 0 && Neighborhood <= 32, "a neighborhood is kept in a 32 bit bitmap");
+
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief Number of slots of an empty table
+    static const size_t InitialCapacity = 32;
+
+    /// @brief Most times a Put() grows the table to make room for its key
+    static const size_t MaxGrowsPerPut = 2;
+
+    /// @brief Largest fraction of the slots in use before the table grows
+    static constexpr double MaxLoadFactor = 0.9;
+
+    /// @brief Constructor
+    Hopscotch()
+        : m_hops(InitialCapacity, 0), m_used(InitialCapacity, 0), m_slots(InitialCapacity), m_mask(InitialCapacity - 1), m_size(0), m_hash(), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Hopscotch()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    /// @note Fails if more keys share a home slot than its neighborhood holds
+    /// and growing the table MaxGrowsPerPut times did not tell them apart
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        size_t index;
+        if (Find(key, hash, index))
+        {
+            m_slots[index].value = value;
+            return true;
+        }
+        return Add(Slot { key, value }, hash);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        ScopedLock lock(m_lock);
+        size_t index;
+        if (Find(key, m_hash(key), index))
+        {
+            value = m_slots[index].value;
+            return true;
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        size_t index;
+        if (!Find(key, hash, index))
+        {
+            return false;
+        }
+        const size_t home = hash & m_mask;
+        m_hops[home] &= ~(uint32_t(1) << ((index - home) & m_mask));
+        m_used[index] = 0;
+        --m_size;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        ScopedLock lock(m_lock);
+        return m_size;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        ScopedLock lock(m_lock);
+        for (size_t index = 0; index < m_slots.size(); ++index)
+        {
+            if (m_used[index])
+            {
+                funcObj(m_slots[index].key, m_slots[index].value);
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        for (size_t index = 0; index < m_slots.size(); ++index)
+        {
+            if (m_used[index])
+            {
+                funcObj(m_slots[index].key, m_slots[index].value);
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        size_t index;
+        const bool found = Find(key, hash, index);
+        Value value = found ? m_slots[index].value : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            m_slots[index].value = value;
+            return true;
+        }
+        return Add(Slot { key, value }, hash);
+    }
+
+    /// @brief Returns the number of keys found at each distance from their home slot
+    /// @note Element d counts the keys d slots past their home slot; a Get()
+    /// only compares the keys of its home slot, however far they are
+    std::vector<size_t> GetProbeLengths() const
+    {
+        ScopedLock lock(m_lock);
+        std::vector<size_t> lengths;
+        for (uint32_t hops : m_hops)
+        {
+            for (size_t distance = 0; hops; ++distance, hops >>= 1)
+            {
+                if (hops & 1)
+                {
+                    if (lengths.size() <= distance)
+                    {
+                        lengths.resize(distance + 1, 0);
+                    }
+                    ++lengths[distance];
+                }
+            }
+        }
+        return lengths;
+    }
+
+    /// @brief Returns the number of slots
+    size_t GetCapacity() const
+    {
+        ScopedLock lock(m_lock);
+        return Capacity();
+    }
+
+protected:
+
+    /// @brief A key and its value
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+    /// @brief Most slots probed for an empty one before growing instead
+    static const size_t MaxProbe = 512;
+
+    /// @brief The number of slots
+    size_t Capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /// @brief Finds the slot holding the provided key
+    /// @return false if the key is absent
+    bool Find(const Key& key, size_t hash, size_t& index) const
+    {
+        const size_t home = hash & m_mask;
+        for (uint32_t hops = m_hops[home]; hops; hops &= hops - 1)
+        {
+            index = (home + __builtin_ctz(hops)) & m_mask;
+            if (m_slots[index].key == key)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Places a key not in the table, growing the table as often as MaxGrowsPerPut to make room
+    bool Add(const Slot& slot, size_t hash)
+    {
+        if (m_size + 1 > Capacity() * MaxLoadFactor)
+        {
+            Grow();
+        }
+        for (size_t grows = 0; !Insert(slot, hash); ++grows)
+        {
+            if (grows == MaxGrowsPerPut)
+            {
+                return false;
+            }
+            Grow();
+        }
+        ++m_size;
+        return true;
+    }
+
+    /// @brief Places a key that is not in the table yet
+    /// @return false if no empty slot could be brought into its neighborhood, so the table must grow
+    bool Insert(const Slot& slot, size_t hash)
+    {
+        const size_t home = hash & m_mask;
+        const size_t probes = Capacity() < MaxProbe ? Capacity() : MaxProbe;
+        size_t distance = 0;
+        while (distance < probes && m_used[(home + distance) & m_mask])
+        {
+            ++distance;
+        }
+        if (distance == probes)
+        {
+            return false;
+        }
+        while (distance >= Neighborhood)
+        {
+            if (!HopCloser(home, distance))
+            {
+                return false;
+            }
+        }
+        const size_t index = (home + distance) & m_mask;
+        m_slots[index] = slot;
+        m_used[index] = 1;
+        m_hops[home] |= uint32_t(1) << distance;
+        return true;
+    }
+
+    /// @brief Moves the empty slot distance past home closer to home by moving an earlier key into it
+    /// @return false if no key between can move without leaving its own neighborhood
+    bool HopCloser(size_t home, size_t& distance)
+    {
+        const size_t empty = (home + distance) & m_mask;
+        // the furthest home and its first key first, which moves the empty slot back the most
+        for (size_t back = Neighborhood - 1; back > 0; --back)
+        {
+            const size_t candidate = (empty - back) & m_mask;
+            uint32_t hops = m_hops[candidate];
+            if (hops && static_cast<size_t>(__builtin_ctz(hops)) < back)
+            {
+                const size_t moved = __builtin_ctz(hops);
+                const size_t from = (candidate + moved) & m_mask;
+                m_slots[empty] = std::move(m_slots[from]);
+                m_used[empty] = 1;
+                m_used[from] = 0;
+                m_hops[candidate] = (hops & ~(uint32_t(1) << moved)) | (uint32_t(1) << back);
+                distance -= back - moved;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Doubles the number of slots, more if need be, and places every key again
+    void Grow()
+    {
+        std::vector<uint32_t> hops;
+        std::vector<uint8_t> used;
+        std::vector<Slot> slots;
+        m_hops.swap(hops);
+        m_used.swap(used);
+        m_slots.swap(slots);
+        for (size_t capacity = slots.size() * 2; ; capacity *= 2)
+        {
+            m_hops.assign(capacity, 0);
+            m_used.assign(capacity, 0);
+            m_slots.resize(capacity);
+            m_mask = capacity - 1;
+            size_t index = 0;
+            while (index < slots.size() && (!used[index] || Insert(slots[index], m_hash(slots[index].key))))
+            {
+                ++index;
+            }
+            if (index == slots.size())
+            {
+                return;
+            }
+        }
+    }
+
+    /// @brief The neighborhood bitmap of each home slot, bit d set if the slot d past it holds one of its keys
+    std::vector<uint32_t> m_hops;
+
+    /// @brief Whether each slot holds a key
+    std::vector<uint8_t> m_used;
+
+    /// @brief The keys and values
+    std::vector<Slot> m_slots;
+
+    /// @brief Selects a slot from a hash, one less than the power of two number of slots
+    size_t m_mask;
+
+    /// @brief Number of keys stored
+    size_t m_size;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
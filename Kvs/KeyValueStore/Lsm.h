@@ -0,0 +1,840 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Lsm class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include "../Lsm/Run.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief What an Lsm store keeps in its memtables for each key
+template <typename Value>
+struct LsmEntry
+{
+    /// @brief The value
+    Value value;
+    /// @brief Whether the key was removed, in which case the entry shadows older values of the key
+    bool removed;
+};
+
+/// @brief The tunables of an Lsm store
+struct LsmOptions
+{
+    /// @brief How runs are merged as they pile up
+    enum Compaction
+    {
+        /// Each level below 0 is a single run, rewritten whenever the level above
+        /// is merged into it, that takes LevelRatio times the keys of the level
+        /// above before it is merged into the next: fewer runs to read through,
+        /// more rewriting
+        Leveled,
+        /// Each level below 0 gathers up to LevelRatio runs, merged into one run
+        /// of the next level once full: less rewriting, more runs to read through
+        Tiered
+    };
+
+    /// @brief Constructor with the defaults
+    /// @param directory where the runs' files go, created if need be and removed by the store if left empty
+    explicit LsmOptions(const std::string& directory)
+        : directory(directory)
+        , compaction(Leveled)
+        , memtableKeys(4096)
+        , level0Runs(4)
+        , levelRatio(10)
+        , blockBytes(4096)
+        , bitsPerKey(10)
+        , maxImmutables(2)
+        , workers(1)
+    {
+
+    }
+
+    /// @brief Where the runs' files go
+    std::string directory;
+
+    /// @brief How runs are merged
+    Compaction compaction;
+
+    /// @brief Keys the memtable takes before it is frozen and flushed to a run of level 0
+    size_t memtableKeys;
+
+    /// @brief Runs level 0 takes before they are merged into level 1
+    size_t level0Runs;
+
+    /// @brief Growth in keys from one level to the next (Leveled) or runs per level (Tiered)
+    size_t levelRatio;
+
+    /// @brief Bytes per block of a run, the unit a Get() reads from disk
+    size_t blockBytes;
+
+    /// @brief Bloom filter bits per key of a run
+    size_t bitsPerKey;
+
+    /// @brief Frozen memtables waiting to be flushed before writers stall
+    size_t maxImmutables;
+
+    /// @brief Background threads flushing and compacting
+    size_t workers;
+};
+
+/// @brief Counters of an Lsm store, from GetStats()
+struct LsmStats
+{
+    /// @brief Key and value bytes put and removed by the user
+    size_t userBytes;
+
+    /// @brief Bytes written flushing memtables to level 0
+    size_t flushedBytes;
+
+    /// @brief Bytes written merging runs
+    size_t compactedBytes;
+
+    /// @brief Times a writer waited for a flush
+    size_t writeStalls;
+
+    /// @brief Blocks read from disk by Get()
+    size_t blockReads;
+
+    /// @brief Runs in each level
+    std::vector<size_t> runs;
+
+    /// @brief Records, removed keys included, in each level
+    std::vector<size_t> records;
+
+    /// @brief Returns the bytes written to disk per byte the user wrote
+    double GetWriteAmplification() const
+    {
+        return userBytes ? double(flushedBytes + compactedBytes) / userBytes : 0.0;
+    }
+};
+
+/// @brief A key->value store as a log-structured merge tree, for more keys than fit in memory
+/// Put() and Remove() go to the memtable, a store built by the provided
+/// factory, e.g. a StdMap or a GnuTree, with Remove() leaving a removed entry
+/// behind to shadow older values. Once it holds MemtableKeys keys the
+/// memtable is frozen and a fresh one takes over, and worker threads flush
+/// frozen memtables, oldest first, to sorted runs on disk (see Lsm::Run) in
+/// level 0. Runs pile up and are merged level by level as per LsmOptions::
+/// Compaction, the newest value of each key winning and removed keys being
+/// dropped once nothing older lies below them. Get() looks in the memtable,
+/// the frozen memtables and then the runs from newest to oldest, where each
+/// run's Bloom filter spares most disk reads of runs without the key.
+/// Writers stall while MaxImmutables memtables are waiting to be flushed.
+/// Readers take a snapshot of the memtables and runs under a mutex held
+/// only for that, so they never wait for flushes or merges.
+/// @note Put() is a blind write, but Remove() looks the key up to return
+/// whether it was there, and Size(), ForEach() and Transform() merge every
+/// memtable and run. Transform() puts back every key it visits.
+/// @note Memtables whose ForEach() visits keys in Compare order are flushed
+/// without sorting; any other store is sorted first. The memtable must
+/// allow Get() concurrently with Put() if the store is used that way.
+/// @note Nothing is recovered from disk: the runs are removed along with the store.
+/// @note Put(), Remove(), Upsert() and Transform() are serialized by LockPolicy.
+/// Put() returns false once a run could not be written.
+template <typename Key, typename Value, typename Compare, typename Hash, typename LockPolicy>
+class Lsm : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief The memtable type, holding the values and whether they were removed
+    using MemtableSharedPtr = typename TypedKeyValueStore<Key, LsmEntry<Value>>::SharedPtr;
+
+    /// @brief Creates an empty memtable
+    using MemtableFactory = std::function<MemtableSharedPtr()>;
+
+    /// @brief Convenient rename for a run
+    using RunType = Kvs::Lsm::Run<Key, Value, Compare, Hash>;
+
+    /// @brief Convenient rename for a record of a run
+    using RecordType = typename RunType::RecordType;
+
+    /// @brief Constructor, starts the workers
+    /// @param memtableFactory creates the memtables
+    /// @param options where the runs go and how they are merged
+    Lsm(MemtableFactory memtableFactory, const LsmOptions& options)
+        : m_memtableFactory(memtableFactory)
+        , m_options(options)
+        , m_lock()
+        , m_mutex()
+        , m_work()
+        , m_done()
+        , m_version(std::make_shared<Version>())
+        , m_busy()
+        , m_flushing(false)
+        , m_stopping(false)
+        , m_failed(false)
+        , m_nextRun(0)
+        , m_stats()
+        , m_retiredBlockReads(0)
+        , m_compare()
+        , m_hash()
+        , m_workers()
+    {
+        ::mkdir(m_options.directory.c_str(), 0700);
+        m_version->memtable = m_memtableFactory();
+        for (size_t i = 0; i < std::max<size_t>(m_options.workers, 1); ++i)
+        {
+            m_workers.emplace_back([this] { Work(); });
+        }
+    }
+
+    /// @brief Destructor, stops the workers and removes the runs
+    ~Lsm()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_work.notify_all();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+        for (const auto& level : m_version->levels)
+        {
+            for (const auto& run : level)
+            {
+                run->MarkObsolete();
+            }
+        }
+        m_version.reset();
+        ::rmdir(m_options.directory.c_str());
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        return Write(key, LsmEntry<Value> { value, false });
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        LsmEntry<Value> entry;
+        if (Find(*Snapshot(), key, entry) && !entry.removed)
+        {
+            value = entry.value;
+            return true;
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        LsmEntry<Value> entry;
+        if (!Find(*Snapshot(), key, entry) || entry.removed)
+        {
+            return false;
+        }
+        entry.removed = true;
+        return Write(key, entry);
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        size_t size = 0;
+        MergeRecords(*Snapshot(), [&size](const RecordType&) { ++size; });
+        return size;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        MergeRecords(*Snapshot(), [&funcObj](const RecordType& record) { funcObj(record.key, record.value); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        MergeRecords(*Snapshot(), [this, &funcObj](const RecordType& record)
+            {
+                LsmEntry<Value> entry { record.value, false };
+                funcObj(record.key, entry.value);
+                Write(record.key, entry);
+            } );
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note Looks the key up like Remove(), then writes the new value to the memtable
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        LsmEntry<Value> entry;
+        const bool found = Find(*Snapshot(), key, entry) && !entry.removed;
+        Value value = found ? entry.value : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        return Write(key, LsmEntry<Value> { value, false });
+    }
+
+    /// @brief Waits for the workers to flush every frozen memtable and finish merging
+    void WaitUntilIdle() const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_failed || (!m_flushing && m_version->immutables.empty() && !Busy() && !NeedsCompaction(*m_version)); });
+    }
+
+    /// @brief Returns the counters so far
+    LsmStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        LsmStats stats = m_stats;
+        stats.blockReads = m_retiredBlockReads;
+        for (const auto& level : m_version->levels)
+        {
+            stats.runs.push_back(level.size());
+            stats.records.push_back(0);
+            for (const auto& run : level)
+            {
+                stats.records.back() += run->GetRecords();
+                stats.blockReads += run->GetBlockReads();
+            }
+        }
+        return stats;
+    }
+
+protected:
+
+    /// @brief The memtables and runs at some point, never changed once published
+    struct Version
+    {
+        /// @brief The memtable taking writes
+        MemtableSharedPtr memtable;
+
+        /// @brief Frozen memtables, newest first
+        std::vector<MemtableSharedPtr> immutables;
+
+        /// @brief The runs of each level, newest first
+        std::vector<std::vector<typename RunType::SharedPtr>> levels;
+    };
+
+    /// @brief Convenient rename for a shared pointer to a version
+    using VersionSharedPtr = std::shared_ptr<Version>;
+
+    /// @brief A merge picked by a worker: runs of a level, merged with those of the next one if any
+    struct Compaction
+    {
+        /// @brief The level merged into the next one
+        size_t level;
+
+        /// @brief The runs merged, newest first
+        std::vector<typename RunType::SharedPtr> inputs;
+
+        /// @brief How many of the inputs come from the level itself rather than the next one
+        size_t levelInputs;
+
+        /// @brief Whether removed keys may be dropped since nothing lies below the output
+        bool dropRemoved;
+    };
+
+    /// @brief Records, in key order, merged from memtables or runs
+    class Source
+    {
+    public:
+
+        /// @brief Destructor
+        virtual ~Source()
+        {
+
+        }
+
+        /// @brief Returns whether the source is at a record
+        virtual bool Valid() const = 0;
+
+        /// @brief Returns the current record
+        virtual const RecordType& Current() const = 0;
+
+        /// @brief Moves on to the next record
+        virtual void Next() = 0;
+    };
+
+    /// @brief A memtable's records
+    class MemtableSource : public Source
+    {
+    public:
+
+        /// @brief Constructor, copies the memtable's records in key order
+        MemtableSource(const MemtableSharedPtr& memtable)
+            : m_records(Sorted(memtable)), m_position(0)
+        {
+
+        }
+
+        /// @copydoc Source::Valid()
+        bool Valid() const
+        {
+            return m_position < m_records.size();
+        }
+
+        /// @copydoc Source::Current()
+        const RecordType& Current() const
+        {
+            return m_records[m_position];
+        }
+
+        /// @copydoc Source::Next()
+        void Next()
+        {
+            ++m_position;
+        }
+
+    protected:
+
+        /// @brief The records
+        std::vector<RecordType> m_records;
+
+        /// @brief The current record
+        size_t m_position;
+    };
+
+    /// @brief A run's records
+    class RunSource : public Source
+    {
+    public:
+
+        /// @brief Constructor
+        RunSource(const typename RunType::SharedPtr& run)
+            : m_run(run), m_cursor(*run)
+        {
+
+        }
+
+        /// @copydoc Source::Valid()
+        bool Valid() const
+        {
+            return m_cursor.Valid();
+        }
+
+        /// @copydoc Source::Current()
+        const RecordType& Current() const
+        {
+            return m_cursor.Current();
+        }
+
+        /// @copydoc Source::Next()
+        void Next()
+        {
+            m_cursor.Next();
+        }
+
+    protected:
+
+        /// @brief The run, kept alive while read
+        typename RunType::SharedPtr m_run;
+
+        /// @brief Where in the run
+        typename RunType::Cursor m_cursor;
+    };
+
+    /// @brief Returns a memtable's records in key order
+    static std::vector<RecordType> Sorted(const MemtableSharedPtr& memtable)
+    {
+        std::vector<RecordType> records;
+        records.reserve(memtable->Size());
+        memtable->ForEach([&records](const Key& key, const LsmEntry<Value>& entry)
+            {
+                records.push_back(RecordType { key, entry.value, entry.removed });
+            } );
+        auto compare = [](const RecordType& lhs, const RecordType& rhs) { return Compare()(lhs.key, rhs.key); };
+        if (!std::is_sorted(records.begin(), records.end(), compare))
+        {
+            std::sort(records.begin(), records.end(), compare);
+        }
+        return records;
+    }
+
+    /// @brief Calls funcObj with the newest record of each key in the sources, which are newest first
+    template <typename FuncObj>
+    void MergeRecords(std::vector<std::unique_ptr<Source>>& sources, bool dropRemoved, const FuncObj& funcObj) const
+    {
+        while (true)
+        {
+            Source* newest = nullptr;
+            for (auto& source : sources)
+            {
+                if (source->Valid() && (!newest || m_compare(source->Current().key, newest->Current().key)))
+                {
+                    newest = source.get();
+                }
+            }
+            if (!newest)
+            {
+                return;
+            }
+            const RecordType record = newest->Current();
+            for (auto& source : sources)
+            {
+                if (source->Valid() && !m_compare(record.key, source->Current().key))
+                {
+                    source->Next();
+                }
+            }
+            if (!dropRemoved || !record.removed)
+            {
+                funcObj(record);
+            }
+        }
+    }
+
+    /// @brief Calls funcObj with every key of a version that was not removed, in key order
+    template <typename FuncObj>
+    void MergeRecords(const Version& version, const FuncObj& funcObj) const
+    {
+        std::vector<std::unique_ptr<Source>> sources;
+        sources.emplace_back(new MemtableSource(version.memtable));
+        for (const auto& immutable : version.immutables)
+        {
+            sources.emplace_back(new MemtableSource(immutable));
+        }
+        for (const auto& level : version.levels)
+        {
+            for (const auto& run : level)
+            {
+                sources.emplace_back(new RunSource(run));
+            }
+        }
+        MergeRecords(sources, true, funcObj);
+    }
+
+    /// @brief Returns the current version
+    VersionSharedPtr Snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_version;
+    }
+
+    /// @brief Looks up the newest entry of a key in a version, removed or not
+    bool Find(const Version& version, const Key& key, LsmEntry<Value>& entry) const
+    {
+        if (version.memtable->Get(key, entry))
+        {
+            return true;
+        }
+        for (const auto& immutable : version.immutables)
+        {
+            if (immutable->Get(key, entry))
+            {
+                return true;
+            }
+        }
+        const size_t hash = m_hash(key);
+        RecordType record;
+        for (const auto& level : version.levels)
+        {
+            for (const auto& run : level)
+            {
+                if (run->Get(key, hash, record))
+                {
+                    entry = LsmEntry<Value> { record.value, record.removed };
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// @brief Puts an entry in the memtable and freezes it once full; the caller holds m_lock
+    bool Write(const Key& key, const LsmEntry<Value>& entry)
+    {
+        VersionSharedPtr version = Snapshot();
+        if (!version->memtable->Put(key, entry))
+        {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stats.userBytes += sizeof(Key) + sizeof(Value);
+        if (m_version->memtable->Size() < m_options.memtableKeys)
+        {
+            return !m_failed;
+        }
+        if (m_version->immutables.size() >= m_options.maxImmutables)
+        {
+            ++m_stats.writeStalls;
+            m_done.wait(lock, [this] { return m_failed || m_version->immutables.size() < m_options.maxImmutables; });
+        }
+        auto next = std::make_shared<Version>(*m_version);
+        next->immutables.insert(next->immutables.begin(), next->memtable);
+        next->memtable = m_memtableFactory();
+        m_version = next;
+        m_work.notify_one();
+        return !m_failed;
+    }
+
+    /// @brief Returns whether a worker is merging any level; the caller holds m_mutex
+    bool Busy() const
+    {
+        return std::find(m_busy.begin(), m_busy.end(), true) != m_busy.end();
+    }
+
+    /// @brief Returns the records a level of a Leveled store holds before it is merged into the next
+    size_t GetLevelCapacity(size_t level) const
+    {
+        size_t capacity = m_options.memtableKeys * m_options.level0Runs;
+        for (size_t i = 0; i < level; ++i)
+        {
+            capacity *= m_options.levelRatio;
+        }
+        return capacity;
+    }
+
+    /// @brief Returns whether a level is due to be merged into the next
+    bool NeedsCompaction(const Version& version, size_t level) const
+    {
+        const auto& runs = version.levels[level];
+        if (level == 0 || m_options.compaction == LsmOptions::Tiered)
+        {
+            return runs.size() >= (level == 0 ? m_options.level0Runs : std::max<size_t>(m_options.levelRatio, 2));
+        }
+        size_t records = 0;
+        for (const auto& run : runs)
+        {
+            records += run->GetRecords();
+        }
+        return records > GetLevelCapacity(level);
+    }
+
+    /// @brief Returns whether any level is due to be merged into the next
+    bool NeedsCompaction(const Version& version) const
+    {
+        for (size_t level = 0; level < version.levels.size(); ++level)
+        {
+            if (NeedsCompaction(version, level))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Picks a level due to be merged that no worker is merging; the caller holds m_mutex
+    bool PickCompaction(Compaction& compaction)
+    {
+        const Version& version = *m_version;
+        m_busy.resize(version.levels.size() + 1, false);
+        for (size_t level = 0; level < version.levels.size(); ++level)
+        {
+            if (m_busy[level] || m_busy[level + 1] || !NeedsCompaction(version, level))
+            {
+                continue;
+            }
+            compaction.level = level;
+            compaction.inputs = version.levels[level];
+            compaction.levelInputs = compaction.inputs.size();
+            const bool nextLevel = level + 1 < version.levels.size();
+            if (nextLevel && m_options.compaction == LsmOptions::Leveled)
+            {
+                const auto& next = version.levels[level + 1];
+                compaction.inputs.insert(compaction.inputs.end(), next.begin(), next.end());
+            }
+            // the output is the oldest data left, unless the next level keeps runs of its own
+            compaction.dropRemoved = !nextLevel || m_options.compaction == LsmOptions::Leveled || version.levels[level + 1].empty();
+            for (size_t deeper = level + 2; deeper < version.levels.size(); ++deeper)
+            {
+                compaction.dropRemoved = compaction.dropRemoved && version.levels[deeper].empty();
+            }
+            m_busy[level] = m_busy[level + 1] = true;
+            return true;
+        }
+        return false;
+    }
+
+    /// @brief Returns the path of a new run's file
+    std::string NextRunPath()
+    {
+        return m_options.directory + "/" + std::to_string(m_nextRun++) + ".run";
+    }
+
+    /// @brief Flushes the oldest frozen memtable to level 0; runs on a worker without m_mutex
+    bool Flush(const MemtableSharedPtr& immutable, const std::string& path)
+    {
+        const auto records = Sorted(immutable);
+        typename RunType::Writer writer(path, records.size(), m_options.blockBytes, m_options.bitsPerKey);
+        for (const auto& record : records)
+        {
+            writer.Add(record);
+        }
+        auto run = writer.Finish();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!run)
+        {
+            return false;
+        }
+        auto next = std::make_shared<Version>(*m_version);
+        next->immutables.pop_back();
+        if (next->levels.empty())
+        {
+            next->levels.resize(1);
+        }
+        next->levels[0].insert(next->levels[0].begin(), run);
+        m_version = next;
+        m_stats.flushedBytes += run->GetBytes();
+        return true;
+    }
+
+    /// @brief Merges the runs picked into one run of the next level; runs on a worker without m_mutex
+    bool Compact(const Compaction& compaction, const std::string& path)
+    {
+        std::vector<std::unique_ptr<Source>> sources;
+        size_t records = 0;
+        for (const auto& run : compaction.inputs)
+        {
+            sources.emplace_back(new RunSource(run));
+            records += run->GetRecords();
+        }
+        typename RunType::Writer writer(path, records, m_options.blockBytes, m_options.bitsPerKey);
+        MergeRecords(sources, compaction.dropRemoved, [&writer](const RecordType& record) { writer.Add(record); });
+        sources.clear();
+        auto run = writer.Finish();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy[compaction.level] = m_busy[compaction.level + 1] = false;
+        if (!run)
+        {
+            return false;
+        }
+        auto next = std::make_shared<Version>(*m_version);
+        if (next->levels.size() == compaction.level + 1)
+        {
+            next->levels.resize(compaction.level + 2);
+        }
+        for (size_t i = 0; i < compaction.inputs.size(); ++i)
+        {
+            auto& level = next->levels[compaction.level + (i < compaction.levelInputs ? 0 : 1)];
+            level.erase(std::find(level.begin(), level.end(), compaction.inputs[i]));
+            compaction.inputs[i]->MarkObsolete();
+            m_retiredBlockReads += compaction.inputs[i]->GetBlockReads();
+        }
+        if (run->GetRecords())
+        {
+            auto& level = next->levels[compaction.level + 1];
+            level.insert(level.begin(), run);
+        }
+        else
+        {
+            run->MarkObsolete();
+        }
+        m_version = next;
+        m_stats.compactedBytes += run->GetBytes();
+        return true;
+    }
+
+    /// @brief A worker's loop: flushes frozen memtables first, then merges levels
+    void Work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping)
+        {
+            bool worked = false;
+            Compaction compaction;
+            if (m_failed)
+            {
+                // nothing more is written once a run could not be
+            }
+            else if (!m_flushing && !m_version->immutables.empty())
+            {
+                m_flushing = true;
+                auto immutable = m_version->immutables.back();
+                auto path = NextRunPath();
+                lock.unlock();
+                const bool flushed = Flush(immutable, path);
+                lock.lock();
+                m_flushing = false;
+                m_failed = m_failed || !flushed;
+                worked = true;
+            }
+            else if (PickCompaction(compaction))
+            {
+                auto path = NextRunPath();
+                lock.unlock();
+                const bool compacted = Compact(compaction, path);
+                lock.lock();
+                m_failed = m_failed || !compacted;
+                worked = true;
+            }
+            m_done.notify_all();
+            if (worked)
+            {
+                m_work.notify_all();
+            }
+            else
+            {
+                m_work.wait(lock);
+            }
+        }
+    }
+
+    /// @brief Creates the memtables
+    MemtableFactory m_memtableFactory;
+
+    /// @brief The tunables
+    LsmOptions m_options;
+
+    /// @brief The locking policy, serializing writers
+    LockPolicy m_lock;
+
+    /// @brief Guards m_version and everything the workers share below
+    mutable std::mutex m_mutex;
+
+    /// @brief Wakes the workers up when there is something to flush or merge
+    std::condition_variable m_work;
+
+    /// @brief Wakes up stalled writers and WaitUntilIdle() when a worker finishes something
+    mutable std::condition_variable m_done;
+
+    /// @brief The current memtables and runs
+    VersionSharedPtr m_version;
+
+    /// @brief Whether a worker is merging each level, into or out of it
+    std::vector<bool> m_busy;
+
+    /// @brief Whether a worker is flushing, since memtables are flushed one at a time in order
+    bool m_flushing;
+
+    /// @brief Whether the workers should stop
+    bool m_stopping;
+
+    /// @brief Whether a run could not be written
+    bool m_failed;
+
+    /// @brief Number of the next run's file
+    size_t m_nextRun;
+
+    /// @brief The counters but those kept by the runs
+    LsmStats m_stats;
+
+    /// @brief Blocks read by Get() from runs merged away since
+    size_t m_retiredBlockReads;
+
+    /// @brief The key comparison function object
+    Compare m_compare;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief The workers
+    std::vector<std::thread> m_workers;
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,419 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Mvcc class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store that keeps a short chain of committed versions
+/// per key so that scans read a consistent snapshot without blocking writers
+/// Every Put(), Remove(), Upsert() and Transform() chunk commits at the next
+/// value of a store-wide commit timestamp. Snapshot() returns a ReadView
+/// pinned to the current timestamp: it sees, for every key, the newest
+/// version committed no later than that, with removals kept as tombstones
+/// while a snapshot needs them. Scans walk the keys in order, ScanChunk at a time, copying what they
+/// see and calling the function object with the lock released, so writers
+/// interleave between chunks and a long scan never freezes them.
+/// A key keeps its newest version plus, for each live snapshot, the version
+/// that snapshot sees; the rest are pruned whenever the key is written, and
+/// for every key at once by CollectGarbage().
+/// @note ForEach() scans a snapshot taken when it starts. Transform() commits
+/// one chunk at a time, so it is not atomic as a whole.
+/// @note The store must outlive its read views.
+template <typename Key, typename Value, typename Compare, typename LockPolicy>
+class Mvcc : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief Keys visited per lock acquisition by scans
+    static const size_t ScanChunk = 64;
+
+    /// @brief A consistent, read-only view of the store as of one commit timestamp
+    class ReadView
+    {
+    public:
+
+        /// @brief Releases the snapshot so its versions may be pruned
+        ~ReadView()
+        {
+            m_store.Release(m_timestamp);
+        }
+
+        /// @brief make non-copyable
+        ReadView(const ReadView&) = delete;
+
+        /// @brief make non-assignable
+        ReadView& operator=(const ReadView&) = delete;
+
+        /// @brief The commit timestamp the view sees
+        uint64_t Timestamp() const
+        {
+            return m_timestamp;
+        }
+
+        /// @copydoc TypedKeyValueStore::Get()
+        bool Get(const Key& key, Value& value) const
+        {
+            return m_store.GetAt(key, value, m_timestamp);
+        }
+
+        /// @copydoc TypedKeyValueStore::ForEach()
+        void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+        {
+            m_store.ForEachAt(funcObj, m_timestamp);
+        }
+
+    protected:
+
+        friend class Mvcc;
+
+        /// @brief Constructed by Mvcc::Snapshot() only
+        ReadView(const Mvcc& store, uint64_t timestamp)
+            : m_store(store), m_timestamp(timestamp)
+        {
+
+        }
+
+        /// @brief The store viewed
+        const Mvcc& m_store;
+
+        /// @brief The commit timestamp the view sees
+        const uint64_t m_timestamp;
+    };
+
+    /// @brief Convenient name for a shared pointer to a read view
+    using ReadViewSharedPtr = std::shared_ptr<const ReadView>;
+
+    /// @brief Constructor
+    Mvcc()
+        : m_map(), m_commit(0), m_snapshots(), m_size(0), m_versions(0), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Mvcc()
+    {
+
+    }
+
+    /// @brief Returns a view of every commit made so far, unaffected by later ones
+    ReadViewSharedPtr Snapshot() const
+    {
+        ScopedLock lock(m_lock);
+        m_snapshots.insert(m_commit);
+        return ReadViewSharedPtr(new ReadView(*this, m_commit));
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.lower_bound(key);
+        if (iter == m_map.end() || m_map.key_comp()(key, iter->first))
+        {
+            iter = m_map.emplace_hint(iter, key, Chain());
+        }
+        Write(iter, value);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter == m_map.end() || iter->second.back().removed)
+        {
+            return false;
+        }
+        value = iter->second.back().value;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter == m_map.end() || iter->second.back().removed)
+        {
+            return false;
+        }
+        --m_size;
+        iter->second.push_back(Version{ ++m_commit, true, Value() });
+        ++m_versions;
+        Prune(iter);
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        ScopedLock lock(m_lock);
+        return m_size;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Snapshot()->ForEach(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        Key last = Key();
+        bool started = false;
+        bool done = false;
+        while (!done)
+        {
+            ScopedLock lock(m_lock);
+            uint64_t commit = ++m_commit;
+            auto iter = started ? m_map.upper_bound(last) : m_map.begin();
+            for (size_t visited = 0; iter != m_map.end() && visited < ScanChunk; ++visited)
+            {
+                last = iter->first;
+                if (!iter->second.back().removed)
+                {
+                    Value value = iter->second.back().value;
+                    funcObj(iter->first, value);
+                    iter->second.push_back(Version{ commit, false, value });
+                    ++m_versions;
+                }
+                iter = Prune(iter);
+            }
+            started = true;
+            done = iter == m_map.end();
+        }
+    }
+
+    /// @brief Prunes every version no live snapshot can see
+    /// @note Works ScanChunk keys at a time like the scans
+    void CollectGarbage()
+    {
+        Key last = Key();
+        bool started = false;
+        bool done = false;
+        while (!done)
+        {
+            ScopedLock lock(m_lock);
+            auto iter = started ? m_map.upper_bound(last) : m_map.begin();
+            for (size_t visited = 0; iter != m_map.end() && visited < ScanChunk; ++visited)
+            {
+                last = iter->first;
+                iter = Prune(iter);
+            }
+            started = true;
+            done = iter == m_map.end();
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.lower_bound(key);
+        const bool held = iter != m_map.end() && !m_map.key_comp()(key, iter->first);
+        const bool found = held && !iter->second.back().removed;
+        Value value = found ? iter->second.back().value : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (!held)
+        {
+            iter = m_map.emplace_hint(iter, key, Chain());
+        }
+        Write(iter, value);
+        return true;
+    }
+
+    /// @brief Number of versions kept, including tombstones
+    size_t Versions() const
+    {
+        ScopedLock lock(m_lock);
+        return m_versions;
+    }
+
+protected:
+
+    /// @brief One committed value of a key, or its removal
+    struct Version
+    {
+        uint64_t commit;
+        bool removed;
+        Value value;
+    };
+
+    /// @brief The versions of a key, oldest first and never empty
+    using Chain = std::vector<Version>;
+
+    /// @brief Convenient rename for the underlying container
+    using Map = std::map<Key, Chain, Compare>;
+
+    /// @brief Commits a new version of the key at the provided position
+    /// @note Requires the lock
+    void Write(typename Map::iterator iter, const Value& value)
+    {
+        auto& chain = iter->second;
+        if (chain.empty() || chain.back().removed)
+        {
+            ++m_size;
+        }
+        if (m_snapshots.empty() && !chain.empty())
+        {
+            // no snapshot can see the older versions, so overwrite in place
+            m_versions -= chain.size() - 1;
+            chain.erase(chain.begin(), chain.end() - 1);
+            chain.back() = Version{ ++m_commit, false, value };
+            return;
+        }
+        chain.push_back(Version{ ++m_commit, false, value });
+        ++m_versions;
+        Prune(iter);
+    }
+
+    /// @brief Drops the versions of a key no live snapshot or reader can see,
+    /// and the key itself once only a tombstone would be left
+    /// @return the next key
+    /// @note Requires the lock
+    typename Map::iterator Prune(typename Map::iterator iter)
+    {
+        auto& chain = iter->second;
+        size_t kept = 0;
+        for (size_t index = 0; index + 1 < chain.size(); ++index)
+        {
+            // a snapshot sees this version if it was taken before the next one
+            auto snapshot = m_snapshots.lower_bound(chain[index].commit);
+            if (snapshot != m_snapshots.end() && *snapshot < chain[index + 1].commit)
+            {
+                if (kept != index)
+                {
+                    chain[kept] = chain[index];
+                }
+                ++kept;
+            }
+        }
+        if (kept != chain.size() - 1)
+        {
+            chain[kept] = chain.back();
+        }
+        ++kept;
+        m_versions -= chain.size() - kept;
+        chain.resize(kept);
+        // a lone tombstone reads the same as no key at all, for everyone
+        if (kept == 1 && chain.front().removed)
+        {
+            --m_versions;
+            return m_map.erase(iter);
+        }
+        return ++iter;
+    }
+
+    /// @brief The newest version of a chain committed no later than the provided timestamp
+    /// @return null if there is none or it is a removal
+    static const Version* Visible(const Chain& chain, uint64_t timestamp)
+    {
+        for (auto version = chain.rbegin(); version != chain.rend(); ++version)
+        {
+            if (version->commit <= timestamp)
+            {
+                return version->removed ? nullptr : &*version;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Retrieves a key as of the provided commit timestamp
+    bool GetAt(const Key& key, Value& value, uint64_t timestamp) const
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter == m_map.end())
+        {
+            return false;
+        }
+        auto version = Visible(iter->second, timestamp);
+        if (!version)
+        {
+            return false;
+        }
+        value = version->value;
+        return true;
+    }
+
+    /// @brief Applies the provided function against each key as of the provided
+    /// commit timestamp, holding the lock only while copying a chunk
+    void ForEachAt(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj, uint64_t timestamp) const
+    {
+        std::vector<std::pair<Key, Value>> chunk;
+        chunk.reserve(ScanChunk);
+        Key last = Key();
+        bool started = false;
+        bool done = false;
+        while (!done)
+        {
+            chunk.clear();
+            {
+                ScopedLock lock(m_lock);
+                auto iter = started ? m_map.upper_bound(last) : m_map.begin();
+                for (size_t visited = 0; iter != m_map.end() && visited < ScanChunk; ++visited, ++iter)
+                {
+                    last = iter->first;
+                    auto version = Visible(iter->second, timestamp);
+                    if (version)
+                    {
+                        chunk.emplace_back(iter->first, version->value);
+                    }
+                }
+                started = true;
+                done = iter == m_map.end();
+            }
+            for (const auto& entry : chunk)
+            {
+                funcObj(entry.first, entry.second);
+            }
+        }
+    }
+
+    /// @brief Forgets a snapshot when its read view goes away
+    void Release(uint64_t timestamp) const
+    {
+        ScopedLock lock(m_lock);
+        m_snapshots.erase(m_snapshots.find(timestamp));
+    }
+
+    /// @brief The version chains in key order
+    Map m_map;
+
+    /// @brief The timestamp of the last commit
+    uint64_t m_commit;
+
+    /// @brief The timestamps of the live read views
+    mutable std::multiset<uint64_t> m_snapshots;
+
+    /// @brief The number of keys whose newest version is not a removal
+    size_t m_size;
+
+    /// @brief The number of versions kept
+    size_t m_versions;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,74 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::NoOp class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store that stores nothing and does no work
+/// @note Intended as a calibration baseline for benchmarks: its throughput
+/// is the ceiling imposed by the harness itself rather than by any store.
+template <typename Key, typename Value>
+class NoOp : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Constructor
+    NoOp()
+    {
+
+    }
+
+    /// @brief Destructor
+    ~NoOp()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return 0;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        return true;
+    }
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,279 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::PerfectHash class and Kvs::KeyValueStore::BuildPerfectHash()
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A read-only key->value store over a minimal perfect hash of a known key set
+/// Built once from any other store by BuildPerfectHash(), in the style of
+/// PTHash: keys are hashed into small buckets and each bucket gets a pilot,
+/// found at build time by trial, that sends all of its keys to distinct free
+/// slots. The n entries then sit in a dense array of exactly n slots. A Get
+/// is one hash, one pilot read from a small array, one load of the slot and
+/// one comparison of its key; there is no probing and there are no collisions.
+/// Put(), Remove() and Upsert() fail and Transform() does nothing: build again to change it.
+/// @note Hash must be constructible from a uint64_t seed and spread keys over
+/// all 64 bits, e.g. Hash::Murmur::Hash64A; the build draws a new seed if two
+/// keys hash alike. The full key is kept next to its value since a fingerprint
+/// alone would let some absent keys through. Key must have operator==().
+/// Nothing ever writes after construction, so any number of threads may read
+/// concurrently without locking.
+template <typename Key, typename Value, typename Hash>
+class PerfectHash : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Constructor, copies every key->value pair of the provided store
+    /// @note The provided store is only read, through ForEach()
+    explicit PerfectHash(const TypedKeyValueStore<Key, Value>& source)
+        : m_slots(), m_pilots(), m_remap(), m_hash(), m_tableSize(0)
+    {
+        std::vector<Slot> entries;
+        entries.reserve(source.Size());
+        source.ForEach([&entries] (const Key& key, const Value& value) {
+            entries.push_back(Slot { key, value });
+        });
+        uint64_t seed = 0;
+        while (!Build(entries, seed))
+        {
+            ++seed;
+        }
+    }
+
+    /// @brief Destructor
+    ~PerfectHash()
+    {
+
+    }
+
+    /// @brief Fails, the key set is fixed
+    bool Put(const Key& key, const Value& value)
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        if (m_slots.empty())
+        {
+            return false;
+        }
+        const Slot& slot = m_slots[Position(m_hash(key))];
+        if (!(slot.key == key))
+        {
+            return false;
+        }
+        value = slot.value;
+        return true;
+    }
+
+    /// @brief Fails, the key set is fixed
+    bool Remove(const Key& key)
+    {
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_slots.size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        for (const auto& slot : m_slots)
+        {
+            funcObj(slot.key, slot.value);
+        }
+    }
+
+    /// @brief Does nothing, a perfect hash store cannot change
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+
+    }
+
+    /// @brief Fails, the key set is fixed
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        return false;
+    }
+
+protected:
+
+    /// @brief A key and its value
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+    /// @brief Keys per bucket on average
+    /// Smaller buckets need more pilots, bigger ones take longer to place.
+    static const size_t BucketSize = 4;
+
+    /// @brief Slots the pilots search in per key, a little over one
+    /// The last buckets are placed while most slots are taken, and a few
+    /// spare slots spare them a long search. Keys placed in a spare slot are
+    /// remapped to one of the slots the spares left empty, keeping it minimal.
+    static constexpr double SpareSlots = 1.01;
+
+    /// @brief Scrambles all bits of the provided value into all others, one to one
+    static uint64_t Mix(uint64_t value)
+    {
+        // the splitmix64 finalizer
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    /// @brief The bucket of a hash
+    size_t Bucket(uint64_t hash) const
+    {
+        // the high half of the hash, whereas Displace() mixes all of it
+        return (hash >> 32) % m_pilots.size();
+    }
+
+    /// @brief The slot a hash lands in among the m_tableSize the pilots search in
+    static size_t Displace(uint64_t hash, uint32_t pilot, size_t tableSize)
+    {
+        // mixed after the pilot is applied, or keys whose hashes agree in the
+        // bits the modulo keeps would share a slot whatever the pilot
+        return Mix(hash ^ pilot) % tableSize;
+    }
+
+    /// @brief The slot of a key with the provided hash, if it is a key of the store
+    size_t Position(uint64_t hash) const
+    {
+        size_t position = Displace(hash, m_pilots[Bucket(hash)], m_tableSize);
+        if (position >= m_slots.size())
+        {
+            position = m_remap[position - m_slots.size()];
+        }
+        return position;
+    }
+
+    /// @brief Finds a pilot for each bucket and places the entries in their slots
+    /// @return false if two keys hash alike, so the seed needs changing
+    bool Build(const std::vector<Slot>& entries, uint64_t seed)
+    {
+        const size_t count = entries.size();
+        m_hash = Hash(seed);
+        m_tableSize = std::max(count, static_cast<size_t>(count * SpareSlots));
+        m_pilots.assign(count / BucketSize + 1, 0);
+        std::vector<uint64_t> hashes(count);
+        std::vector<std::vector<size_t>> buckets(m_pilots.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            hashes[i] = m_hash(entries[i].key);
+            buckets[Bucket(hashes[i])].push_back(i);
+        }
+        // the biggest buckets are the hardest to place, so place them while most slots are free
+        std::vector<size_t> order(buckets.size());
+        for (size_t bucket = 0; bucket < order.size(); ++bucket)
+        {
+            order[bucket] = bucket;
+        }
+        std::stable_sort(order.begin(), order.end(), [&buckets] (size_t lhs, size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+        std::vector<bool> taken(m_tableSize, false);
+        std::vector<size_t> positions;
+        for (size_t bucket : order)
+        {
+            const auto& members = buckets[bucket];
+            if (members.empty())
+            {
+                break;
+            }
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                for (size_t j = 0; j < i; ++j)
+                {
+                    if (hashes[members[i]] == hashes[members[j]])
+                    {
+                        // no pilot can tell these apart
+                        return false;
+                    }
+                }
+            }
+            for (uint32_t pilot = 0; ; ++pilot)
+            {
+                positions.clear();
+                for (size_t member : members)
+                {
+                    size_t position = Displace(hashes[member], pilot, m_tableSize);
+                    if (taken[position] || std::find(positions.begin(), positions.end(), position) != positions.end())
+                    {
+                        break;
+                    }
+                    positions.push_back(position);
+                }
+                if (positions.size() == members.size())
+                {
+                    m_pilots[bucket] = pilot;
+                    for (size_t position : positions)
+                    {
+                        taken[position] = true;
+                    }
+                    break;
+                }
+            }
+        }
+        // every spare slot in use stands for one of the empty slots below count
+        m_remap.assign(m_tableSize - count, 0);
+        size_t empty = 0;
+        for (size_t spare = count; spare < m_tableSize; ++spare)
+        {
+            if (taken[spare])
+            {
+                while (taken[empty])
+                {
+                    ++empty;
+                }
+                m_remap[spare - count] = empty++;
+            }
+        }
+        m_slots.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_slots[Position(hashes[i])] = entries[i];
+        }
+        return true;
+    }
+
+    /// @brief The entries, one per slot
+    std::vector<Slot> m_slots;
+
+    /// @brief The pilot of each bucket
+    std::vector<uint32_t> m_pilots;
+
+    /// @brief The slot standing in for each spare slot, by spare slot
+    std::vector<uint32_t> m_remap;
+
+    /// @brief The hash function object, seeded by the build
+    Hash m_hash;
+
+    /// @brief The slots the pilots search in, spares included
+    size_t m_tableSize;
+};
+
+/// @brief Builds a read-only perfect hash copy of the provided store, e.g. BuildPerfectHash<Hash::Murmur::Hash64A<Schema::KeyType>>(store)
+/// @note The provided store is unchanged and may go on being used
+template <typename Hash, typename Key, typename Value>
+std::shared_ptr<PerfectHash<Key, Value, Hash>> BuildPerfectHash(const TypedKeyValueStore<Key, Value>& store)
+{
+    return std::make_shared<PerfectHash<Key, Value, Hash>>(store);
+}
+
+} } // namespace Kvs::KeyValueStore
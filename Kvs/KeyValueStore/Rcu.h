@@ -0,0 +1,160 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Rcu class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include "../Reclaim/Epoch.h"
+#include <atomic>
+#include <functional>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store for read-mostly tables that copies the whole
+/// underlying store on every update (read-copy-update)
+/// Readers load an atomic pointer to the current, immutable version and read
+/// it inside a Reclaim::Epoch guard, which writes only the calling thread's
+/// own epoch record: no lock, no shared counter. Writers clone the current
+/// version, apply their changes to the clone, publish it and retire the old
+/// version to the epoch. Update() applies a batch of changes for the price
+/// of one copy; Put(), Remove(), Upsert() and Transform() are each a batch of one.
+/// Writers are serialized by the locking policy, which readers never touch.
+/// @note Store must be a default-constructible TypedKeyValueStore<Key, Value>
+/// whose const methods are safe to call concurrently, e.g. StdUnorderedMap
+/// with Lock::None. Stores are non-copyable, so a clone is a new Store filled
+/// through the interface. Every update costs a copy of the whole store, so this is
+/// only worth it when reads outnumber updates by orders of magnitude.
+template <typename Key, typename Value, typename Store, typename LockPolicy>
+class Rcu : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief Function object type used to apply a batch of changes to a new version
+    using FuncObjUpdate = std::function<void(Store&)>;
+
+    /// @brief Constructor
+    Rcu()
+        : m_current(new Store()), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    /// @note Versions retired earlier are freed by the epoch, not here
+    ~Rcu()
+    {
+        delete m_current.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Applies a batch of changes to a copy of the store and publishes it
+    /// @note Readers see either none or all of the batch
+    void Update(const FuncObjUpdate& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto current = m_current.load(std::memory_order_relaxed);
+        auto next = Clone(*current);
+        funcObj(*next);
+        m_current.store(next, std::memory_order_release);
+        Reclaim::Epoch::Retire(current);
+        // updates are rare, so try to free old versions now rather than per batch
+        Reclaim::Epoch::Collect();
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        bool result = false;
+        Update([&] (Store& store) { result = store.Put(key, value); });
+        return result;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        Reclaim::Epoch::Guard guard;
+        return m_current.load(std::memory_order_acquire)->Get(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    /// @note Only copies the store if the key is present
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        auto current = m_current.load(std::memory_order_relaxed);
+        Value value;
+        if (!current->Get(key, value))
+        {
+            return false;
+        }
+        auto next = Clone(*current);
+        next->Remove(key);
+        m_current.store(next, std::memory_order_release);
+        Reclaim::Epoch::Retire(current);
+        Reclaim::Epoch::Collect();
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        Reclaim::Epoch::Guard guard;
+        return m_current.load(std::memory_order_acquire)->Size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    /// @note Iterates one consistent version, however long it takes
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Reclaim::Epoch::Guard guard;
+        m_current.load(std::memory_order_acquire)->ForEach(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        Update([&] (Store& store) { store.Transform(funcObj); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note Only copies the store if the value is to be stored
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto current = m_current.load(std::memory_order_relaxed);
+        Value value = Value();
+        const bool found = current->Get(key, value);
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        auto next = Clone(*current);
+        next->Put(key, value);
+        m_current.store(next, std::memory_order_release);
+        Reclaim::Epoch::Retire(current);
+        Reclaim::Epoch::Collect();
+        return true;
+    }
+
+protected:
+
+    /// @brief Returns a new store holding every key->value pair of the provided one
+    static Store* Clone(const Store& store)
+    {
+        auto clone = new Store();
+        store.ForEach([clone] (const Key& key, const Value& value) { clone->Put(key, value); });
+        return clone;
+    }
+
+    /// @brief The current version, never modified once published
+    std::atomic<Store*> m_current;
+
+    /// @brief The locking policy, serializing writers only
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
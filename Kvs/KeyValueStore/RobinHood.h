@@ -0,0 +1,300 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::RobinHood class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Lock/Scoped.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A key->value store using an open-addressing hash table with Robin Hood hashing
+/// Keys probe linearly from their home slot, and a key that has probed
+/// further than the one in its way takes that slot and moves the other one
+/// on, which keeps every key close to home and sorted by home within a run.
+/// A Get() gives up as soon as it meets a key closer to home than it is.
+/// Remove() shifts the rest of the run back by one slot instead of leaving a
+/// tombstone, so probes stay as short after any amount of Put()/Remove()
+/// churn as in a table freshly filled to the same size.
+/// The probe length of every slot is kept in a separate byte array, zero
+/// for empty, and keys are only compared in slots whose probe length matches.
+/// @note Key must have operator==().
+template <typename Key, typename Value, typename Hash, typename LockPolicy>
+class RobinHood : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for a scoped lock
+    using ScopedLock = typename Lock::Scoped<LockPolicy>;
+
+    /// @brief Number of slots of an empty table
+    static const size_t InitialCapacity = 16;
+
+    /// @brief Largest fraction of the slots in use before the table grows
+    static constexpr double MaxLoadFactor = 0.875;
+
+    /// @brief Constructor
+    RobinHood()
+        : m_probes(InitialCapacity, 0), m_slots(InitialCapacity), m_mask(InitialCapacity - 1), m_size(0), m_hash(), m_lock()
+    {
+
+    }
+
+    /// @brief Destructor
+    ~RobinHood()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        size_t index;
+        if (Find(key, hash, index))
+        {
+            m_slots[index].value = value;
+            return true;
+        }
+        if (m_size + 1 > Capacity() * MaxLoadFactor)
+        {
+            Grow();
+        }
+        Insert(Slot { key, value }, hash);
+        ++m_size;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        ScopedLock lock(m_lock);
+        size_t index;
+        if (Find(key, m_hash(key), index))
+        {
+            value = m_slots[index].value;
+            return true;
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        ScopedLock lock(m_lock);
+        size_t index;
+        if (!Find(key, m_hash(key), index))
+        {
+            return false;
+        }
+        // shift the rest of the run back, each key one slot closer to home
+        size_t next = (index + 1) & m_mask;
+        while (m_probes[next] > 1)
+        {
+            m_probes[index] = m_probes[next] - 1;
+            m_slots[index] = std::move(m_slots[next]);
+            index = next;
+            next = (next + 1) & m_mask;
+        }
+        m_probes[index] = 0;
+        --m_size;
+        return true;
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        ScopedLock lock(m_lock);
+        return m_size;
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        ScopedLock lock(m_lock);
+        for (size_t index = 0; index < m_slots.size(); ++index)
+        {
+            if (m_probes[index])
+            {
+                funcObj(m_slots[index].key, m_slots[index].value);
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        for (size_t index = 0; index < m_slots.size(); ++index)
+        {
+            if (m_probes[index])
+            {
+                funcObj(m_slots[index].key, m_slots[index].value);
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        const size_t hash = m_hash(key);
+        size_t index;
+        const bool found = Find(key, hash, index);
+        Value value = found ? m_slots[index].value : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            m_slots[index].value = value;
+            return true;
+        }
+        if (m_size + 1 > Capacity() * MaxLoadFactor)
+        {
+            Grow();
+        }
+        Insert(Slot { key, value }, hash);
+        ++m_size;
+        return true;
+    }
+
+    /// @brief Returns the number of keys found at each distance from their home slot
+    /// @note Element d counts the keys a Get() finds after d other slots
+    std::vector<size_t> GetProbeLengths() const
+    {
+        ScopedLock lock(m_lock);
+        std::vector<size_t> lengths;
+        for (uint8_t probe : m_probes)
+        {
+            if (probe)
+            {
+                if (lengths.size() < probe)
+                {
+                    lengths.resize(probe, 0);
+                }
+                ++lengths[probe - 1];
+            }
+        }
+        return lengths;
+    }
+
+    /// @brief Returns the number of slots
+    size_t GetCapacity() const
+    {
+        ScopedLock lock(m_lock);
+        return Capacity();
+    }
+
+protected:
+
+    /// @brief A key and its value
+    struct Slot
+    {
+        Key key;
+        Value value;
+    };
+
+    /// @brief Longest probe kept, one less than the most a byte holds
+    static const uint8_t MaxProbe = UINT8_MAX - 1;
+
+    /// @brief The number of slots
+    size_t Capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /// @brief Finds the slot holding the provided key
+    /// @return false if the key is absent
+    bool Find(const Key& key, size_t hash, size_t& index) const
+    {
+        index = hash & m_mask;
+        for (uint8_t probe = 1; ; ++probe)
+        {
+            if (m_probes[index] < probe)
+            {
+                // empty, or a key closer to home: this one would have taken its slot
+                return false;
+            }
+            if (m_probes[index] == probe && m_slots[index].key == key)
+            {
+                return true;
+            }
+            index = (index + 1) & m_mask;
+        }
+    }
+
+    /// @brief Places a key that is not in the table yet, growing it if its probe gets too long
+    void Insert(Slot slot, size_t hash)
+    {
+        size_t index = hash & m_mask;
+        uint8_t probe = 1;
+        for (;;)
+        {
+            if (m_probes[index] == 0)
+            {
+                m_probes[index] = probe;
+                m_slots[index] = std::move(slot);
+                return;
+            }
+            if (m_probes[index] < probe)
+            {
+                // take from the rich: the key closer to home moves on instead
+                std::swap(m_probes[index], probe);
+                std::swap(m_slots[index], slot);
+            }
+            index = (index + 1) & m_mask;
+            if (++probe > MaxProbe)
+            {
+                Grow();
+                const size_t rehash = m_hash(slot.key);
+                Insert(std::move(slot), rehash);
+                return;
+            }
+        }
+    }
+
+    /// @brief Doubles the number of slots and places every key again
+    void Grow()
+    {
+        std::vector<uint8_t> probes(Capacity() * 2, 0);
+        std::vector<Slot> slots(Capacity() * 2);
+        m_probes.swap(probes);
+        m_slots.swap(slots);
+        m_mask = m_mask * 2 + 1;
+        for (size_t index = 0; index < slots.size(); ++index)
+        {
+            if (probes[index])
+            {
+                const size_t hash = m_hash(slots[index].key);
+                Insert(std::move(slots[index]), hash);
+            }
+        }
+    }
+
+    /// @brief The probe length of the key in each slot, counting its home slot as one, or zero if empty
+    std::vector<uint8_t> m_probes;
+
+    /// @brief The keys and values
+    std::vector<Slot> m_slots;
+
+    /// @brief Selects a slot from a hash, one less than the power of two number of slots
+    size_t m_mask;
+
+    /// @brief Number of keys stored
+    size_t m_size;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief The locking policy
+    LockPolicy m_lock;
+
+};
+
+} } // namespace Kvs::KeyValueStore
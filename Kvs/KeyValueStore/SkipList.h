@@ -0,0 +1,429 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::SkipList class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Reclaim/Epoch.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief An ordered key->value store using a lazy skip list
+/// Writers lock only the few nodes around the key they change, with one
+/// LockPolicy per node, so writes to different parts of the list proceed
+/// in parallel. Get() takes no lock and never retries: it walks the list
+/// inside a Reclaim::Epoch guard and trusts a node once it is fully linked
+/// and not marked for removal. Values are immutable and swapped by pointer,
+/// so Put() and Upsert() of an existing key lock nothing either. Removed
+/// nodes and replaced values are retired to the epoch. ForEach() visits keys
+/// in Compare order.
+/// @note Follows Herlihy, Lev, Luchangco and Shavit, "A Simple Optimistic
+/// Skiplist Algorithm". ForEach() and Transform() are not snapshots.
+template <typename Key, typename Value, typename Compare, typename LockPolicy>
+class SkipList : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief The most levels a node can have, enough for tens of millions of keys
+    static const int MaxLevel = 16;
+
+    /// @brief Constructor
+    SkipList()
+        : m_head(Node::Create(Key(), nullptr, MaxLevel - 1)), m_level(0), m_size(0), m_compare()
+    {
+        m_head->fullyLinked.store(true, std::memory_order_relaxed);
+    }
+
+    /// @brief Destructor
+    /// @note Nodes retired earlier are freed by the epoch, not here
+    ~SkipList()
+    {
+        auto node = m_head;
+        while (node)
+        {
+            auto next = node->next[0].load(std::memory_order_relaxed);
+            Node::Destroy(node);
+            node = next;
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        Reclaim::Epoch::Guard guard;
+        int topLevel = RandomLevel();
+        Node* preds[MaxLevel];
+        Node* succs[MaxLevel];
+        while (true)
+        {
+            int found = Find(key, preds, succs);
+            if (found != -1)
+            {
+                auto node = succs[found];
+                if (!node->marked.load(std::memory_order_acquire))
+                {
+                    while (!node->fullyLinked.load(std::memory_order_acquire))
+                        ; // another writer is still linking it
+                    Reclaim::Epoch::Retire(node->value.exchange(new Value(value), std::memory_order_acq_rel));
+                    return true;
+                }
+                continue; // being removed, so try again once it is gone
+            }
+            if (Link(key, value, topLevel, preds, succs))
+            {
+                return true;
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        Reclaim::Epoch::Guard guard;
+        auto pred = m_head;
+        for (int level = m_level.load(std::memory_order_acquire); level >= 0; --level)
+        {
+            auto curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr && m_compare(curr->key, key))
+            {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+            if (curr && !m_compare(key, curr->key))
+            {
+                if (!curr->fullyLinked.load(std::memory_order_acquire)
+                    || curr->marked.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+                value = *curr->value.load(std::memory_order_acquire);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        Reclaim::Epoch::Guard guard;
+        Node* preds[MaxLevel];
+        Node* succs[MaxLevel];
+        Node* victim = nullptr;
+        while (true)
+        {
+            int found = Find(key, preds, succs);
+            if (!victim)
+            {
+                if (found == -1)
+                {
+                    return false;
+                }
+                auto node = succs[found];
+                if (!node->fullyLinked.load(std::memory_order_acquire)
+                    || node->topLevel != found
+                    || node->marked.load(std::memory_order_acquire))
+                {
+                    // not yet linked at every level, or already being removed
+                    return false;
+                }
+                node->lock.Lock();
+                if (node->marked.load(std::memory_order_relaxed))
+                {
+                    node->lock.Unlock();
+                    return false;
+                }
+                node->marked.store(true, std::memory_order_release);
+                victim = node;
+            }
+            int highestLocked = -1;
+            bool valid = true;
+            for (int level = 0; valid && level <= victim->topLevel; ++level)
+            {
+                if (level == 0 || preds[level] != preds[level - 1])
+                {
+                    preds[level]->lock.Lock();
+                    highestLocked = level;
+                }
+                valid = !preds[level]->marked.load(std::memory_order_acquire)
+                     && preds[level]->next[level].load(std::memory_order_acquire) == victim;
+            }
+            if (valid)
+            {
+                for (int level = victim->topLevel; level >= 0; --level)
+                {
+                    preds[level]->next[level].store(victim->next[level].load(std::memory_order_relaxed),
+                                                    std::memory_order_release);
+                }
+                victim->lock.Unlock();
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+            }
+            Unlock(preds, highestLocked);
+            if (valid)
+            {
+                Reclaim::Epoch::Retire(victim, &Node::Destroy);
+                return true;
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Reclaim::Epoch::Guard guard;
+        for (auto node = m_head->next[0].load(std::memory_order_acquire); node;
+             node = node->next[0].load(std::memory_order_acquire))
+        {
+            if (node->fullyLinked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire))
+            {
+                funcObj(node->key, *node->value.load(std::memory_order_acquire));
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        Reclaim::Epoch::Guard guard;
+        for (auto node = m_head->next[0].load(std::memory_order_acquire); node;
+             node = node->next[0].load(std::memory_order_acquire))
+        {
+            if (node->fullyLinked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire))
+            {
+                auto value = new Value(*node->value.load(std::memory_order_acquire));
+                funcObj(node->key, *value);
+                Reclaim::Epoch::Retire(node->value.exchange(value, std::memory_order_acq_rel));
+            }
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    /// @note The value of a key held is swapped by compare-and-swap, so the
+    /// function is called again if another writer swapped it first. As with
+    /// Put(), a swap racing with the Remove() of its key is lost with the key.
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        Reclaim::Epoch::Guard guard;
+        int topLevel = RandomLevel();
+        Node* preds[MaxLevel];
+        Node* succs[MaxLevel];
+        while (true)
+        {
+            int found = Find(key, preds, succs);
+            if (found != -1)
+            {
+                auto node = succs[found];
+                if (node->marked.load(std::memory_order_acquire))
+                {
+                    continue; // being removed, so try again once it is gone
+                }
+                while (!node->fullyLinked.load(std::memory_order_acquire))
+                    ; // another writer is still linking it
+                auto current = node->value.load(std::memory_order_acquire);
+                while (true)
+                {
+                    // the epoch keeps current from being freed, and so reused, while it is compared
+                    std::unique_ptr<Value> value(new Value(*current));
+                    if (!funcObj(*value, true))
+                    {
+                        return false;
+                    }
+                    if (node->value.compare_exchange_weak(current, value.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        value.release();
+                        Reclaim::Epoch::Retire(current);
+                        return true;
+                    }
+                }
+            }
+            Value value = Value();
+            if (!funcObj(value, false))
+            {
+                return false;
+            }
+            if (Link(key, value, topLevel, preds, succs))
+            {
+                return true;
+            }
+        }
+    }
+
+protected:
+
+    /// @brief A key with its links, one per level up to its top level
+    /// @note The links are allocated inline past the end of the node, so a
+    /// search touches one allocation per hop rather than two
+    struct Node
+    {
+        /// @brief Allocates a node with room for its links
+        static Node* Create(const Key& key, Value* value, int topLevel)
+        {
+            auto memory = ::operator new(sizeof(Node) + topLevel * sizeof(std::atomic<Node*>));
+            auto node = new (memory) Node(key, value, topLevel);
+            for (int level = 1; level <= topLevel; ++level)
+            {
+                new (&node->next[level]) std::atomic<Node*>(nullptr);
+            }
+            return node;
+        }
+
+        /// @brief Frees a node made by Create(), usable as an epoch deleter
+        static void Destroy(void* object)
+        {
+            auto node = static_cast<Node*>(object);
+            node->~Node();
+            ::operator delete(object);
+        }
+
+        Node(const Key& key_, Value* value_, int topLevel_)
+            : key(key_), value(value_), topLevel(topLevel_), marked(false), fullyLinked(false), lock()
+        {
+            next[0].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~Node()
+        {
+            delete value.load(std::memory_order_relaxed);
+        }
+
+        const Key key;
+        std::atomic<Value*> value;
+        const int topLevel;
+        std::atomic<bool> marked;
+        std::atomic<bool> fullyLinked;
+        LockPolicy lock;
+        std::atomic<Node*> next[1];
+    };
+
+    /// @brief Fills in the predecessor and successor of the key at every level
+    /// @return the highest level the key was found at, or -1
+    int Find(const Key& key, Node** preds, Node** succs) const
+    {
+        int found = -1;
+        auto pred = m_head;
+        int top = m_level.load(std::memory_order_acquire);
+        for (int level = MaxLevel - 1; level > top; --level)
+        {
+            preds[level] = m_head;
+            succs[level] = nullptr;
+        }
+        for (int level = top; level >= 0; --level)
+        {
+            auto curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr && m_compare(curr->key, key))
+            {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+            if (found == -1 && curr && !m_compare(key, curr->key))
+            {
+                found = level;
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return found;
+    }
+
+    /// @brief Links a new node for a key between the predecessors and successors Find() filled in
+    /// @return false if they changed since, so the caller must search again
+    bool Link(const Key& key, const Value& value, int topLevel, Node** preds, Node** succs)
+    {
+        int highestLocked = -1;
+        bool valid = true;
+        for (int level = 0; valid && level <= topLevel; ++level)
+        {
+            if (level == 0 || preds[level] != preds[level - 1])
+            {
+                preds[level]->lock.Lock();
+                highestLocked = level;
+            }
+            auto succ = succs[level];
+            valid = !preds[level]->marked.load(std::memory_order_acquire)
+                 && (!succ || !succ->marked.load(std::memory_order_acquire))
+                 && preds[level]->next[level].load(std::memory_order_acquire) == succ;
+        }
+        if (valid)
+        {
+            auto node = Node::Create(key, new Value(value), topLevel);
+            for (int level = 0; level <= topLevel; ++level)
+            {
+                node->next[level].store(succs[level], std::memory_order_relaxed);
+            }
+            for (int level = 0; level <= topLevel; ++level)
+            {
+                preds[level]->next[level].store(node, std::memory_order_release);
+            }
+            node->fullyLinked.store(true, std::memory_order_release);
+            RaiseLevel(topLevel);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        Unlock(preds, highestLocked);
+        return valid;
+    }
+
+    /// @brief Releases the predecessors locked up to the provided level, each once
+    static void Unlock(Node** preds, int highestLocked)
+    {
+        for (int level = 0; level <= highestLocked; ++level)
+        {
+            if (level == 0 || preds[level] != preds[level - 1])
+            {
+                preds[level]->lock.Unlock();
+            }
+        }
+    }
+
+    /// @brief Lets searches start at the provided level from now on
+    void RaiseLevel(int level)
+    {
+        int current = m_level.load(std::memory_order_relaxed);
+        while (current < level && !m_level.compare_exchange_weak(current, level, std::memory_order_release))
+            ;
+    }
+
+    /// @brief Picks the top level of a new node: each level is a quarter as likely as the one below
+    static int RandomLevel()
+    {
+        static thread_local uint64_t state = 0;
+        if (!state)
+        {
+            state = reinterpret_cast<uintptr_t>(&state) | 1;
+        }
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int level = 0;
+        for (uint64_t bits = state; (bits & 3) == 0 && level < MaxLevel - 1; bits >>= 2)
+        {
+            ++level;
+        }
+        return level;
+    }
+
+    /// @brief The sentinel before the first key, linked at every level
+    Node* m_head;
+
+    /// @brief The highest level any node has reached, where searches start
+    std::atomic<int> m_level;
+
+    /// @brief The number of keys
+    std::atomic<size_t> m_size;
+
+    /// @brief The key ordering
+    Compare m_compare;
+
+};
+
+} } // namespace Kvs::KeyValueStore
@@ -0,0 +1,305 @@
+/// @file
+/// @brief Defines and implements the Kvs::KeyValueStore::Statistics class
+
+#pragma once
+
+#include "../TypedKeyValueStore.h"
+#include "../Log2Histogram.h"
+#include "Compound.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Kvs { namespace KeyValueStore {
+
+/// @brief A snapshot of the operations seen by a Statistics decorated key->value store
+struct OperationStats
+{
+    /// @brief The operations counted
+    enum Operation
+    {
+        Put,
+        Get,
+        Remove,
+        Size,
+        ForEach,
+        Transform,
+        Upsert,
+        OperationCount      ///< not an operation, the number of operations
+    };
+
+    /// @brief Only Put, Get and Remove have their latency sampled
+    static const size_t TimedOperationCount = Remove + 1;
+
+    /// @brief Returns a printable name for the provided operation
+    static const char* Name(size_t operation)
+    {
+        static const char* names[OperationCount] =
+            { "Put", "Get", "Remove", "Size", "ForEach", "Transform", "Upsert" };
+        return operation < OperationCount ? names[operation] : "unknown";
+    }
+
+    /// @brief Calls made per operation
+    std::array<uint64_t, OperationCount> calls;
+
+    /// @brief Calls that returned true: Put stored, Get found, Remove found, Upsert stored
+    std::array<uint64_t, OperationCount> successes;
+
+    /// @brief Sampled latency histogram per timed operation
+    std::array<Log2Histogram, TimedOperationCount> latency;
+
+    /// @brief Fraction of Get calls that found their key
+    double GetHitRatio() const
+    {
+        return calls[Get] ? static_cast<double>(successes[Get]) / calls[Get] : 0.0;
+    }
+
+    /// @brief Put, Get, Remove and Upsert calls together
+    uint64_t Accesses() const
+    {
+        return calls[Put] + calls[Get] + calls[Remove] + calls[Upsert];
+    }
+};
+
+/// @brief A key->value store decorator that counts the operations passed to another store
+/// Counters are kept in cache-line sized shards, one per thread, so the hot path
+/// only ever touches a line no other thread writes: increments are a relaxed load
+/// and store rather than a contended atomic read-modify-write. One call in
+/// LatencySampleInterval per shard and operation is timed into a Log2Histogram.
+/// GetStats() sums the shards without stopping anyone.
+/// @note Threads are spread over the shards round-robin as they first touch any
+/// Statistics store; counts may only be lost if more threads than shards use the
+/// same store at once.
+/// @note Adds no locking of its own: thread-safety is that of the decorated store.
+template <typename Key, typename Value>
+class Statistics : public TypedKeyValueStore<Key, Value>
+{
+public:
+
+    /// @brief Convenient rename for the decorated key->value store
+    using KeyValueStoreSharedPtr = typename TypedKeyValueStore<Key, Value>::SharedPtr;
+
+    /// @brief Default number of counter shards
+    static const size_t DefaultShards = 16;
+
+    /// @brief One call in this many has its latency measured
+    /// @note Must be a power of two; sampling keeps clock reads off most calls
+    static const uint64_t LatencySampleInterval = 64;
+
+    /// @brief Constructor
+    /// @param shards number of counter shards, rounded up to a power of two; one
+    /// suffices when callers are already serialized, e.g. the back-ends of a locked Compound store
+    Statistics(KeyValueStoreSharedPtr keyValueStore, size_t shards = DefaultShards)
+        : m_keyValueStore(keyValueStore)
+        , m_shards(RoundUpToPowerOfTwo(shards))
+        , m_shardMask(m_shards.size() - 1)
+    {
+
+    }
+
+    /// @brief Destructor
+    ~Statistics()
+    {
+
+    }
+
+    /// @copydoc TypedKeyValueStore::Put()
+    bool Put(const Key& key, const Value& value)
+    {
+        return Record(OperationStats::Put, [&] { return m_keyValueStore->Put(key, value); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        return Record(OperationStats::Put, [&] { return m_keyValueStore->Put(std::move(key), std::move(value)); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Get()
+    bool Get(const Key& key, Value& value) const
+    {
+        return Record(OperationStats::Get, [&] { return m_keyValueStore->Get(key, value); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Remove()
+    bool Remove(const Key& key)
+    {
+        return Record(OperationStats::Remove, [&] { return m_keyValueStore->Remove(key); });
+    }
+
+    /// @copydoc TypedKeyValueStore::Size()
+    size_t Size() const
+    {
+        Record(OperationStats::Size, [] { return true; });
+        return m_keyValueStore->Size();
+    }
+
+    /// @copydoc TypedKeyValueStore::ForEach()
+    void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
+    {
+        Record(OperationStats::ForEach, [] { return true; });
+        m_keyValueStore->ForEach(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Transform()
+    void Transform(const typename TypedKeyValueStore<Key,Value>::FuncObjReadKeyWriteValue& funcObj)
+    {
+        Record(OperationStats::Transform, [] { return true; });
+        m_keyValueStore->Transform(funcObj);
+    }
+
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        return Record(OperationStats::Upsert, [&] { return m_keyValueStore->Upsert(key, funcObj); });
+    }
+
+    /// @brief Returns the counters summed over every shard
+    /// @note Shards are read while they may be updated, so the snapshot is
+    /// consistent per counter but not across counters
+    OperationStats GetStats() const
+    {
+        OperationStats stats = OperationStats();
+        for (const auto& shard : m_shards)
+        {
+            for (size_t op = 0; op < OperationStats::OperationCount; ++op)
+            {
+                stats.calls[op] += shard.calls[op].load(std::memory_order_relaxed);
+                stats.successes[op] += shard.successes[op].load(std::memory_order_relaxed);
+            }
+            for (size_t op = 0; op < OperationStats::TimedOperationCount; ++op)
+            {
+                for (size_t bucket = 0; bucket < Log2Histogram::BucketCount; ++bucket)
+                {
+                    stats.latency[op].Add(bucket, shard.latency[op][bucket].load(std::memory_order_relaxed));
+                }
+            }
+        }
+        return stats;
+    }
+
+    /// @brief Returns the decorated key->value store
+    KeyValueStoreSharedPtr GetKeyValueStore() const
+    {
+        return m_keyValueStore;
+    }
+
+protected:
+
+    /// @brief The counters of the threads sharing one shard, kept to their own cache lines
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, OperationStats::OperationCount> calls;
+        std::array<std::atomic<uint64_t>, OperationStats::OperationCount> successes;
+        std::array<std::array<std::atomic<uint64_t>, Log2Histogram::BucketCount>,
+                   OperationStats::TimedOperationCount> latency;
+    };
+
+    /// @brief Adds one to a counter only the calling thread is expected to write
+    static void Increment(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the calling thread's index, handed out round-robin on first use
+    /// @note The thread_local is constant-initialized so reading it needs no guard
+    static size_t ThreadIndex()
+    {
+        static std::atomic<size_t> nextIndex(0);
+        static thread_local size_t index = ~size_t(0);
+        if (index == ~size_t(0))
+        {
+            index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        }
+        return index;
+    }
+
+    /// @brief Returns the smallest power of two not less than the provided count
+    static size_t RoundUpToPowerOfTwo(size_t count)
+    {
+        size_t power = 1;
+        while (power < count)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    /// @brief Counts one call of the provided operation, timing it if it is sampled
+    template <typename Operation>
+    bool Record(OperationStats::Operation op, Operation operation) const
+    {
+        Shard& shard = m_shards[ThreadIndex() & m_shardMask];
+        uint64_t calls = shard.calls[op].load(std::memory_order_relaxed);
+        shard.calls[op].store(calls + 1, std::memory_order_relaxed);
+        bool success;
+        if (op < OperationStats::TimedOperationCount && (calls & (LatencySampleInterval - 1)) == 0)
+        {
+            auto start = std::chrono::steady_clock::now();
+            success = operation();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            Increment(shard.latency[op][Log2Histogram::Bucket(static_cast<uint64_t>(elapsed))]);
+        }
+        else
+        {
+            success = operation();
+        }
+        if (success)
+        {
+            Increment(shard.successes[op]);
+        }
+        return success;
+    }
+
+    /// @brief The decorated key->value store
+    KeyValueStoreSharedPtr m_keyValueStore;
+
+    /// @brief The counter shards; mutable since reads are counted too
+    mutable std::vector<Shard> m_shards;
+
+    /// @brief Selects a shard from a thread index
+    size_t m_shardMask;
+
+};
+
+/// @brief The size and traffic of one back-end of a Compound key->value store
+template <typename Key>
+struct BackEndStats
+{
+    /// @brief The front-end key the back-end was created for
+    Key frontEndKey;
+    /// @brief Entries held by the back-end
+    size_t size;
+    /// @brief Put, Get, Remove and Upsert calls routed to the back-end, zero unless
+    /// the back-end factory decorates its stores with Statistics
+    uint64_t accesses;
+};
+
+/// @brief Returns the size and traffic of every back-end of a Compound key->value store
+/// so routing imbalance can be seen
+template <typename Key, typename Value, typename LockPolicy>
+std::vector<BackEndStats<Key>> GetBackEndStats(const Compound<Key, Value, LockPolicy>& compound)
+{
+    std::vector<BackEndStats<Key>> backEnds;
+    compound.ForEachBackEnd(
+        [&](const Key& frontEndKey, const typename TypedKeyValueStore<Key, Value>::SharedPtr& backEnd)
+        {
+            auto statistics = std::dynamic_pointer_cast<Statistics<Key, Value>>(backEnd);
+            if (statistics)
+            {
+                backEnds.push_back(BackEndStats<Key>{ frontEndKey, statistics->GetKeyValueStore()->Size(),
+                                                      statistics->GetStats().Accesses() });
+            }
+            else
+            {
+                backEnds.push_back(BackEndStats<Key>{ frontEndKey, backEnd->Size(), 0 });
+            }
+        }
+    );
+    return backEnds;
+}
+
+} } // namespace Kvs::KeyValueStore
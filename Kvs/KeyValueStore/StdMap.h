@@ -34,22 +34,51 @@ public:
     /// @copydoc TypedKeyValueStore::Put()
     bool Put(const Key& key, const Value& value)
     {
-        ScopedLock lock(m_lock);
-        m_map[key] = value;
-        return true;
+        return Write(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        return Write(std::move(key), std::move(value));
     }
 
     /// @copydoc TypedKeyValueStore::Get()
     bool Get(const Key& key, Value& value) const
     {
-        ScopedLock lock(m_lock);
-        auto iter = m_map.find(key);
-        if (iter != m_map.end())
+        return Find(key, &value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get(std::string_view, Value&) const
+    bool Get(std::string_view key, Value& value) const
+    {
+        if constexpr (IsTransparent<Compare>::value)
         {
-            value = iter->second;
-            return true;
+            return Find(key, &value);
+        }
+        else
+        {
+            return TypedKeyValueStore<Key,Value>::Get(key, value);
+        }
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(const Key&) const
+    bool Contains(const Key& key) const
+    {
+        return Find(key, nullptr);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(std::string_view) const
+    bool Contains(std::string_view key) const
+    {
+        if constexpr (IsTransparent<Compare>::value)
+        {
+            return Find(key, nullptr);
+        }
+        else
+        {
+            return TypedKeyValueStore<Key,Value>::Contains(key);
         }
-        return false;
     }
 
     /// @copydoc TypedKeyValueStore::Remove()
@@ -76,7 +105,7 @@ public:
     void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
     {
         ScopedLock lock(m_lock);
-        for (auto iter : m_map)
+        for (const auto& iter : m_map)
         {
             funcObj(iter.first, iter.second);
         }
@@ -92,8 +121,66 @@ public:
         }
     }
 
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        // one descent, which also finds where the key goes if absent
+        auto iter = m_map.lower_bound(key);
+        const bool found = iter != m_map.end() && !m_map.key_comp()(key, iter->first);
+        Value value = found ? iter->second : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            iter->second = value;
+        }
+        else
+        {
+            m_map.emplace_hint(iter, key, value);
+        }
+        return true;
+    }
+
 protected:
 
+    /// @brief Finds a key, or the key spelled by the provided characters, and retrieves its value if asked to
+    template <typename KeyLike>
+    bool Find(const KeyLike& key, Value* value) const
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter == m_map.end())
+        {
+            return false;
+        }
+        if (value)
+        {
+            *value = iter->second;
+        }
+        return true;
+    }
+
+    /// @brief Overwrites the value of a key held, or constructs the key and value in place,
+    /// in one descent, copying or moving from the provided ones as they were passed
+    template <typename KeyArg, typename ValueArg>
+    bool Write(KeyArg&& key, ValueArg&& value)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.lower_bound(key);
+        if (iter != m_map.end() && !m_map.key_comp()(key, iter->first))
+        {
+            iter->second = std::forward<ValueArg>(value);
+        }
+        else
+        {
+            m_map.emplace_hint(iter, std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+        }
+        return true;
+    }
+
     /// @brief The underlying implementation
     std::map<Key, Value, Compare> m_map;
 
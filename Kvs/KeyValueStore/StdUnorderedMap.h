@@ -6,6 +6,8 @@
 
 #include "../TypedKeyValueStore.h"
 #include "../Lock/Scoped.h"
+#include <functional>
+#include <type_traits>
 #include <unordered_map>
 
 namespace Kvs { namespace KeyValueStore {
@@ -35,22 +37,51 @@ public:
     /// @copydoc TypedKeyValueStore::Put()
     bool Put(const Key& key, const Value& value)
     {
-        ScopedLock lock(m_lock);
-        m_map[key] = value;
-        return true;
+        return Write(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Put(Key&&, Value&&)
+    bool Put(Key&& key, Value&& value)
+    {
+        return Write(std::move(key), std::move(value));
     }
 
     /// @copydoc TypedKeyValueStore::Get()
     bool Get(const Key& key, Value& value) const
     {
-        ScopedLock lock(m_lock);
-        auto iter = m_map.find(key);
-        if (iter != m_map.end())
+        return Find(key, &value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Get(std::string_view, Value&) const
+    /// @note Looked up without constructing a key only where the standard
+    /// library finds keys of another type in unordered containers, from C++20
+    bool Get(std::string_view key, Value& value) const
+    {
+#if defined(__cpp_lib_generic_unordered_lookup)
+        if constexpr (IsTransparent<Hash>::value && std::is_invocable_r<bool, std::equal_to<>, const Key&, std::string_view>::value)
         {
-            value = iter->second;
-            return true;
+            return Find(key, &value);
         }
-        return false;
+#endif
+        return TypedKeyValueStore<Key,Value>::Get(key, value);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(const Key&) const
+    bool Contains(const Key& key) const
+    {
+        return Find(key, nullptr);
+    }
+
+    /// @copydoc TypedKeyValueStore::Contains(std::string_view) const
+    bool Contains(std::string_view key) const
+    {
+#if defined(__cpp_lib_generic_unordered_lookup)
+        if constexpr (IsTransparent<Hash>::value && std::is_invocable_r<bool, std::equal_to<>, const Key&, std::string_view>::value)
+        {
+            return Find(key, nullptr);
+        }
+#endif
+        return TypedKeyValueStore<Key,Value>::Contains(key);
     }
 
     /// @copydoc TypedKeyValueStore::Remove()
@@ -77,7 +108,7 @@ public:
     void ForEach(const typename TypedKeyValueStore<Key,Value>::FuncObjReadOnly& funcObj) const
     {
         ScopedLock lock(m_lock);
-        for (auto iter : m_map)
+        for (const auto& iter : m_map)
         {
             funcObj(iter.first, iter.second);
         }
@@ -93,10 +124,69 @@ public:
         }
     }
 
+    /// @copydoc TypedKeyValueStore::Upsert()
+    bool Upsert(const Key& key, const typename TypedKeyValueStore<Key,Value>::FuncObjUpsert& funcObj)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        const bool found = iter != m_map.end();
+        Value value = found ? iter->second : Value();
+        if (!funcObj(value, found))
+        {
+            return false;
+        }
+        if (found)
+        {
+            iter->second = value;
+        }
+        else
+        {
+            m_map.emplace(key, value);
+        }
+        return true;
+    }
+
 protected:
 
+    /// @brief Finds a key, or the key spelled by the provided characters, and retrieves its value if asked to
+    template <typename KeyLike>
+    bool Find(const KeyLike& key, Value* value) const
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter == m_map.end())
+        {
+            return false;
+        }
+        if (value)
+        {
+            *value = iter->second;
+        }
+        return true;
+    }
+
+    /// @brief Overwrites the value of a key held, or constructs the key and value in a new node,
+    /// copying or moving from the provided ones as they were passed
+    /// @note A new key is hashed twice, once to find it absent and once to insert it
+    template <typename KeyArg, typename ValueArg>
+    bool Write(KeyArg&& key, ValueArg&& value)
+    {
+        ScopedLock lock(m_lock);
+        auto iter = m_map.find(key);
+        if (iter != m_map.end())
+        {
+            iter->second = std::forward<ValueArg>(value);
+        }
+        else
+        {
+            m_map.emplace(std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+        }
+        return true;
+    }
+
     /// @brief The underlying implementation
-    std::unordered_map<Key, Value, Hash> m_map;
+    /// @note Keys compare with std::equal_to<>, which is transparent as the hash may be
+    std::unordered_map<Key, Value, Hash, std::equal_to<>> m_map;
 
     /// @brief The locking policy
     LockPolicy m_lock;
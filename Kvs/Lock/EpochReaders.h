@@ -0,0 +1,44 @@
+/// @file
+/// @brief Defines and implements the Kvs::Lock::EpochReaders class
+
+#pragma once
+
+#include "Scoped.h"
+#include "../Reclaim/Epoch.h"
+
+namespace Kvs { namespace Lock {
+
+/// @brief A lock type whose readers take no lock at all
+/// Writers are serialized by the wrapped lock type. Lock::ReadScoped only
+/// enters a Reclaim::Epoch guard, so a store using it must only ever be
+/// built from stores whose readers are themselves safe without a lock,
+/// such as KeyValueStore::EpochHashTable.
+template <typename WriterLockPolicy>
+class EpochReaders
+{
+public:
+    /// @brief Obtain the writer lock
+    inline void Lock() const { m_lock.Lock(); }
+    /// @brief Obtain the writer lock only if it is free, returning true if it was obtained
+    inline bool TryLock() const { return m_lock.TryLock(); }
+    /// @brief Release the writer lock
+    inline void Unlock() const { m_lock.Unlock(); }
+protected:
+    /// @brief The lock serializing writers
+    WriterLockPolicy m_lock;
+};
+
+/// @brief Specialized RAII style read lock mechanism for Kvs::Lock::EpochReaders
+/// which only holds the epoch for the lifetime of the read
+template<typename WriterLockPolicy>
+class ReadScoped<EpochReaders<WriterLockPolicy>>
+{
+public:
+    /// @brief Enters the epoch
+    ReadScoped(const EpochReaders<WriterLockPolicy>& lock) { }
+protected:
+    /// @brief The epoch guard
+    Reclaim::Epoch::Guard m_guard;
+};
+
+} } // namespace Kvs::Lock
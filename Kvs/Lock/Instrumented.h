@@ -0,0 +1,209 @@
+/// @file
+/// @brief Defines and implements the Kvs::Lock::Instrumented class
+
+#pragma once
+
+#include "../Log2Histogram.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+
+namespace Kvs { namespace Lock {
+
+/// @brief Contention statistics of one or more Instrumented locks
+struct ContentionStats
+{
+    /// @brief Times the lock was obtained
+    uint64_t acquisitions = 0;
+    /// @brief Acquisitions that found the lock taken and had to wait
+    uint64_t contended = 0;
+    /// @brief Time from asking for the lock to obtaining it, zero when uncontended
+    Log2Histogram waitNs;
+    /// @brief Time from obtaining the lock to releasing it
+    Log2Histogram holdNs;
+
+    /// @brief Adds the statistics of another lock
+    ContentionStats& operator+=(const ContentionStats& other)
+    {
+        acquisitions += other.acquisitions;
+        contended += other.contended;
+        waitNs += other.waitNs;
+        holdNs += other.holdNs;
+        return *this;
+    }
+
+    /// @brief Fraction of acquisitions that had to wait
+    double ContendedRatio() const
+    {
+        return acquisitions ? static_cast<double>(contended) / acquisitions : 0.0;
+    }
+};
+
+/// @brief Keeps track of every live Instrumented lock so a harness can collect
+/// their statistics without reaching into the stores that own them
+class Instrumentation
+{
+public:
+
+    /// @brief Returns the statistics of every live Instrumented lock summed
+    static ContentionStats Sum()
+    {
+        std::lock_guard<std::mutex> guard(RegistryMutex());
+        ContentionStats sum;
+        for (auto lock : Registry())
+        {
+            sum += lock->GetStats();
+        }
+        return sum;
+    }
+
+    /// @brief Zeros the statistics of every live Instrumented lock
+    static void ResetAll()
+    {
+        std::lock_guard<std::mutex> guard(RegistryMutex());
+        for (auto lock : Registry())
+        {
+            lock->ResetStats();
+        }
+    }
+
+    /// @brief Returns the statistics of this lock
+    virtual ContentionStats GetStats() const = 0;
+
+    /// @brief Zeros the statistics of this lock
+    virtual void ResetStats() const = 0;
+
+    /// @brief make non-copyable
+    Instrumentation(const Instrumentation&) = delete;
+
+    /// @brief make non-assignable
+    Instrumentation& operator=(const Instrumentation&) = delete;
+
+protected:
+
+    /// @brief Registers the lock
+    Instrumentation()
+    {
+        std::lock_guard<std::mutex> guard(RegistryMutex());
+        Registry().insert(this);
+    }
+
+    /// @brief Unregisters the lock
+    virtual ~Instrumentation()
+    {
+        std::lock_guard<std::mutex> guard(RegistryMutex());
+        Registry().erase(this);
+    }
+
+    /// @brief The live locks
+    static std::set<const Instrumentation*>& Registry()
+    {
+        static std::set<const Instrumentation*> registry;
+        return registry;
+    }
+
+    /// @brief Guards the registry, which is only touched on construction,
+    /// destruction and collection, never on Lock()/Unlock()
+    static std::mutex& RegistryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+};
+
+/// @brief A lock type that wraps another to profile contention
+/// Every acquisition first tries the wrapped lock; if that fails the
+/// acquisition counts as contended and the time spent waiting is recorded.
+/// Hold time is recorded on release. All statistics are updated while the
+/// lock is held, so the wrapped lock itself protects them.
+/// Works with Lock::Scoped like any other lock type.
+/// @note The wrapped type must provide Lock(), TryLock() and Unlock().
+/// With Lock::None nothing protects the statistics, so only single-threaded
+/// use is meaningful.
+template <typename LockPolicy>
+class Instrumented : public Instrumentation
+{
+public:
+    /// @brief Construct the lock
+    Instrumented() : m_lock(), m_stats(), m_acquiredAt() { }
+
+    /// @brief Obtain the lock
+    inline void Lock() const
+    {
+        if (m_lock.TryLock())
+        {
+            m_acquiredAt = Clock::now();
+            m_stats.waitNs.Record(0);
+        }
+        else
+        {
+            auto start = Clock::now();
+            m_lock.Lock();
+            m_acquiredAt = Clock::now();
+            ++m_stats.contended;
+            m_stats.waitNs.Record(Nanoseconds(m_acquiredAt - start));
+        }
+        ++m_stats.acquisitions;
+    }
+
+    /// @brief Obtain the lock only if it is free
+    /// @return true if the lock was obtained
+    inline bool TryLock() const
+    {
+        if (!m_lock.TryLock())
+        {
+            return false;
+        }
+        m_acquiredAt = Clock::now();
+        m_stats.waitNs.Record(0);
+        ++m_stats.acquisitions;
+        return true;
+    }
+
+    /// @brief Release the lock
+    inline void Unlock() const
+    {
+        m_stats.holdNs.Record(Nanoseconds(Clock::now() - m_acquiredAt));
+        m_lock.Unlock();
+    }
+
+    /// @copydoc Instrumentation::GetStats()
+    ContentionStats GetStats() const
+    {
+        m_lock.Lock();
+        ContentionStats stats = m_stats;
+        m_lock.Unlock();
+        return stats;
+    }
+
+    /// @copydoc Instrumentation::ResetStats()
+    void ResetStats() const
+    {
+        m_lock.Lock();
+        m_stats = ContentionStats();
+        m_lock.Unlock();
+    }
+
+protected:
+
+    /// @brief The clock used for wait and hold times
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Converts a clock duration to whole nanoseconds
+    static uint64_t Nanoseconds(Clock::duration duration)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    /// @brief The wrapped lock
+    LockPolicy m_lock;
+
+    /// @brief The statistics, protected by m_lock
+    mutable ContentionStats m_stats;
+
+    /// @brief When the current holder obtained the lock
+    mutable Clock::time_point m_acquiredAt;
+};
+
+} } // namespace Kvs::Lock
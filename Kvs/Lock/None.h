@@ -12,6 +12,8 @@ class None
 public:
     /// @brief Obtain the lock
     inline void Lock()   const { }
+    /// @brief Obtain the lock only if it is free, which it always is
+    inline bool TryLock() const { return true; }
     /// @brief Release the lock
     inline void Unlock() const { }
 };
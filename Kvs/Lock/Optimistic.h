@@ -0,0 +1,77 @@
+/// @file
+/// @brief Defines and implements the Kvs::Lock::Optimistic class
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Kvs { namespace Lock {
+
+/// @brief A lock type with a version counter that lets readers go without locking
+/// Writers take it exclusively like Spin, and every unlock bumps the version.
+/// A reader notes the version with ReadLock(), reads what the lock protects
+/// and then asks Validate() whether a writer got in meanwhile; if so it must
+/// throw away what it read and start over. A reader that decides to write
+/// upgrades with Upgrade(), which only succeeds if nothing changed since its
+/// ReadLock(). This is the building block of optimistic lock coupling.
+/// @note Readers read while a writer may be writing, so what is protected
+/// must stay safe to read torn: plain data, with pointers not followed
+/// until the read validates.
+class Optimistic
+{
+public:
+    /// @brief Construct the lock, unlocked at version zero
+    Optimistic() : m_version(0) { }
+    /// @brief Obtain the lock
+    inline void Lock() const
+    {
+        while (!TryLock())
+            ; // spin
+    }
+    /// @brief Obtain the lock only if it is free
+    /// @return true if the lock was obtained
+    inline bool TryLock() const
+    {
+        uint64_t version;
+        return ReadLock(version) && Upgrade(version);
+    }
+    /// @brief Release the lock, moving to the next version
+    inline void Unlock() const
+    {
+        m_version.fetch_add(Locked, std::memory_order_release);
+    }
+    /// @brief Note the version before an optimistic read
+    /// @return false if a writer holds the lock, so reading now is pointless
+    inline bool ReadLock(uint64_t& version) const
+    {
+        version = m_version.load(std::memory_order_acquire);
+        return !(version & Locked);
+    }
+    /// @brief Whether nothing was written since the provided version was noted
+    inline bool Validate(uint64_t version) const
+    {
+        // keep the reads being validated from moving past the check
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_version.load(std::memory_order_relaxed) == version;
+    }
+    /// @brief Obtain the lock only if nothing was written since the provided version was noted
+    /// @return true if the lock was obtained, with version updated to match
+    inline bool Upgrade(uint64_t& version) const
+    {
+        if (!m_version.compare_exchange_strong(version, version + Locked, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+        version += Locked;
+        return true;
+    }
+protected:
+    /// @brief The version bit that is set while a writer holds the lock
+    /// @note Lock() and Unlock() each add it, so the version goes up by two per write
+    static const uint64_t Locked = 1;
+    /// @brief The version, odd while locked
+    mutable std::atomic<uint64_t> m_version;
+};
+
+} } // namespace Kvs::Lock
@@ -40,4 +40,15 @@ public:
     ~Scoped() { }
 };
 
+/// @brief RAII style lock mechanism for paths that only read
+/// Acquires the lock exactly as Scoped does; lock types whose readers can do
+/// without the lock specialize it
+template<typename LockType>
+class ReadScoped : public Scoped<LockType>
+{
+public:
+    /// @brief Acquires the lock provided upon construction
+    ReadScoped(const LockType& lock) : Scoped<LockType>(lock) { }
+};
+
 } } // namespace Kvs::Lock
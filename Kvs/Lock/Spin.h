@@ -19,6 +19,12 @@ public:
         while (m_lock.test_and_set(std::memory_order_acquire))
             ; // spin
     }
+    /// @brief Obtain the lock only if it is free
+    /// @return true if the lock was obtained
+    inline bool TryLock() const
+    {
+        return !m_lock.test_and_set(std::memory_order_acquire);
+    }
     /// @brief Release the lock
     inline void Unlock() const
     {
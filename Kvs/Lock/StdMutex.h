@@ -13,6 +13,8 @@ class StdMutex
 public:
     /// @brief Obtain the lock
     inline void Lock()   const { m_lock.lock();   }
+    /// @brief Obtain the lock only if it is free, returning true if it was obtained
+    inline bool TryLock() const { return m_lock.try_lock(); }
     /// @brief Release the lock
     inline void Unlock() const { m_lock.unlock(); }
 protected:
@@ -0,0 +1,104 @@
+/// @file
+/// @brief Defines and implements the Kvs::Log2Histogram class
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Kvs
+{
+
+/// @brief A histogram of durations in power-of-two nanosecond buckets
+/// Coarse, but small and cheap enough to keep per store or per lock.
+/// Bucket b counts durations under 2^b nanoseconds and at least 2^(b-1).
+class Log2Histogram
+{
+public:
+
+    /// @brief Number of buckets; the last one also holds everything longer
+    static const size_t BucketCount = 32;
+
+    /// @brief Returns the bucket of the provided duration
+    static size_t Bucket(uint64_t nanoseconds)
+    {
+        size_t bucket = 0;
+        while (nanoseconds && bucket < BucketCount - 1)
+        {
+            nanoseconds >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    /// @brief Constructs an empty histogram
+    Log2Histogram()
+    {
+        m_buckets.fill(0);
+    }
+
+    /// @brief Records one duration
+    void Record(uint64_t nanoseconds)
+    {
+        ++m_buckets[Bucket(nanoseconds)];
+    }
+
+    /// @brief Adds the provided count to a bucket, e.g. when summing shards
+    void Add(size_t bucket, uint64_t count)
+    {
+        m_buckets[bucket] += count;
+    }
+
+    /// @brief Adds every sample of another histogram
+    Log2Histogram& operator+=(const Log2Histogram& other)
+    {
+        for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+        {
+            m_buckets[bucket] += other.m_buckets[bucket];
+        }
+        return *this;
+    }
+
+    /// @brief Number of samples in a bucket
+    uint64_t BucketSamples(size_t bucket) const
+    {
+        return m_buckets[bucket];
+    }
+
+    /// @brief Number of samples recorded
+    uint64_t Samples() const
+    {
+        uint64_t samples = 0;
+        for (auto count : m_buckets)
+        {
+            samples += count;
+        }
+        return samples;
+    }
+
+    /// @brief Upper bound in nanoseconds of the provided percentile
+    /// @return zero if nothing was recorded
+    uint64_t Percentile(double percentile) const
+    {
+        uint64_t samples = Samples();
+        uint64_t rank = static_cast<uint64_t>(samples * percentile / 100.0);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BucketCount && samples; ++bucket)
+        {
+            seen += m_buckets[bucket];
+            if (seen > rank || seen == samples)
+            {
+                return uint64_t(1) << bucket;
+            }
+        }
+        return 0;
+    }
+
+protected:
+
+    /// @brief The sample count per bucket
+    std::array<uint64_t, BucketCount> m_buckets;
+};
+
+} // namespace Kvs
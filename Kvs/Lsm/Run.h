@@ -0,0 +1,324 @@
+/// @file
+/// @brief Defines and implements the Kvs::Lsm::Run class
+
+#pragma once
+
+#include "../Filter/BlockedBloom.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Kvs { namespace Lsm {
+
+/// @brief A key, its value, and whether the key was removed, as kept in runs
+template <typename Key, typename Value>
+struct Record
+{
+    Key key;
+    Value value;
+    bool removed;
+};
+
+/// @brief An immutable, sorted file of records, one of the runs of an Lsm store
+/// Records are written as raw bytes in blocks of about BlockBytes. The first
+/// key of each block and a Filter::BlockedBloom of every key are kept in
+/// memory, so a Get() of a key the run does not hold usually reads nothing
+/// from disk, and one it holds reads one block. A Cursor reads the records in order, one
+/// block at a time, for merging runs.
+/// @note Runs only live as long as the store that wrote them, so the file
+/// holds the records alone: the index and filter are never read back.
+/// @note The file is removed when the run is destroyed if MarkObsolete() was called.
+template <typename Key, typename Value, typename Compare, typename Hash>
+class Run
+{
+public:
+
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+        "runs keep keys and values as raw bytes");
+
+    /// @brief Convenient rename for a record
+    using RecordType = Record<Key, Value>;
+
+    /// @brief Convenient rename for a shared pointer to a run
+    using SharedPtr = std::shared_ptr<Run>;
+
+    /// @brief Writes a run from records added in increasing key order
+    class Writer
+    {
+    public:
+
+        /// @brief Constructor, creates the file
+        /// @param path where the run's file goes
+        /// @param keys about how many records will be added, to size the filter
+        /// @param blockBytes bytes per block, rounded down to whole records
+        /// @param bitsPerKey bits the filter spends per key
+        Writer(const std::string& path, size_t keys, size_t blockBytes, size_t bitsPerKey)
+            : m_run(new Run(path, keys, bitsPerKey))
+            , m_block()
+            , m_blockRecords(blockBytes / sizeof(RecordType) ? blockBytes / sizeof(RecordType) : 1)
+            , m_failed(m_run->m_file < 0)
+        {
+            m_block.reserve(m_blockRecords);
+        }
+
+        /// @brief Adds the next record, whose key must be greater than the last one's
+        void Add(const RecordType& record)
+        {
+            m_block.push_back(record);
+            if (m_block.size() == m_blockRecords)
+            {
+                WriteBlock();
+            }
+        }
+
+        /// @brief Writes what is left and returns the run, or nullptr if the file could not be written
+        SharedPtr Finish()
+        {
+            WriteBlock();
+            if (m_failed)
+            {
+                m_run->MarkObsolete();
+                return nullptr;
+            }
+            return SharedPtr(m_run.release());
+        }
+
+    protected:
+
+        /// @brief Writes the buffered records as one block
+        void WriteBlock()
+        {
+            if (m_block.empty())
+            {
+                return;
+            }
+            auto& run = *m_run;
+            run.m_index.push_back(BlockHandle { m_block.front().key, run.m_bytes, static_cast<uint32_t>(m_block.size()) });
+            for (const auto& record : m_block)
+            {
+                run.m_filter.Add(run.m_hash(record.key));
+            }
+            const size_t bytes = m_block.size() * sizeof(RecordType);
+            m_failed = m_failed || ::pwrite(run.m_file, m_block.data(), bytes, run.m_bytes) != static_cast<ssize_t>(bytes);
+            run.m_bytes += bytes;
+            run.m_records += m_block.size();
+            m_block.clear();
+        }
+
+        /// @brief The run being written
+        std::unique_ptr<Run> m_run;
+
+        /// @brief Records not written yet
+        std::vector<RecordType> m_block;
+
+        /// @brief Records per block
+        size_t m_blockRecords;
+
+        /// @brief Whether creating or writing the file failed
+        bool m_failed;
+    };
+
+    /// @brief Reads a run's records in order
+    class Cursor
+    {
+    public:
+
+        /// @brief Constructor, positioned at the first record
+        explicit Cursor(const Run& run)
+            : m_run(run), m_block(), m_nextBlock(0), m_position(0)
+        {
+            ReadBlock();
+        }
+
+        /// @brief Returns whether the cursor is at a record
+        bool Valid() const
+        {
+            return m_position < m_block.size();
+        }
+
+        /// @brief Returns the current record
+        const RecordType& Current() const
+        {
+            return m_block[m_position];
+        }
+
+        /// @brief Moves on to the next record
+        void Next()
+        {
+            if (++m_position == m_block.size())
+            {
+                ReadBlock();
+            }
+        }
+
+    protected:
+
+        /// @brief Reads the next block, or leaves the cursor invalid past the last one
+        void ReadBlock()
+        {
+            m_position = 0;
+            m_block.clear();
+            while (m_nextBlock < m_run.m_index.size() && m_block.empty())
+            {
+                m_run.ReadBlock(m_run.m_index[m_nextBlock++], m_block);
+            }
+        }
+
+        /// @brief The run read
+        const Run& m_run;
+
+        /// @brief The records of the current block
+        std::vector<RecordType> m_block;
+
+        /// @brief The block read next
+        size_t m_nextBlock;
+
+        /// @brief The current record in m_block
+        size_t m_position;
+    };
+
+    /// @brief Destructor, closes the file and removes it if the run is obsolete
+    ~Run()
+    {
+        if (m_file >= 0)
+        {
+            ::close(m_file);
+        }
+        if (m_obsolete.load(std::memory_order_relaxed))
+        {
+            ::unlink(m_path.c_str());
+        }
+    }
+
+    /// @brief Looks up a key, with its hash already computed
+    /// @return whether the run holds the key, which may have been removed
+    bool Get(const Key& key, size_t hash, RecordType& record) const
+    {
+        if (!m_filter.MayContain(hash))
+        {
+            return false;
+        }
+        // the last block whose first key is not greater than the key
+        auto block = std::upper_bound(m_index.begin(), m_index.end(), key,
+            [this] (const Key& lhs, const BlockHandle& rhs) { return m_compare(lhs, rhs.firstKey); });
+        if (block == m_index.begin())
+        {
+            return false;
+        }
+        std::vector<RecordType> records;
+        m_blockReads.fetch_add(1, std::memory_order_relaxed);
+        if (!ReadBlock(*--block, records))
+        {
+            return false;
+        }
+        auto found = std::lower_bound(records.begin(), records.end(), key,
+            [this] (const RecordType& lhs, const Key& rhs) { return m_compare(lhs.key, rhs); });
+        if (found == records.end() || m_compare(key, found->key))
+        {
+            return false;
+        }
+        record = *found;
+        return true;
+    }
+
+    /// @brief Marks the run as replaced, so its file is removed once nobody reads it
+    void MarkObsolete()
+    {
+        m_obsolete.store(true, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the number of records, removed keys included
+    size_t GetRecords() const
+    {
+        return m_records;
+    }
+
+    /// @brief Returns the size of the file
+    size_t GetBytes() const
+    {
+        return m_bytes;
+    }
+
+    /// @brief Returns the number of blocks Get() has read from the file so far
+    size_t GetBlockReads() const
+    {
+        return m_blockReads.load(std::memory_order_relaxed);
+    }
+
+protected:
+
+    /// @brief Where a block is and the first key in it
+    struct BlockHandle
+    {
+        Key firstKey;
+        uint64_t offset;
+        uint32_t records;
+    };
+
+    /// @brief Constructor, used by Writer
+    Run(const std::string& path, size_t keys, size_t bitsPerKey)
+        : m_path(path)
+        , m_file(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600))
+        , m_index()
+        , m_filter(keys, bitsPerKey)
+        , m_records(0)
+        , m_bytes(0)
+        , m_compare()
+        , m_hash()
+        , m_blockReads(0)
+        , m_obsolete(false)
+    {
+
+    }
+
+    /// @brief Reads a block's records
+    bool ReadBlock(const BlockHandle& block, std::vector<RecordType>& records) const
+    {
+        records.resize(block.records);
+        const size_t bytes = block.records * sizeof(RecordType);
+        if (::pread(m_file, records.data(), bytes, block.offset) != static_cast<ssize_t>(bytes))
+        {
+            records.clear();
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief The file's path
+    std::string m_path;
+
+    /// @brief The file, or -1 if it could not be created
+    int m_file;
+
+    /// @brief The first key of every block
+    std::vector<BlockHandle> m_index;
+
+    /// @brief The hashes of every key
+    Filter::BlockedBloom m_filter;
+
+    /// @brief Number of records
+    size_t m_records;
+
+    /// @brief Size of the file
+    size_t m_bytes;
+
+    /// @brief The key comparison function object
+    Compare m_compare;
+
+    /// @brief The hash function object
+    Hash m_hash;
+
+    /// @brief Blocks Get() has read so far; mutable since Get() is const
+    mutable std::atomic<size_t> m_blockReads;
+
+    /// @brief Whether the file goes with the run
+    std::atomic<bool> m_obsolete;
+};
+
+} } // namespace Kvs::Lsm
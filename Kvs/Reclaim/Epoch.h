@@ -0,0 +1,310 @@
+/// @file
+/// @brief Defines and implements the Kvs::Reclaim::Epoch class
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Kvs { namespace Reclaim {
+
+/// @brief Epoch-based memory reclamation shared by every store in the process
+/// Readers wrap any access to shared nodes in an Epoch::Guard, which only
+/// publishes the global epoch in the calling thread's record: no lock and no
+/// read-modify-write. Writers unlink a node so no new reader can reach it and
+/// then Retire() it instead of deleting it. A retired node is deleted once the
+/// global epoch has advanced twice past the epoch it was retired in, which
+/// cannot happen while any reader that might still see it is inside a guard.
+/// Retired nodes are kept per thread and reclaimed in batches of BatchSize,
+/// so the epoch scan is amortized over many retirements.
+/// @note Guards nest. Never call Synchronize() while holding a guard.
+/// @note Nodes still pending when their thread exits are handed to whichever
+/// thread reclaims next, and freed at process exit at the latest.
+class Epoch
+{
+public:
+
+    /// @brief Retirements per thread between attempts to advance the epoch and reclaim
+    static const size_t BatchSize = 64;
+
+    /// @brief Marks the calling thread as reading for its lifetime
+    class Guard
+    {
+    public:
+        /// @brief Enters the current epoch
+        Guard() { Enter(); }
+        /// @brief Leaves the epoch
+        ~Guard() { Exit(); }
+        /// @brief make non-copyable
+        Guard(const Guard&) = delete;
+        /// @brief make non-assignable
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /// @brief Marks the calling thread as reading; prefer Guard
+    static void Enter()
+    {
+        auto& local = Local();
+        if (local.depth++ == 0)
+        {
+            auto& state = GetState();
+            local.record->epoch.store((state.epoch.load(std::memory_order_relaxed) << 1) | Active,
+                                      std::memory_order_relaxed);
+            // the announcement must be visible before any shared pointer is read
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    /// @brief Marks the calling thread as no longer reading; prefer Guard
+    static void Exit()
+    {
+        auto& local = Local();
+        if (--local.depth == 0)
+        {
+            local.record->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /// @brief Defers deleting an object no reader can newly reach
+    template <typename T>
+    static void Retire(T* object)
+    {
+        Retire(object, [] (void* pointer) { delete static_cast<T*>(pointer); });
+    }
+
+    /// @brief Defers calling the provided deleter on an object no reader can newly reach
+    static void Retire(void* object, void (*deleter)(void*))
+    {
+        auto& state = GetState();
+        auto& local = Local();
+        // order the unlink that preceded this call before reading the epoch
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        local.retired.push_back(Retired{ object, deleter, state.epoch.load(std::memory_order_relaxed) });
+        if (local.retired.size() >= local.nextReclaim)
+        {
+            Collect();
+        }
+    }
+
+    /// @brief Tries to advance the epoch and frees what has become safe to free,
+    /// without waiting for anyone
+    /// @note Retire() calls this every BatchSize retirements; call it directly
+    /// after retiring objects too large to leave waiting for a batch
+    static void Collect()
+    {
+        auto& local = Local();
+        TryAdvance();
+        Reclaim(local.retired);
+        ReclaimOrphans(false);
+        // back off if readers hold the epoch, so the scan stays amortized
+        local.nextReclaim = local.retired.size() + BatchSize;
+    }
+
+    /// @brief Waits for every current reader to leave, then frees everything
+    /// the calling thread and exited threads have retired so far
+    static void Synchronize()
+    {
+        auto& state = GetState();
+        uint64_t target = state.epoch.load(std::memory_order_acquire) + 2;
+        while (state.epoch.load(std::memory_order_acquire) < target)
+        {
+            if (!TryAdvance())
+            {
+                std::this_thread::yield();
+            }
+        }
+        Reclaim(Local().retired);
+        Local().nextReclaim = BatchSize;
+        ReclaimOrphans(true);
+    }
+
+    /// @brief Number of objects retired by the calling thread and not yet freed
+    static size_t Pending()
+    {
+        return Local().retired.size();
+    }
+
+    /// @brief The current global epoch, for tests and diagnostics
+    static uint64_t Current()
+    {
+        return GetState().epoch.load(std::memory_order_acquire);
+    }
+
+protected:
+
+    /// @brief Low bit of a record's epoch, set while its thread is reading
+    static const uint64_t Active = 1;
+
+    /// @brief A thread's published epoch, padded so no other record shares its cache line
+    /// @note Padded rather than aligned since C++11 new ignores extended alignment
+    struct Record
+    {
+        /// @brief (epoch << 1) | Active while reading, zero otherwise
+        std::atomic<uint64_t> epoch;
+        /// @brief Keeps the next record's epoch off this cache line
+        char padding[64];
+        /// @brief Whether a live thread owns this record
+        std::atomic<bool> inUse;
+        /// @brief The next record; records are never unlinked, only reused
+        Record* next;
+    };
+
+    /// @brief An object waiting to be freed
+    struct Retired
+    {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    /// @brief The process-wide state
+    struct State
+    {
+        std::atomic<uint64_t> epoch;
+        std::atomic<Record*> records;
+        std::mutex orphansMutex;
+        std::vector<Retired> orphans;
+
+        State() : epoch(2), records(nullptr) { }
+
+        /// @brief No readers remain at process exit, so anything left can go
+        ~State()
+        {
+            for (auto& retired : orphans)
+            {
+                retired.deleter(retired.object);
+            }
+            auto record = records.load();
+            while (record)
+            {
+                auto next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+    };
+
+    /// @brief The calling thread's record and retired objects
+    struct ThreadState
+    {
+        Record* record;
+        size_t depth;
+        size_t nextReclaim;
+        std::vector<Retired> retired;
+
+        /// @brief Claims a free record or adds a new one
+        ThreadState() : record(nullptr), depth(0), nextReclaim(BatchSize), retired()
+        {
+            auto& state = GetState();
+            for (auto candidate = state.records.load(std::memory_order_acquire); candidate; candidate = candidate->next)
+            {
+                bool expected = false;
+                if (!candidate->inUse.load(std::memory_order_relaxed)
+                    && candidate->inUse.compare_exchange_strong(expected, true))
+                {
+                    record = candidate;
+                    return;
+                }
+            }
+            record = new Record();
+            record->epoch.store(0, std::memory_order_relaxed);
+            record->inUse.store(true, std::memory_order_relaxed);
+            record->next = state.records.load(std::memory_order_relaxed);
+            while (!state.records.compare_exchange_weak(record->next, record))
+                ; // retry
+        }
+
+        /// @brief Releases the record and hands anything still pending to the other threads
+        ~ThreadState()
+        {
+            Reclaim(retired);
+            if (!retired.empty())
+            {
+                auto& state = GetState();
+                std::lock_guard<std::mutex> guard(state.orphansMutex);
+                state.orphans.insert(state.orphans.end(), retired.begin(), retired.end());
+            }
+            record->epoch.store(0, std::memory_order_release);
+            record->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    /// @brief Returns the process-wide state
+    static State& GetState()
+    {
+        static State state;
+        return state;
+    }
+
+    /// @brief Returns the calling thread's state
+    static ThreadState& Local()
+    {
+        static thread_local ThreadState local;
+        return local;
+    }
+
+    /// @brief Advances the global epoch if every reading thread has seen the current one
+    static bool TryAdvance()
+    {
+        auto& state = GetState();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t epoch = state.epoch.load(std::memory_order_acquire);
+        for (auto record = state.records.load(std::memory_order_acquire); record; record = record->next)
+        {
+            uint64_t published = record->epoch.load(std::memory_order_acquire);
+            if ((published & Active) && (published >> 1) != epoch)
+            {
+                return false;
+            }
+        }
+        return state.epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    /// @brief Frees the retired objects that are two epochs old
+    /// @note Objects are retired in epoch order, so the ones to free form a prefix
+    static void Reclaim(std::vector<Retired>& retired)
+    {
+        uint64_t epoch = GetState().epoch.load(std::memory_order_acquire);
+        size_t freed = 0;
+        while (freed < retired.size() && retired[freed].epoch + 2 <= epoch)
+        {
+            retired[freed].deleter(retired[freed].object);
+            ++freed;
+        }
+        retired.erase(retired.begin(), retired.begin() + freed);
+    }
+
+    /// @brief Frees what exited threads left behind, waiting for the mutex only if asked
+    static void ReclaimOrphans(bool wait)
+    {
+        auto& state = GetState();
+        std::unique_lock<std::mutex> guard(state.orphansMutex, std::defer_lock);
+        if (wait)
+        {
+            guard.lock();
+        }
+        else if (!guard.try_lock())
+        {
+            return;
+        }
+        uint64_t epoch = state.epoch.load(std::memory_order_acquire);
+        std::vector<Retired> remaining;
+        for (auto& retired : state.orphans)
+        {
+            if (retired.epoch + 2 <= epoch)
+            {
+                retired.deleter(retired.object);
+            }
+            else
+            {
+                remaining.push_back(retired);
+            }
+        }
+        state.orphans.swap(remaining);
+    }
+};
+
+} } // namespace Kvs::Reclaim
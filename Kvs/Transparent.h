@@ -0,0 +1,49 @@
+/// @file
+/// @brief Defines the helpers that look keys up by the characters spelling them
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace Kvs
+{
+
+/// @brief True if a hash or comparison functor also takes the characters spelling a key,
+/// which it declares with an is_transparent typedef as for the standard containers
+template <typename Functor, typename = void>
+struct IsTransparent : std::false_type
+{
+
+};
+
+/// @brief Specialization for the functors declaring is_transparent
+template <typename Functor>
+struct IsTransparent<Functor, std::void_t<typename Functor::is_transparent>> : std::true_type
+{
+
+};
+
+/// @brief Makes the key spelled by the provided characters
+/// A key of plain bytes, as the hash and comparison functors read keys,
+/// holds the characters followed by zeros; characters past its size are
+/// dropped. Other keys are constructed from the characters.
+template <typename Key>
+Key MakeKey(std::string_view characters)
+{
+    if constexpr (std::is_trivially_copyable<Key>::value)
+    {
+        Key key;
+        memset(&key, 0, sizeof(key));
+        memcpy(&key, characters.data(), std::min(characters.size(), sizeof(key)));
+        return key;
+    }
+    else
+    {
+        return Key(characters);
+    }
+}
+
+} // namespace Kvs
@@ -4,6 +4,10 @@
 #pragma once
 
 #include "IKeyValueStore.h"
+#include "Transparent.h"
+#include <functional>
+#include <string_view>
+#include <utility>
 
 namespace Kvs
 {
@@ -22,9 +26,46 @@ public:
 
     /// @brief Inserts or overwrites a key and its corresponding value into the store
     virtual bool Put(const Key& key, const Value& value) = 0;
-    
+
+    /// @brief Inserts or overwrites a key and its corresponding value into the store, moving from both
+    /// @note Stores that keep their own copy anyway, e.g. in a node read
+    /// without locks, do not override this and copy as the other Put() does
+    virtual bool Put(Key&& key, Value&& value)
+    {
+        return Put(static_cast<const Key&>(key), static_cast<const Value&>(value));
+    }
+
+    /// @brief Inserts or overwrites a key with a value constructed from the provided arguments
+    /// The value is constructed once, here, then moved into the store.
+    template <typename... Args>
+    bool Emplace(const Key& key, Args&&... args)
+    {
+        return Put(Key(key), Value(std::forward<Args>(args)...));
+    }
+
     /// @brief Retrieves a key and its corresponding value from the store
     virtual bool Get(const Key& key, Value& value) const = 0;
+
+    /// @brief Retrieves the value of the key spelled by the provided characters, e.g. a slice of a network buffer
+    /// Stores whose hash or comparison is transparent look the characters up
+    /// without constructing a key; the others construct one with MakeKey().
+    virtual bool Get(std::string_view key, Value& value) const
+    {
+        return Get(MakeKey<Key>(key), value);
+    }
+
+    /// @brief Returns true if the store holds the key, without retrieving its value where it can
+    virtual bool Contains(const Key& key) const
+    {
+        Value value;
+        return Get(key, value);
+    }
+
+    /// @brief Returns true if the store holds the key spelled by the provided characters
+    virtual bool Contains(std::string_view key) const
+    {
+        return Contains(MakeKey<Key>(key));
+    }
     
     /// @brief Removes a key and its corresponding value from the store
     virtual bool Remove(const Key& key) = 0;
@@ -44,6 +85,110 @@ public:
     /// @brief Applies the provided function against each key->value pair in the store
     virtual void Transform(const FuncObjReadKeyWriteValue& funcObj) = 0;
 
+    /// @brief Convenient name for a read-modify-write of one key's value
+    /// Called with the key's value and true, or with a value-initialized
+    /// value and false if the key is absent; returns whether to store the
+    /// value as modified, or to leave the store as it was.
+    using FuncObjUpsert = std::function<bool(Value&, bool)>;
+
+    /// @brief Atomically reads, modifies and writes the value of a key, inserting the key if absent
+    /// No other Put(), Remove() or Upsert() of the key comes between the read
+    /// and the write. Stores that update without locks may call the function
+    /// again with a newer value if another writer got there first, so it
+    /// should have no effect other than on the value.
+    /// @return true if the value was stored
+    virtual bool Upsert(const Key& key, const FuncObjUpsert& funcObj) = 0;
+
+    /// @brief Stores the desired value if the key holds a value equal to the expected one
+    /// @return true if the key held the expected value, which is now replaced
+    bool CompareAndSwap(const Key& key, const Value& expected, const Value& desired)
+    {
+        return Upsert(key, [&] (Value& value, bool found)
+            {
+                if (!found || !(value == expected))
+                {
+                    return false;
+                }
+                value = desired;
+                return true;
+            } );
+    }
+
+    /// @brief Inserts the key with the provided value if absent, else retrieves the value it holds
+    /// @return true if the key was inserted, false if value now holds the value found
+    bool GetOrInsert(const Key& key, Value& value)
+    {
+        bool inserted = false;
+        Upsert(key, [&] (Value& current, bool found)
+            {
+                inserted = !found;
+                if (found)
+                {
+                    value = current;
+                    return false;
+                }
+                current = value;
+                return true;
+            } );
+        return inserted;
+    }
+
+    /// @brief Stores the provided value and retrieves the value it replaced
+    /// @return true if the key was present, and previous holds the value it had
+    bool Exchange(const Key& key, const Value& value, Value& previous)
+    {
+        bool replaced = false;
+        Upsert(key, [&] (Value& current, bool found)
+            {
+                replaced = found;
+                if (found)
+                {
+                    previous = current;
+                }
+                current = value;
+                return true;
+            } );
+        return replaced;
+    }
+
+    /// @brief Convenient name for an associative operator combining an operand into a value
+    using FuncObjMerge = std::function<void(Value&, const Value&)>;
+
+    /// @brief Registers the operator Merge() combines values with
+    /// @note Not thread-safe: register before the store is shared
+    void SetMergeOperator(const FuncObjMerge& mergeOperator)
+    {
+        m_mergeOperator = mergeOperator;
+    }
+
+    /// @brief Atomically combines the operand into the value of a key with the registered
+    /// merge operator, or inserts the key with the operand as its value if absent
+    /// @return true if the merged value was stored, false if no merge operator is registered
+    bool Merge(const Key& key, const Value& operand)
+    {
+        if (!m_mergeOperator)
+        {
+            return false;
+        }
+        return Upsert(key, [&] (Value& value, bool found)
+            {
+                if (found)
+                {
+                    m_mergeOperator(value, operand);
+                }
+                else
+                {
+                    value = operand;
+                }
+                return true;
+            } );
+    }
+
+protected:
+
+    /// @brief The operator Merge() combines values with, if registered
+    FuncObjMerge m_mergeOperator;
+
 };
 
 } // namespace Kvs
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <malloc.h>
+
+namespace // anonymous
+{
+
+std::atomic<bool> Enabled(false);
+std::atomic<int64_t> LiveBytes(0);
+std::atomic<int64_t> PeakBytes(0);
+std::atomic<uint64_t> Allocations(0);
+std::atomic<uint64_t> Frees(0);
+
+void* Allocate(size_t size)
+{
+    void* pointer = malloc(size ? size : 1);
+    if (!pointer)
+    {
+        throw std::bad_alloc();
+    }
+    if (Enabled.load(std::memory_order_relaxed))
+    {
+        int64_t live = LiveBytes.fetch_add(malloc_usable_size(pointer), std::memory_order_relaxed)
+                       + malloc_usable_size(pointer);
+        Allocations.fetch_add(1, std::memory_order_relaxed);
+        int64_t peak = PeakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ; // retry
+    }
+    return pointer;
+}
+
+void Deallocate(void* pointer)
+{
+    if (!pointer)
+    {
+        return;
+    }
+    if (Enabled.load(std::memory_order_relaxed))
+    {
+        LiveBytes.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+        Frees.fetch_add(1, std::memory_order_relaxed);
+    }
+    free(pointer);
+}
+
+/// @brief Returns a "VmXXX:" field of /proc/self/status in bytes
+size_t ReadStatusField(const std::string& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string name;
+    while (status >> name)
+    {
+        if (name == field)
+        {
+            size_t kilobytes = 0;
+            status >> kilobytes;
+            return kilobytes * 1024;
+        }
+        status.ignore(4096, '\n');
+    }
+    return 0;
+}
+
+} // namespace anonymous
+
+/// @cond GlobalAllocationReplacement
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try { return Allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try { return Allocate(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* pointer) noexcept { Deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { Deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Deallocate(pointer); }
+/// @endcond
+
+namespace Kvs { namespace Test {
+
+void AllocationCounter::Enable(bool enabled)
+{
+    Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+AllocationCounter::Stats AllocationCounter::Snapshot()
+{
+    Stats stats;
+    stats.liveBytes = LiveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = PeakBytes.load(std::memory_order_relaxed);
+    stats.allocations = Allocations.load(std::memory_order_relaxed);
+    stats.frees = Frees.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AllocationCounter::ResetPeak()
+{
+    PeakBytes.store(LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+size_t ResidentSetSize::Current()
+{
+    return ReadStatusField("VmRSS:");
+}
+
+size_t ResidentSetSize::Peak()
+{
+    return ReadStatusField("VmHWM:");
+}
+
+bool ResidentSetSize::ResetPeak()
+{
+    malloc_trim(0);
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5" << std::flush;
+    return static_cast<bool>(clearRefs);
+}
+
+} } // namespace Kvs::Test
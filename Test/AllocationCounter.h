@@ -0,0 +1,60 @@
+/// @file
+/// @brief Defines the Kvs::Test::AllocationCounter and Kvs::Test::ResidentSetSize classes
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kvs { namespace Test {
+
+/// @brief Counts heap allocations made through the global operator new
+/// The global operator new/delete are replaced in AllocationCounter.cpp,
+/// so linking that file is all it takes. Counting is off until enabled and
+/// costs a single relaxed load per allocation while off.
+/// Bytes are the usable size malloc actually handed out, so allocator
+/// rounding is included.
+class AllocationCounter
+{
+public:
+
+    /// @brief A snapshot of the counters
+    struct Stats
+    {
+        /// @brief Bytes allocated and not yet freed while counting
+        int64_t liveBytes;
+        /// @brief Highest liveBytes since the last ResetPeak()
+        int64_t peakBytes;
+        /// @brief Number of allocations while counting
+        uint64_t allocations;
+        /// @brief Number of frees while counting
+        uint64_t frees;
+    };
+
+    /// @brief Turns counting on or off
+    static void Enable(bool enabled);
+
+    /// @brief Returns the current counters
+    static Stats Snapshot();
+
+    /// @brief Makes the peak equal to the current live bytes
+    static void ResetPeak();
+};
+
+/// @brief Reads the resident set size of the process (Linux only)
+class ResidentSetSize
+{
+public:
+
+    /// @brief Returns the current resident set size in bytes, zero if unknown
+    static size_t Current();
+
+    /// @brief Returns the peak resident set size in bytes, zero if unknown
+    static size_t Peak();
+
+    /// @brief Returns freed heap memory to the system and resets the peak to the current size
+    /// @return false if the peak could not be reset
+    static bool ResetPeak();
+};
+
+} } // namespace Kvs::Test
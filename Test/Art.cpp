@@ -0,0 +1,135 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Workload.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+namespace // anonymous
+{
+
+using ArtStore = Kvs::KeyValueStore::Art<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::FullKeyAccessTraits, Kvs::Lock::None>;
+
+/// @brief Creates the Art store as built by Factories.h
+std::shared_ptr<ArtStore> CreateArt()
+{
+    return std::dynamic_pointer_cast<ArtStore>(Kvs::Test::Create<Kvs::Test::Art<Kvs::Lock::None>>());
+}
+
+/// @brief Makes a key from a string
+Kvs::Test::Schema::KeyType MakeKey(const std::string& text)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    memcpy(key.field, text.data(), std::min(text.size(), sizeof(key.field) - 1));
+    return key;
+}
+
+} // namespace anonymous
+
+TEST(Art, KeysThatArePrefixesOfOthers)
+{
+    auto store = CreateArt();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    const std::vector<std::string> texts = { "abcd", "ab", "abc", "a", "abd" };
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        value.field2 = i;
+        EXPECT_TRUE(store->Put(MakeKey(texts[i]), value));
+    }
+    EXPECT_EQ(store->Size(), texts.size());
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        EXPECT_TRUE(store->Get(MakeKey(texts[i]), value));
+        EXPECT_EQ(value.field2, i);
+    }
+    EXPECT_FALSE(store->Get(MakeKey("abcde"), value));
+    // a key sorts before the longer keys it is a prefix of
+    std::vector<std::string> visited;
+    store->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+        visited.push_back(key.field);
+    });
+    EXPECT_EQ(visited, std::vector<std::string>({ "a", "ab", "abc", "abcd", "abd" }));
+    EXPECT_TRUE(store->Remove(MakeKey("ab")));
+    EXPECT_FALSE(store->Get(MakeKey("ab"), value));
+    EXPECT_TRUE(store->Get(MakeKey("abc"), value));
+    EXPECT_TRUE(store->Remove(MakeKey("abc")));
+    EXPECT_TRUE(store->Get(MakeKey("abcd"), value));
+    EXPECT_EQ(store->Size(), 3);
+}
+
+TEST(Art, GrowsAndShrinksNodes)
+{
+    auto store = CreateArt();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    // one node gets a child for every character, which takes a Node256
+    std::vector<Kvs::Test::Schema::KeyType> keys;
+    for (char c = Kvs::Test::Schema::KeyType::MinCharacter; c <= Kvs::Test::Schema::KeyType::MaxCharacter; ++c)
+    {
+        keys.push_back(MakeKey(std::string("node") + c + "leaf"));
+        store->Put(keys.back(), value);
+    }
+    EXPECT_EQ(store->Size(), keys.size());
+    for (size_t removed = 0; removed < keys.size(); ++removed)
+    {
+        EXPECT_TRUE(store->Remove(keys[removed]));
+        for (size_t i = removed + 1; i < keys.size(); ++i)
+        {
+            ASSERT_TRUE(store->Get(keys[i], value));
+        }
+    }
+    EXPECT_EQ(store->Size(), 0);
+}
+
+TEST(Art, LongSharedPrefixes)
+{
+    auto store = CreateArt();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    // more shared characters than a node stores, split first past and then within them
+    const std::string shared(20, 's');
+    const std::vector<std::string> texts = { shared + "one", shared + "two", shared.substr(0, 12) + "three", shared.substr(0, 4) + "four" };
+    for (const auto& text : texts)
+    {
+        EXPECT_TRUE(store->Put(MakeKey(text), value));
+    }
+    for (const auto& text : texts)
+    {
+        EXPECT_TRUE(store->Get(MakeKey(text), value));
+    }
+    EXPECT_FALSE(store->Get(MakeKey(shared.substr(0, 10) + "sone"), value));
+    EXPECT_FALSE(store->Get(MakeKey(shared), value));
+    EXPECT_TRUE(store->Remove(MakeKey(texts[2])));
+    EXPECT_TRUE(store->Remove(MakeKey(texts[3])));
+    EXPECT_TRUE(store->Get(MakeKey(texts[0]), value));
+    EXPECT_TRUE(store->Get(MakeKey(texts[1]), value));
+    EXPECT_EQ(store->Size(), 2);
+}
+
+TEST(Art, ForEachPrefixVisitsOnlyThePrefix)
+{
+    auto store = CreateArt();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, 10000);
+    for (const auto& key : keys)
+    {
+        store->Put(key, value);
+    }
+    for (const auto& prefixText : { std::string(""), std::string("A"), std::string("QZ"), std::string(keys[0].field).substr(0, 5) })
+    {
+        std::vector<std::string> expected;
+        store->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+            if (std::string(key.field).compare(0, prefixText.size(), prefixText) == 0)
+            {
+                expected.push_back(key.field);
+            }
+        });
+        std::vector<std::string> visited;
+        store->ForEachPrefix(MakeKey(prefixText), [&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+            visited.push_back(key.field);
+        });
+        EXPECT_EQ(visited, expected) << "prefix " << prefixText;
+    }
+}
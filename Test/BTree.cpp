@@ -0,0 +1,152 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Kvs/Lock/Optimistic.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Small nodes so a few hundred keys take several levels of splits
+using SmallNodeBTree = Kvs::KeyValueStore::BTree<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::Schema::CompareKeyType, 512>;
+
+/// @brief Makes a key that sorts by the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%06zu", index);
+    return key;
+}
+
+} // namespace anonymous
+
+TEST(Optimistic, ValidateAndUpgrade)
+{
+    Kvs::Lock::Optimistic lock;
+    uint64_t version;
+    ASSERT_TRUE(lock.ReadLock(version));
+    EXPECT_TRUE(lock.Validate(version));
+    // a write in between invalidates the read and refuses the upgrade
+    lock.Lock();
+    uint64_t during;
+    EXPECT_FALSE(lock.ReadLock(during));
+    EXPECT_FALSE(lock.TryLock());
+    lock.Unlock();
+    EXPECT_FALSE(lock.Validate(version));
+    uint64_t stale = version;
+    EXPECT_FALSE(lock.Upgrade(stale));
+    ASSERT_TRUE(lock.ReadLock(version));
+    EXPECT_TRUE(lock.Upgrade(version));
+    lock.Unlock();
+}
+
+TEST(BTree, SplitsKeepOrder)
+{
+    SmallNodeBTree objectToTest;
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    const size_t Keys = 2000;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        // insert out of order
+        value.field2 = (i * 7919) % Keys;
+        EXPECT_TRUE(objectToTest.Put(MakeKey(value.field2), value));
+    }
+    EXPECT_EQ(objectToTest.Size(), Keys);
+    for (size_t i = 0; i < Keys; i += 2)
+    {
+        EXPECT_TRUE(objectToTest.Remove(MakeKey(i)));
+    }
+    EXPECT_FALSE(objectToTest.Remove(MakeKey(0)));
+    EXPECT_EQ(objectToTest.Size(), Keys / 2);
+    size_t index = 1;
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        EXPECT_EQ(key, MakeKey(index));
+        EXPECT_EQ(value.field2, index);
+        index += 2;
+    });
+    EXPECT_EQ(index, Keys + 1);
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_EQ(objectToTest.Get(MakeKey(i), value), i % 2 == 1);
+    }
+}
+
+TEST(BTree, ConcurrentPutsAndRemoves)
+{
+    SmallNodeBTree objectToTest;
+    const size_t Threads = 4;
+    const size_t KeysPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < Threads; ++thread)
+    {
+        threads.emplace_back([&, thread] {
+            Kvs::Test::Schema::ValueType value = { 3.14, thread, 'p' };
+            // interleave the threads' keys so they split the same nodes
+            for (size_t i = 0; i < KeysPerThread; ++i)
+            {
+                objectToTest.Put(MakeKey(i * Threads + thread), value);
+            }
+            for (size_t i = 0; i < KeysPerThread; i += 2)
+            {
+                EXPECT_TRUE(objectToTest.Remove(MakeKey(i * Threads + thread)));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(objectToTest.Size(), Threads * KeysPerThread / 2);
+    size_t visited = 0;
+    Kvs::Test::Schema::KeyType previous = { };
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        EXPECT_TRUE(Kvs::Test::Schema::CompareKeyType()(previous, key));
+        previous = key;
+        ++visited;
+    });
+    EXPECT_EQ(visited, Threads * KeysPerThread / 2);
+}
+
+TEST(BTree, ReadersNeverSeeTornValues)
+{
+    SmallNodeBTree objectToTest;
+    const size_t Keys = 500;
+    Kvs::Test::Schema::ValueType value = { 0.0, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value);
+    }
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        // each write makes every field agree, and grows and shrinks the tree under the readers
+        for (size_t round = 1; round <= 200; ++round)
+        {
+            Kvs::Test::Schema::ValueType written = { static_cast<double>(round), round, 'p' };
+            for (size_t i = 0; i < Keys; ++i)
+            {
+                objectToTest.Put(MakeKey(i), written);
+                objectToTest.Put(MakeKey(Keys + i), written);
+            }
+            for (size_t i = 0; i < Keys; ++i)
+            {
+                objectToTest.Remove(MakeKey(Keys + i));
+            }
+        }
+        done = true;
+    });
+    size_t torn = 0;
+    while (!done)
+    {
+        Kvs::Test::Schema::ValueType read;
+        for (size_t i = 0; i < Keys; ++i)
+        {
+            EXPECT_TRUE(objectToTest.Get(MakeKey(i), read));
+            torn += read.field1 != static_cast<double>(read.field2);
+        }
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(objectToTest.Size(), Keys);
+}
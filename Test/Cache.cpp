@@ -0,0 +1,196 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+using Hash = Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>;
+using Entry = Kvs::KeyValueStore::CacheEntry<Kvs::Test::Schema::ValueType>;
+
+/// @brief A cache over a single-threaded store with the provided eviction policy
+template <typename EvictionPolicy>
+using CacheStore = Kvs::KeyValueStore::Cache<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Hash, EvictionPolicy, Kvs::Lock::None>;
+
+/// @brief Creates a cache of the provided capacity over a single-threaded store
+template <typename EvictionPolicy>
+std::unique_ptr<CacheStore<EvictionPolicy>> MakeCache(size_t capacity)
+{
+    return std::unique_ptr<CacheStore<EvictionPolicy>>(new CacheStore<EvictionPolicy>(
+        std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Entry, Hash, Kvs::Lock::None>>(), capacity));
+}
+
+/// @brief Makes a key from the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%06zu", index);
+    return key;
+}
+
+/// @brief Puts the keys of the provided indexes
+template <typename CacheType>
+void PutKeys(CacheType& cache, size_t first, size_t last)
+{
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = first; i < last; ++i)
+    {
+        value.field2 = i;
+        cache.Put(MakeKey(i), value);
+    }
+}
+
+/// @brief Gets the keys of the provided indexes
+template <typename CacheType>
+void GetKeys(const CacheType& cache, size_t first, size_t last)
+{
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = first; i < last; ++i)
+    {
+        cache.Get(MakeKey(i), value);
+    }
+}
+
+} // namespace anonymous
+
+template<typename EvictionPolicy>
+class CacheFixture : public ::testing::Test { };
+
+typedef ::testing::Types<
+    Kvs::Eviction::Clock,
+    Kvs::Eviction::SegmentedLru,
+    Kvs::Eviction::S3Fifo
+> EvictionPolicies;
+
+TYPED_TEST_CASE(CacheFixture, EvictionPolicies);
+
+TYPED_TEST(CacheFixture, NeverHoldsMoreThanCapacity)
+{
+    auto objectToTest = MakeCache<TypeParam>(100);
+    PutKeys(*objectToTest, 0, 1000);
+    EXPECT_EQ(objectToTest->Size(), 100);
+    // nothing was hit, so every policy kept the newest keys
+    GetKeys(*objectToTest, 0, 1000);
+    auto stats = objectToTest->GetStats();
+    EXPECT_EQ(stats.hits, 100);
+    EXPECT_EQ(stats.misses, 900);
+    EXPECT_EQ(stats.evictions, 900);
+    EXPECT_DOUBLE_EQ(stats.HitRatio(), 0.1);
+    size_t visited = 0;
+    objectToTest->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        EXPECT_GE(value.field2, 900);
+        ++visited;
+    });
+    EXPECT_EQ(visited, 100);
+}
+
+TYPED_TEST(CacheFixture, RemoveAndUpdateDoNotEvict)
+{
+    auto objectToTest = MakeCache<TypeParam>(2);
+    PutKeys(*objectToTest, 0, 2);
+    ASSERT_TRUE(objectToTest->Remove(MakeKey(0)));
+    EXPECT_FALSE(objectToTest->Remove(MakeKey(0)));
+    PutKeys(*objectToTest, 2, 3);
+    PutKeys(*objectToTest, 2, 3);
+    EXPECT_EQ(objectToTest->GetStats().evictions, 0);
+    EXPECT_EQ(objectToTest->Size(), 2);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest->Get(MakeKey(1), value));
+    EXPECT_TRUE(objectToTest->Get(MakeKey(2), value));
+    EXPECT_EQ(value.field2, 2);
+}
+
+TYPED_TEST(CacheFixture, ConcurrentReadersAndWriter)
+{
+    // over a store whose readers take no lock, as the Performance suite builds it
+    const size_t Capacity = 100;
+    const size_t Keys = 1000;
+    const size_t Readers = 3;
+    Kvs::KeyValueStore::Cache<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Hash, TypeParam, Kvs::Lock::StdMutex> objectToTest(
+        std::make_shared<Kvs::KeyValueStore::Cuckoo<Kvs::Test::Schema::KeyType, Entry, Hash>>(), Capacity);
+    std::atomic<bool> done(false);
+    std::vector<size_t> reads(Readers, 0);
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < Readers; ++reader)
+    {
+        readers.emplace_back([&, reader] {
+            Kvs::Test::Schema::ValueType value;
+            for (size_t i = reader; !done; i += 7, ++reads[reader])
+            {
+                // low keys far more often, so there are hits to record
+                size_t key = (i % Keys) * (i % Keys) / Keys;
+                if (objectToTest.Get(MakeKey(key), value))
+                {
+                    EXPECT_EQ(value.field2, key);
+                }
+            }
+        });
+    }
+    for (size_t round = 0; round < 20; ++round)
+    {
+        PutKeys(objectToTest, 0, Keys);
+        EXPECT_LE(objectToTest.Size(), Capacity);
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    auto stats = objectToTest.GetStats();
+    EXPECT_EQ(stats.hits + stats.misses, reads[0] + reads[1] + reads[2]);
+    EXPECT_EQ(objectToTest.Size(), Capacity);
+}
+
+TEST(Clock, ReferencedKeysGetASecondChance)
+{
+    auto objectToTest = MakeCache<Kvs::Eviction::Clock>(4);
+    PutKeys(*objectToTest, 0, 4);
+    GetKeys(*objectToTest, 0, 1);
+    PutKeys(*objectToTest, 4, 5);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest->Get(MakeKey(0), value));
+    EXPECT_FALSE(objectToTest->Get(MakeKey(1), value));
+}
+
+TEST(SegmentedLru, HitKeysSurviveAScan)
+{
+    auto objectToTest = MakeCache<Kvs::Eviction::SegmentedLru>(10);
+    PutKeys(*objectToTest, 0, 5);
+    GetKeys(*objectToTest, 0, 5);
+    PutKeys(*objectToTest, 100, 200);
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Get(MakeKey(i), value));
+    }
+}
+
+TEST(S3Fifo, HitKeysSurviveAScan)
+{
+    auto objectToTest = MakeCache<Kvs::Eviction::S3Fifo>(10);
+    PutKeys(*objectToTest, 0, 5);
+    GetKeys(*objectToTest, 0, 5);
+    PutKeys(*objectToTest, 100, 200);
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Get(MakeKey(i), value));
+    }
+}
+
+TEST(S3Fifo, KeysBackFromTheGhostQueueSkipTheSmallQueue)
+{
+    auto objectToTest = MakeCache<Kvs::Eviction::S3Fifo>(10);
+    PutKeys(*objectToTest, 0, 1);
+    PutKeys(*objectToTest, 100, 110);
+    Kvs::Test::Schema::ValueType value;
+    ASSERT_FALSE(objectToTest->Get(MakeKey(0), value));
+    // evicted without a hit, then put again soon after: into the main queue, which a scan does not reach
+    PutKeys(*objectToTest, 0, 1);
+    PutKeys(*objectToTest, 200, 300);
+    EXPECT_TRUE(objectToTest->Get(MakeKey(0), value));
+}
@@ -42,12 +42,32 @@ typedef ::testing::Types<
     Kvs::Test::Compound_ArrayTable_GnuTrie<Kvs::Lock::None>,
     Kvs::Test::Compound_ArrayTable_GnuCcHashTable<Kvs::Lock::None>,
     Kvs::Test::Compound_ArrayTable_GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_Art<Kvs::Lock::None>,
     Kvs::Test::Compound_GnuTrie_StdMap<Kvs::Lock::None>,
     Kvs::Test::Compound_GnuTrie_StdUnorderedMap<Kvs::Lock::None>,
     Kvs::Test::Compound_GnuTrie_GnuTree<Kvs::Lock::None>,
     Kvs::Test::Compound_GnuTrie_GnuTrie<Kvs::Lock::None>,
     Kvs::Test::Compound_GnuTrie_GnuCcHashTable<Kvs::Lock::None>,
-    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::None>
+    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Stats_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Stats_Compound_ArrayTable_StdMap<Kvs::Lock::None>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_EpochHashTable_EpochHashTable<Kvs::Lock::None>,
+    Kvs::Test::Rcu_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Mvcc<Kvs::Lock::None>,
+    Kvs::Test::SkipList<Kvs::Lock::None>,
+    Kvs::Test::Art<Kvs::Lock::None>,
+    Kvs::Test::BTree<Kvs::Lock::None>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>,
+    Kvs::Test::RobinHood<Kvs::Lock::None>,
+    Kvs::Test::Hopscotch<Kvs::Lock::None>,
+    Kvs::Test::Expiring_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Lsm_StdMap<Kvs::Lock::None>,
+    Kvs::Test::BlockedBloom_Compound_ArrayTable_StdMap<Kvs::Lock::None>,
+    Kvs::Test::CountingBloom_Compound_ArrayTable_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_Art<Kvs::Lock::None>
 > KeyValueStoreTypes;
 
 TYPED_TEST_CASE(CorrectnessFixture, KeyValueStoreTypes);
@@ -84,6 +104,63 @@ TYPED_TEST(CorrectnessFixture, PutOverwrite)
     EXPECT_EQ(value, overwrittenValue);
 }
 
+TYPED_TEST(CorrectnessFixture, PutMove)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType actualValue = { 3.14, 3, 'p' };
+    Kvs::Test::Schema::ValueType movedValue = actualValue;
+    EXPECT_TRUE(objectToTest.Put(Kvs::Test::Schema::KeyType(actualKey), std::move(movedValue)));
+    Kvs::Test::Schema::ValueType overwrittenValue = { 3.15, 4, 'q' };
+    movedValue = overwrittenValue;
+    EXPECT_TRUE(objectToTest.Put(Kvs::Test::Schema::KeyType(actualKey), std::move(movedValue)));
+    EXPECT_EQ(objectToTest.Size(), 1);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value, overwrittenValue);
+}
+
+TYPED_TEST(CorrectnessFixture, Emplace)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType actualValue = { 3.14, 3, 'p' };
+    EXPECT_TRUE(objectToTest.Emplace(actualKey, actualValue));
+    EXPECT_EQ(objectToTest.Size(), 1);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value, actualValue);
+}
+
+TYPED_TEST(CorrectnessFixture, GetByCharacters)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType actualValue = { 3.14, 3, 'p' };
+    EXPECT_TRUE(objectToTest.Put(actualKey, actualValue));
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(std::string_view("test"), value));
+    EXPECT_EQ(value, actualValue);
+    EXPECT_FALSE(objectToTest.Get(std::string_view("tes"), value));
+    EXPECT_FALSE(objectToTest.Get(std::string_view("test1"), value));
+}
+
+TYPED_TEST(CorrectnessFixture, Contains)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::KeyType otherKey = { "tesu" };
+    Kvs::Test::Schema::ValueType actualValue = { 3.14, 3, 'p' };
+    EXPECT_TRUE(objectToTest.Put(actualKey, actualValue));
+    EXPECT_TRUE(objectToTest.Contains(actualKey));
+    EXPECT_FALSE(objectToTest.Contains(otherKey));
+    EXPECT_TRUE(objectToTest.Contains(std::string_view("test")));
+    EXPECT_FALSE(objectToTest.Contains(std::string_view("tesu")));
+    EXPECT_TRUE(objectToTest.Remove(actualKey));
+    EXPECT_FALSE(objectToTest.Contains(actualKey));
+    EXPECT_FALSE(objectToTest.Contains(std::string_view("test")));
+}
+
 TYPED_TEST(CorrectnessFixture, RemoveSuccess)
 {
     auto& objectToTest = *(this->m_KeyValueStore);
@@ -162,4 +239,113 @@ TYPED_TEST(CorrectnessFixture, Transform)
 }
 
 
+TYPED_TEST(CorrectnessFixture, Upsert)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    auto increment = [](Kvs::Test::Schema::ValueType& value, bool found)
+        {
+            value.field2 += found ? 10 : 1;
+            return true;
+        };
+    EXPECT_TRUE(objectToTest.Upsert(actualKey, increment));
+    EXPECT_TRUE(objectToTest.Upsert(actualKey, increment));
+    EXPECT_EQ(objectToTest.Size(), 1);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value.field1, 0.0);
+    EXPECT_EQ(value.field2, 11);
+    EXPECT_EQ(value.field3, 0);
+}
+
+TYPED_TEST(CorrectnessFixture, UpsertDeclined)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey1 = { "test1" };
+    Kvs::Test::Schema::KeyType actualKey2 = { "test2" };
+    Kvs::Test::Schema::ValueType originalValue = { 3.14, 3, 'p' };
+    EXPECT_TRUE(objectToTest.Put(actualKey1, originalValue));
+    auto decline = [](Kvs::Test::Schema::ValueType& value, bool)
+        {
+            value.field2 = 42;
+            return false;
+        };
+    EXPECT_FALSE(objectToTest.Upsert(actualKey1, decline));
+    EXPECT_FALSE(objectToTest.Upsert(actualKey2, decline));
+    EXPECT_EQ(objectToTest.Size(), 1);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey1, value));
+    EXPECT_EQ(value, originalValue);
+    EXPECT_FALSE(objectToTest.Get(actualKey2, value));
+}
+
+TYPED_TEST(CorrectnessFixture, CompareAndSwap)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType originalValue = { };
+    originalValue.field1 = 3.14;
+    Kvs::Test::Schema::ValueType desiredValue = { };
+    desiredValue.field1 = 3.15;
+    EXPECT_FALSE(objectToTest.CompareAndSwap(actualKey, originalValue, desiredValue));
+    EXPECT_EQ(objectToTest.Size(), 0);
+    EXPECT_TRUE(objectToTest.Put(actualKey, originalValue));
+    EXPECT_TRUE(objectToTest.CompareAndSwap(actualKey, originalValue, desiredValue));
+    EXPECT_FALSE(objectToTest.CompareAndSwap(actualKey, originalValue, originalValue));
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value, desiredValue);
+}
+
+TYPED_TEST(CorrectnessFixture, GetOrInsert)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType originalValue = { 3.14, 3, 'p' };
+    Kvs::Test::Schema::ValueType value = originalValue;
+    EXPECT_TRUE(objectToTest.GetOrInsert(actualKey, value));
+    Kvs::Test::Schema::ValueType otherValue = { 3.15, 4, 'q' };
+    value = otherValue;
+    EXPECT_FALSE(objectToTest.GetOrInsert(actualKey, value));
+    EXPECT_EQ(value, originalValue);
+    EXPECT_EQ(objectToTest.Size(), 1);
+}
+
+TYPED_TEST(CorrectnessFixture, Exchange)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType originalValue = { 3.14, 3, 'p' };
+    Kvs::Test::Schema::ValueType overwrittenValue = { 3.15, 4, 'q' };
+    Kvs::Test::Schema::ValueType previous;
+    EXPECT_FALSE(objectToTest.Exchange(actualKey, originalValue, previous));
+    EXPECT_TRUE(objectToTest.Exchange(actualKey, overwrittenValue, previous));
+    EXPECT_EQ(previous, originalValue);
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value, overwrittenValue);
+}
+
+TYPED_TEST(CorrectnessFixture, Merge)
+{
+    auto& objectToTest = *(this->m_KeyValueStore);
+    Kvs::Test::Schema::KeyType actualKey = { "test" };
+    Kvs::Test::Schema::ValueType operand = { 1.5, 2, 1 };
+    EXPECT_FALSE(objectToTest.Merge(actualKey, operand));
+    objectToTest.SetMergeOperator([](Kvs::Test::Schema::ValueType& value, const Kvs::Test::Schema::ValueType& operand)
+        {
+            value.field1 += operand.field1;
+            value.field2 += operand.field2;
+            value.field3 += operand.field3;
+        } );
+    EXPECT_TRUE(objectToTest.Merge(actualKey, operand));
+    EXPECT_TRUE(objectToTest.Merge(actualKey, operand));
+    EXPECT_TRUE(objectToTest.Merge(actualKey, operand));
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(objectToTest.Get(actualKey, value));
+    EXPECT_EQ(value.field1, 4.5);
+    EXPECT_EQ(value.field2, 6);
+    EXPECT_EQ(value.field3, 3);
+}
+
 } // namespace anonymous
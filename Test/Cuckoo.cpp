@@ -0,0 +1,118 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+using CuckooStore = Kvs::KeyValueStore::Cuckoo<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>>;
+
+/// @brief Makes a key from the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%06zu", index);
+    return key;
+}
+
+} // namespace anonymous
+
+TEST(Cuckoo, FillsPastNinetyPercentBeforeGrowing)
+{
+    CuckooStore objectToTest(1024);
+    const size_t capacity = objectToTest.Capacity();
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    size_t index = 0;
+    while (objectToTest.Capacity() == capacity)
+    {
+        value.field2 = index;
+        ASSERT_TRUE(objectToTest.Put(MakeKey(index++), value));
+    }
+    // the key that made it grow went in after growing
+    EXPECT_GT(index - 1, capacity * 9 / 10);
+    EXPECT_EQ(objectToTest.Size(), index);
+    for (size_t i = 0; i < index; ++i)
+    {
+        ASSERT_TRUE(objectToTest.Get(MakeKey(i), value));
+        EXPECT_EQ(value.field2, i);
+    }
+}
+
+TEST(Cuckoo, ConcurrentPutsAndRemoves)
+{
+    CuckooStore objectToTest(1);
+    const size_t Threads = 4;
+    const size_t KeysPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < Threads; ++thread)
+    {
+        threads.emplace_back([&, thread] {
+            Kvs::Test::Schema::ValueType value = { 3.14, thread, 'p' };
+            // starting from one bucket, so the threads' keys keep making room and growing the table
+            for (size_t i = 0; i < KeysPerThread; ++i)
+            {
+                objectToTest.Put(MakeKey(i * Threads + thread), value);
+            }
+            for (size_t i = 0; i < KeysPerThread; i += 2)
+            {
+                EXPECT_TRUE(objectToTest.Remove(MakeKey(i * Threads + thread)));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(objectToTest.Size(), Threads * KeysPerThread / 2);
+    size_t visited = 0;
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        ++visited;
+    });
+    EXPECT_EQ(visited, Threads * KeysPerThread / 2);
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; i < Threads * KeysPerThread; ++i)
+    {
+        EXPECT_EQ(objectToTest.Get(MakeKey(i), value), (i / Threads) % 2 == 1);
+    }
+}
+
+TEST(Cuckoo, ReadersNeverSeeTornValues)
+{
+    CuckooStore objectToTest(1);
+    const size_t Keys = 500;
+    Kvs::Test::Schema::ValueType value = { 0.0, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value);
+    }
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        // each write makes every field agree, and moves keys around and grows the table under the readers
+        for (size_t round = 1; round <= 200; ++round)
+        {
+            Kvs::Test::Schema::ValueType written = { static_cast<double>(round), round, 'p' };
+            for (size_t i = 0; i < Keys; ++i)
+            {
+                objectToTest.Put(MakeKey(i), written);
+                objectToTest.Put(MakeKey(round * Keys + i), written);
+            }
+        }
+        done = true;
+    });
+    size_t torn = 0;
+    while (!done)
+    {
+        Kvs::Test::Schema::ValueType read;
+        for (size_t i = 0; i < Keys; ++i)
+        {
+            EXPECT_TRUE(objectToTest.Get(MakeKey(i), read));
+            torn += read.field1 != static_cast<double>(read.field2);
+        }
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(objectToTest.Size(), Keys * 201);
+}
@@ -0,0 +1,270 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Random.h"
+#include "Kvs/Expiry/Reaper.h"
+#include "Kvs/Log2Histogram.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief A clock that only moves when told to, so expiry can be tested without sleeping
+struct ManualClock
+{
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<ManualClock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now()
+    {
+        return time_point(duration(Now.load(std::memory_order_relaxed)));
+    }
+
+    /// @brief Moves the clock forward
+    static void Advance(duration elapsed)
+    {
+        Now.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    }
+
+    /// @brief The current time since the clock's epoch, in nanoseconds
+    static std::atomic<rep> Now;
+};
+
+std::atomic<ManualClock::rep> ManualClock::Now(0);
+
+using Hash = Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>;
+using Entry = Kvs::KeyValueStore::ExpiringEntry<Kvs::Test::Schema::ValueType>;
+
+/// @brief An expiring store over a single-threaded store, on the manual clock
+using ExpiringStore = Kvs::KeyValueStore::Expiring<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Lock::None, ManualClock>;
+
+/// @brief An expiring store over a thread-safe store, on the manual clock
+using SharedExpiringStore = Kvs::KeyValueStore::Expiring<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Lock::StdMutex, ManualClock>;
+
+/// @brief Keys that expire in the reaping benchmark, and keys that never do
+const size_t ExpiringKeys = 1 << 20;
+const size_t LiveKeys = 1 << 14;
+
+/// @brief The reaping benchmark's keys expire evenly over this long, and are reaped this often
+const std::chrono::milliseconds ExpiryPeriod(1000);
+const std::chrono::milliseconds ReapInterval(10);
+
+/// @brief Makes a key from the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%07zu", index);
+    return key;
+}
+
+/// @brief Creates an expiring store over a single-threaded store
+std::unique_ptr<ExpiringStore> MakeStore()
+{
+    return std::unique_ptr<ExpiringStore>(new ExpiringStore(
+        std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Entry, Hash, Kvs::Lock::None>>()));
+}
+
+/// @brief Returns whether the store holds the key of the provided index
+bool Has(const Kvs::Test::Schema::KeyValueStoreType& store, size_t index)
+{
+    Kvs::Test::Schema::ValueType value;
+    return store.Get(MakeKey(index), value);
+}
+
+/// @brief Gets live keys until stopped, timing every Get()
+Kvs::Log2Histogram TimeGets(const Kvs::Test::Schema::KeyValueStoreType& store, const std::atomic<bool>& stopped)
+{
+    Kvs::Log2Histogram latency;
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; !stopped.load(std::memory_order_relaxed); ++i)
+    {
+        auto key = MakeKey(ExpiringKeys + i % LiveKeys);
+        auto start = std::chrono::steady_clock::now();
+        store.Get(key, value);
+        latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    return latency;
+}
+
+} // namespace anonymous
+
+TEST(TimerWheel, FiresEveryTimerAtItsTick)
+{
+    // either side of every level's turn, and past the top level
+    std::vector<uint64_t> deadlines = { 1, 2, 63, 64, 65, 100, 4095, 4096, 4097, 262143, 262144, 300000,
+        (1 << 24) - 1, 1 << 24, (1 << 24) + 5, (1 << 25) + 77 };
+    Kvs::Expiry::TimerWheel<size_t> objectToTest;
+    for (size_t i = 0; i < deadlines.size(); ++i)
+    {
+        objectToTest.Schedule(i, deadlines[i]);
+    }
+    std::vector<Kvs::Expiry::TimerWheel<size_t>::Timer> due;
+    for (size_t i = 0; i < deadlines.size(); ++i)
+    {
+        objectToTest.Advance(deadlines[i] - 1, due);
+        EXPECT_TRUE(due.empty()) << "before " << deadlines[i];
+        objectToTest.Advance(deadlines[i], due);
+        ASSERT_EQ(due.size(), 1) << "at " << deadlines[i];
+        EXPECT_EQ(due[0].key, i);
+        due.clear();
+    }
+    EXPECT_EQ(objectToTest.Size(), 0);
+}
+
+TEST(TimerWheel, AdvancingFarFiresEverythingDue)
+{
+    const uint64_t Horizon = uint64_t(1) << 26;
+    Kvs::Test::XorShift random(1234);
+    Kvs::Expiry::TimerWheel<size_t> objectToTest;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        objectToTest.Schedule(i, random.Next(2 * Horizon));
+    }
+    std::vector<Kvs::Expiry::TimerWheel<size_t>::Timer> due;
+    objectToTest.Advance(Horizon, due);
+    EXPECT_EQ(due.size() + objectToTest.Size(), 10000);
+    for (const auto& timer : due)
+    {
+        EXPECT_LE(timer.deadline, Horizon);
+    }
+    // one due already fires on the next advance, even without moving
+    objectToTest.Schedule(10000, Horizon - 1);
+    due.clear();
+    objectToTest.Advance(Horizon, due);
+    ASSERT_EQ(due.size(), 1);
+    EXPECT_EQ(due[0].key, 10000);
+    objectToTest.Advance(2 * Horizon, due);
+    EXPECT_EQ(objectToTest.Size(), 0);
+}
+
+TEST(Expiring, ExpiredKeysAreHiddenUntilReaped)
+{
+    auto objectToTest = MakeStore();
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    ASSERT_TRUE(objectToTest->Put(MakeKey(0), value, std::chrono::milliseconds(10)));
+    ASSERT_TRUE(objectToTest->Put(MakeKey(1), value));
+    ManualClock::Advance(std::chrono::milliseconds(9));
+    EXPECT_TRUE(Has(*objectToTest, 0));
+    EXPECT_EQ(objectToTest->Reap(), 0);
+    ManualClock::Advance(std::chrono::milliseconds(1));
+    EXPECT_FALSE(Has(*objectToTest, 0));
+    EXPECT_TRUE(Has(*objectToTest, 1));
+    EXPECT_EQ(objectToTest->Size(), 2);
+    size_t visited = 0;
+    objectToTest->ForEach([&] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType&) { ++visited; });
+    EXPECT_EQ(visited, 1);
+    EXPECT_EQ(objectToTest->Reap(), 1);
+    EXPECT_EQ(objectToTest->Size(), 1);
+    EXPECT_EQ(objectToTest->GetTimerCount(), 0);
+}
+
+TEST(Expiring, PutAgainOrRemovedKeysOutliveTheirOldTimers)
+{
+    auto objectToTest = MakeStore();
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    // a longer time to live, none at all, and removed then put with a longer one
+    objectToTest->Put(MakeKey(0), value, std::chrono::milliseconds(10));
+    objectToTest->Put(MakeKey(0), value, std::chrono::milliseconds(100));
+    objectToTest->Put(MakeKey(1), value, std::chrono::milliseconds(10));
+    objectToTest->Put(MakeKey(1), value);
+    objectToTest->Put(MakeKey(2), value, std::chrono::milliseconds(10));
+    objectToTest->Remove(MakeKey(2));
+    objectToTest->Put(MakeKey(2), value, std::chrono::milliseconds(50));
+    ManualClock::Advance(std::chrono::milliseconds(20));
+    EXPECT_EQ(objectToTest->Reap(), 0);
+    EXPECT_EQ(objectToTest->Size(), 3);
+    EXPECT_EQ(objectToTest->GetTimerCount(), 2);
+    ManualClock::Advance(std::chrono::milliseconds(40));
+    EXPECT_EQ(objectToTest->Reap(), 1);
+    EXPECT_FALSE(Has(*objectToTest, 2));
+    ManualClock::Advance(std::chrono::milliseconds(50));
+    EXPECT_EQ(objectToTest->Reap(), 1);
+    EXPECT_FALSE(Has(*objectToTest, 0));
+    EXPECT_TRUE(Has(*objectToTest, 1));
+}
+
+TEST(Expiring, ReaperThreadRemovesExpiredKeys)
+{
+    const size_t Keys = 1000;
+    auto objectToTest = std::make_shared<Kvs::KeyValueStore::Expiring<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Lock::StdMutex>>(
+        std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Entry, Hash, Kvs::Lock::StdMutex>>());
+    Kvs::Expiry::Reaper<decltype(objectToTest)::element_type> reaper(objectToTest, std::chrono::milliseconds(5));
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        objectToTest->Put(MakeKey(i), value, std::chrono::milliseconds(20));
+    }
+    auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (reaper.GetReaped() < Keys && std::chrono::steady_clock::now() < giveUp)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(reaper.GetReaped(), Keys);
+    EXPECT_EQ(objectToTest->Size(), 0);
+}
+
+TEST(Expiring, ReapThroughputAndGetLatency)
+{
+    // a million keys expiring evenly over ExpiryPeriod, reaped every ReapInterval,
+    // while another thread times Get()s of keys that never expire
+    SharedExpiringStore objectToTest(
+        std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Entry, Hash, Kvs::Lock::StdMutex>>());
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ExpiringKeys; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value, ExpiryPeriod * (i + 1) / ExpiringKeys);
+    }
+    const double putSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (size_t i = ExpiringKeys; i < ExpiringKeys + LiveKeys; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value);
+    }
+    // what finding the expired keys without a wheel would cost every ReapInterval
+    const auto scanStart = std::chrono::steady_clock::now();
+    size_t scanned = 0;
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType&) { ++scanned; });
+    const double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+
+    std::atomic<bool> stopped(false);
+    Kvs::Log2Histogram idle;
+    std::thread reader([&] { idle = TimeGets(objectToTest, stopped); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    stopped = true;
+    reader.join();
+
+    stopped = false;
+    Kvs::Log2Histogram reaping;
+    reader = std::thread([&] { reaping = TimeGets(objectToTest, stopped); });
+    size_t reaped = 0;
+    std::chrono::nanoseconds reapTime(0);
+    for (auto elapsed = ReapInterval; elapsed <= ExpiryPeriod; elapsed += ReapInterval)
+    {
+        ManualClock::Advance(ReapInterval);
+        auto reapStart = std::chrono::steady_clock::now();
+        reaped += objectToTest.Reap();
+        reapTime += std::chrono::steady_clock::now() - reapStart;
+    }
+    stopped = true;
+    reader.join();
+    EXPECT_EQ(reaped, ExpiringKeys);
+    EXPECT_EQ(objectToTest.Size(), LiveKeys);
+
+    const double reapSeconds = std::chrono::duration<double>(reapTime).count();
+    GTEST_COUT << "put " << static_cast<size_t>(ExpiringKeys / putSeconds) << " keys/s with a time to live, reaped "
+               << static_cast<size_t>(reaped / reapSeconds) << " keys/s in " << reapTime.count() / 1000000 << " ms" << std::endl;
+    GTEST_COUT << "scanning all " << scanned << " keys once instead takes " << static_cast<size_t>(scanSeconds * 1000)
+               << " ms, " << (ExpiryPeriod / ReapInterval) << " scans over the same period" << std::endl;
+    GTEST_COUT << "Get p50/p99/max < " << idle.Percentile(50) << "/" << idle.Percentile(99) << "/" << idle.Percentile(100)
+               << " ns idle, " << reaping.Percentile(50) << "/" << reaping.Percentile(99) << "/" << reaping.Percentile(100)
+               << " ns while reaping" << std::endl;
+}
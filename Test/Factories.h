@@ -8,8 +8,11 @@
 #include "Kvs/Lock/None.h"
 #include "Kvs/Lock/Spin.h"
 #include "Kvs/Lock/StdMutex.h"
+#include "Kvs/Lock/Instrumented.h"
+#include "Kvs/Lock/EpochReaders.h"
 #include "Kvs/Hash/Jenkins.h"
 #include "Kvs/Hash/FirstByte.h"
+#include "Kvs/Hash/Murmur.h"
 #include "Kvs/KeyValueStore/StdMap.h"
 #include "Kvs/KeyValueStore/StdUnorderedMap.h"
 #include "Kvs/KeyValueStore/Compound.h"
@@ -18,18 +21,60 @@
 #include "Kvs/KeyValueStore/GnuTree.h"
 #include "Kvs/KeyValueStore/GnuCcHashTable.h"
 #include "Kvs/KeyValueStore/GnuGpHashTable.h"
+#include "Kvs/KeyValueStore/EpochHashTable.h"
+#include "Kvs/KeyValueStore/Rcu.h"
+#include "Kvs/KeyValueStore/Mvcc.h"
+#include "Kvs/KeyValueStore/SkipList.h"
+#include "Kvs/KeyValueStore/Art.h"
+#include "Kvs/KeyValueStore/BTree.h"
+#include "Kvs/KeyValueStore/Cuckoo.h"
+#include "Kvs/KeyValueStore/RobinHood.h"
+#include "Kvs/KeyValueStore/Hopscotch.h"
+#include "Kvs/KeyValueStore/Cache.h"
+#include "Kvs/Eviction/Clock.h"
+#include "Kvs/Eviction/SegmentedLru.h"
+#include "Kvs/Eviction/S3Fifo.h"
+#include "Kvs/KeyValueStore/Expiring.h"
+#include "Kvs/KeyValueStore/Lsm.h"
+#include "Kvs/KeyValueStore/Filtered.h"
+#include "Kvs/Filter/BlockedBloom.h"
+#include "Kvs/Filter/CountingBloom.h"
+#include "Kvs/KeyValueStore/NoOp.h"
+#include "Kvs/KeyValueStore/Statistics.h"
 #include "KeyAccessTraits.h"
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
 
 namespace Kvs { namespace Test {
 
 /// (arguably) Simplier-to-read definitions for more complex key->value stores
 /// @{
+template <typename LockType> struct NoOp {};
 template <typename LockType> struct StdMap {};
 template <typename LockType> struct StdUnorderedMap {};
 template <typename LockType> struct GnuTree {};
 template <typename LockType> struct GnuTrie {};
 template <typename LockType> struct GnuCcHashTable {};
 template <typename LockType> struct GnuGpHashTable {};
+template <typename LockType> struct EpochHashTable {};
+template <typename LockType> struct Rcu_StdUnorderedMap {};
+template <typename LockType> struct Mvcc {};
+template <typename LockType> struct SkipList {};
+template <typename LockType> struct Art {};
+template <typename LockType> struct BTree {};
+template <typename LockType> struct Cuckoo {};
+template <typename LockType> struct RobinHood {};
+template <typename LockType> struct Hopscotch {};
+template <typename LockType> struct Cache_Clock {};
+template <typename LockType> struct Cache_SegmentedLru {};
+template <typename LockType> struct Cache_S3Fifo {};
+template <typename LockType> struct Expiring_StdUnorderedMap {};
+template <typename LockType> struct Lsm_StdMap {};
+template <typename LockType> struct BlockedBloom_Compound_ArrayTable_StdMap {};
+template <typename LockType> struct CountingBloom_Compound_ArrayTable_StdMap {};
+template <typename LockType> struct BlockedBloom_Lsm_StdMap {};
 template <typename LockType> struct Compound_StdUnorderedMap_StdMap {};
 template <typename LockType> struct Compound_StdUnorderedMap_StdUnorderedMap {};
 template <typename LockType> struct Compound_StdUnorderedMap_GnuTree {};
@@ -42,48 +87,79 @@ template <typename LockType> struct Compound_ArrayTable_GnuTree {};
 template <typename LockType> struct Compound_ArrayTable_GnuTrie {};
 template <typename LockType> struct Compound_ArrayTable_GnuCcHashTable {};
 template <typename LockType> struct Compound_ArrayTable_GnuGpHashTable {};
+template <typename LockType> struct Compound_ArrayTable_Art {};
 template <typename LockType> struct Compound_GnuTrie_StdMap {};
 template <typename LockType> struct Compound_GnuTrie_StdUnorderedMap {};
 template <typename LockType> struct Compound_GnuTrie_GnuTree {};
 template <typename LockType> struct Compound_GnuTrie_GnuTrie {};
 template <typename LockType> struct Compound_GnuTrie_GnuCcHashTable {};
 template <typename LockType> struct Compound_GnuTrie_GnuGpHashTable {};
+template <typename LockType> struct Compound_Art_StdMap {};
+template <typename LockType> struct Compound_Art_StdUnorderedMap {};
+template <typename LockType> struct Compound_Art_Art {};
+template <typename LockType> struct Compound_EpochHashTable_EpochHashTable {};
+template <typename LockType> struct Stats_StdUnorderedMap {};
+template <typename LockType> struct Stats_Compound_ArrayTable_StdMap {};
 /// @}
 
 /// @cond Factories
-auto FrontEndStdUnorderedMapFactory = []
+static auto FrontEndStdUnorderedMapFactory = []
 {
     return std::make_shared<
         Kvs::KeyValueStore::StdUnorderedMap<Schema::KeyType, Kvs::TypedKeyValueStore<Schema::KeyType, Schema::ValueType>::SharedPtr, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType, 3>, Kvs::Lock::None>
     >();
 };
 
-auto FrontEndArrayTableFactory = []
+static auto FrontEndArrayTableFactory = []
 {
     return std::make_shared<
         Kvs::KeyValueStore::ArrayTable<Schema::KeyType, Kvs::TypedKeyValueStore<Schema::KeyType, Schema::ValueType>::SharedPtr, 256, Kvs::Hash::FirstByte<Schema::KeyType>, Kvs::Lock::None>
     >();
 };
 
-auto FrontEndGnuTrieFactory = []
+static auto FrontEndEpochHashTableFactory = []
+{
+    return std::make_shared<
+        Kvs::KeyValueStore::EpochHashTable<Schema::KeyType, Kvs::TypedKeyValueStore<Schema::KeyType, Schema::ValueType>::SharedPtr, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType, 3>, Kvs::Lock::None>
+    >();
+};
+
+static auto FrontEndGnuTrieFactory = []
 {
     return std::make_shared<
         Kvs::KeyValueStore::GnuTrie<Schema::KeyType, Kvs::TypedKeyValueStore<Schema::KeyType, Schema::ValueType>::SharedPtr, KeyAccessTraits<3>, Kvs::Lock::None>
     >();
 };
 
+static auto FrontEndArtFactory = []
+{
+    return std::make_shared<
+        Kvs::KeyValueStore::Art<Schema::KeyType, Kvs::TypedKeyValueStore<Schema::KeyType, Schema::ValueType>::SharedPtr, KeyAccessTraits<3>, Kvs::Lock::None>
+    >();
+};
+
 /// @brief Generalized creation without a definition to create link errors if there is no match
 template <typename> struct Factory
 {
     static Test::Schema::KeyValueStoreSharedPtr Create();
 };
 
+template <typename LockType> struct Factory<NoOp<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::NoOp<Schema::KeyType, Schema::ValueType>
+        >();
+    }
+};
+
 template <typename LockType> struct Factory<StdMap<LockType>>
 {
     static Test::Schema::KeyValueStoreSharedPtr Create()
     {
         return std::make_shared<
-            Kvs::KeyValueStore::StdMap<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, Kvs::Lock::None>
+            Kvs::KeyValueStore::StdMap<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, LockType>
         >();
     }
 };
@@ -103,7 +179,7 @@ template <typename LockType> struct Factory<GnuTrie<LockType>>
     static Test::Schema::KeyValueStoreSharedPtr Create()
     {
         return std::make_shared<
-            Kvs::KeyValueStore::GnuTrie<Schema::KeyType, Schema::ValueType, FullKeyAccessTraits, Kvs::Lock::None>
+            Kvs::KeyValueStore::GnuTrie<Schema::KeyType, Schema::ValueType, FullKeyAccessTraits, LockType>
         >();
     }
 };
@@ -113,7 +189,7 @@ template <typename LockType> struct Factory<GnuTree<LockType>>
     static Test::Schema::KeyValueStoreSharedPtr Create()
     {
         return std::make_shared<
-            Kvs::KeyValueStore::GnuTree<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, Kvs::Lock::None>
+            Kvs::KeyValueStore::GnuTree<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, LockType>
         >();
     }
 };
@@ -123,7 +199,7 @@ template <typename LockType> struct Factory<GnuCcHashTable<LockType>>
     static Test::Schema::KeyValueStoreSharedPtr Create()
     {
         return std::make_shared<
-            Kvs::KeyValueStore::GnuCcHashTable<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, Kvs::Lock::None>
+            Kvs::KeyValueStore::GnuCcHashTable<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
         >();
     }
 };
@@ -133,11 +209,194 @@ template <typename LockType> struct Factory<GnuGpHashTable<LockType>>
     static Test::Schema::KeyValueStoreSharedPtr Create()
     {
         return std::make_shared<
-            Kvs::KeyValueStore::GnuGpHashTable<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, Kvs::Lock::None>
+            Kvs::KeyValueStore::GnuGpHashTable<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
+        >();
+    }
+};
+
+template <typename LockType> struct Factory<EpochHashTable<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::EpochHashTable<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
+        >();
+    }
+};
+
+/// @brief Each version is only ever read concurrently, so it needs no lock of its own
+template <typename LockType> struct Factory<Rcu_StdUnorderedMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Rcu<Schema::KeyType, Schema::ValueType,
+                Kvs::KeyValueStore::StdUnorderedMap<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, Kvs::Lock::None>,
+                LockType>
+        >();
+    }
+};
+
+template <typename LockType> struct Factory<Mvcc<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Mvcc<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, LockType>
+        >();
+    }
+};
+
+/// @brief LockType is the lock of each node rather than of the whole store
+template <typename LockType> struct Factory<SkipList<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::SkipList<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, LockType>
+        >();
+    }
+};
+
+template <typename LockType> struct Factory<Art<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Art<Schema::KeyType, Schema::ValueType, FullKeyAccessTraits, LockType>
+        >();
+    }
+};
+
+/// @brief Nodes carry their own optimistic locks, so LockType is unused
+template <typename LockType> struct Factory<BTree<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::BTree<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType>
         >();
     }
 };
 
+/// @brief Buckets are guarded by the store's own striped version locks, so LockType is unused
+template <typename LockType> struct Factory<Cuckoo<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Cuckoo<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>>
+        >();
+    }
+};
+
+template <typename LockType> struct Factory<RobinHood<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::RobinHood<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
+        >();
+    }
+};
+
+template <typename LockType> struct Factory<Hopscotch<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Hopscotch<Schema::KeyType, Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
+        >();
+    }
+};
+
+/// @brief Keys held by the caches built here, a tenth of the keys the Performance suite uses
+const size_t CacheCapacity = 1000;
+
+/// @brief Creates a cache over a Cuckoo store, whose readers take no lock, with LockType serializing Put() and Remove()
+template <typename EvictionPolicy, typename LockType>
+Test::Schema::KeyValueStoreSharedPtr CreateCache()
+{
+    using Hash = Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>;
+    using Entry = Kvs::KeyValueStore::CacheEntry<Schema::ValueType>;
+    return std::make_shared<
+        Kvs::KeyValueStore::Cache<Schema::KeyType, Schema::ValueType, Hash, EvictionPolicy, LockType>
+    >(std::make_shared<Kvs::KeyValueStore::Cuckoo<Schema::KeyType, Entry, Hash>>(), CacheCapacity);
+}
+
+template <typename LockType> struct Factory<Cache_Clock<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateCache<Kvs::Eviction::Clock, LockType>();
+    }
+};
+
+template <typename LockType> struct Factory<Cache_SegmentedLru<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateCache<Kvs::Eviction::SegmentedLru, LockType>();
+    }
+};
+
+template <typename LockType> struct Factory<Cache_S3Fifo<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateCache<Kvs::Eviction::S3Fifo, LockType>();
+    }
+};
+
+/// @brief Keys are put without a time to live, so this measures what expiry support costs keys that never expire
+template <typename LockType> struct Factory<Expiring_StdUnorderedMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        using Entry = Kvs::KeyValueStore::ExpiringEntry<Schema::ValueType>;
+        return std::make_shared<
+            Kvs::KeyValueStore::Expiring<Schema::KeyType, Schema::ValueType, LockType>
+        >(std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Schema::KeyType, Entry, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>>());
+    }
+};
+
+/// @brief Returns a directory of its own for the runs of an Lsm store, under TMPDIR or /tmp
+inline std::string MakeLsmDirectory()
+{
+    static std::atomic<size_t> stores(0);
+    const char* tmp = std::getenv("TMPDIR");
+    return std::string(tmp && *tmp ? tmp : "/tmp") + "/KeyValueStoreTest." + std::to_string(::getpid()) + "." + std::to_string(stores++);
+}
+
+/// @brief Keys an Lsm store built here keeps in its memtable, small enough for the suites to reach the runs on disk
+const size_t LsmMemtableKeys = 256;
+
+template <typename LockType> struct Factory<Lsm_StdMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        using Entry = Kvs::KeyValueStore::LsmEntry<Schema::ValueType>;
+        Kvs::KeyValueStore::LsmOptions options(MakeLsmDirectory());
+        options.memtableKeys = LsmMemtableKeys;
+        return std::make_shared<
+            Kvs::KeyValueStore::Lsm<Schema::KeyType, Schema::ValueType, Schema::CompareKeyType, Kvs::Hash::Jenkins::OneAtATime<Schema::KeyType>, LockType>
+        >([] { return std::make_shared<Kvs::KeyValueStore::StdMap<Schema::KeyType, Entry, Schema::CompareKeyType, LockType>>(); }, options);
+    }
+};
+
+/// @brief Keys the filters built here are sized for, more than any suite puts
+const size_t FilteredKeys = 1 << 16;
+
+/// @brief Creates a store decorated with a Filter that answers Get() of most absent keys
+/// The filter hashes with Murmur, 8 bytes at a time, to cost a miss much less than the lookup it saves
+template <typename Filter, typename LockType>
+Test::Schema::KeyValueStoreSharedPtr CreateFiltered(Test::Schema::KeyValueStoreSharedPtr keyValueStore)
+{
+    return std::make_shared<
+        Kvs::KeyValueStore::Filtered<Schema::KeyType, Schema::ValueType, Kvs::Hash::Murmur::Hash64A<Schema::KeyType>, Filter, LockType>
+    >(keyValueStore, FilteredKeys);
+}
+
 template <typename LockType> struct Factory<Compound_StdUnorderedMap_StdMap<LockType>>
 {
     static Test::Schema::KeyValueStoreSharedPtr Create()
@@ -208,6 +467,30 @@ template <typename LockType> struct Factory<Compound_ArrayTable_StdMap<LockType>
     }
 };
 
+template <typename LockType> struct Factory<BlockedBloom_Compound_ArrayTable_StdMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateFiltered<Kvs::Filter::BlockedBloom, LockType>(Factory<Compound_ArrayTable_StdMap<LockType>>::Create());
+    }
+};
+
+template <typename LockType> struct Factory<CountingBloom_Compound_ArrayTable_StdMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateFiltered<Kvs::Filter::CountingBloom, LockType>(Factory<Compound_ArrayTable_StdMap<LockType>>::Create());
+    }
+};
+
+template <typename LockType> struct Factory<BlockedBloom_Lsm_StdMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return CreateFiltered<Kvs::Filter::BlockedBloom, LockType>(Factory<Lsm_StdMap<LockType>>::Create());
+    }
+};
+
 template <typename LockType> struct Factory<Compound_ArrayTable_StdUnorderedMap<LockType>>
 {
     static Test::Schema::KeyValueStoreSharedPtr Create()
@@ -258,6 +541,16 @@ template <typename LockType> struct Factory<Compound_ArrayTable_GnuGpHashTable<L
     }
 };
 
+template <typename LockType> struct Factory<Compound_ArrayTable_Art<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, LockType>
+        >(FrontEndArrayTableFactory(), &Factory<Art<Kvs::Lock::None>>::Create);
+    }
+};
+
 template <typename LockType> struct Factory<Compound_GnuTrie_StdMap<LockType>>
 {
     static Test::Schema::KeyValueStoreSharedPtr Create()
@@ -317,6 +610,77 @@ template <typename LockType> struct Factory<Compound_GnuTrie_GnuGpHashTable<Lock
         >(FrontEndGnuTrieFactory(), &Factory<GnuGpHashTable<Kvs::Lock::None>>::Create);
     }
 };
+
+template <typename LockType> struct Factory<Compound_Art_StdMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, LockType>
+        >(FrontEndArtFactory(), &Factory<StdMap<Kvs::Lock::None>>::Create);
+    }
+};
+
+template <typename LockType> struct Factory<Compound_Art_StdUnorderedMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, LockType>
+        >(FrontEndArtFactory(), &Factory<StdUnorderedMap<Kvs::Lock::None>>::Create);
+    }
+};
+
+template <typename LockType> struct Factory<Compound_Art_Art<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, LockType>
+        >(FrontEndArtFactory(), &Factory<Art<Kvs::Lock::None>>::Create);
+    }
+};
+
+/// @brief Both ends are written only under the Compound lock and read with no lock at all
+template <typename LockType> struct Factory<Compound_EpochHashTable_EpochHashTable<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, Kvs::Lock::EpochReaders<LockType>>
+        >(FrontEndEpochHashTableFactory(), &Factory<EpochHashTable<Kvs::Lock::None>>::Create);
+    }
+};
+
+template <typename LockType> struct Factory<Stats_StdUnorderedMap<LockType>>
+{
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Statistics<Schema::KeyType, Schema::ValueType>
+        >(Factory<StdUnorderedMap<LockType>>::Create());
+    }
+};
+
+template <typename LockType> struct Factory<Stats_Compound_ArrayTable_StdMap<LockType>>
+{
+    /// @brief Back-ends are only reached under the Compound lock, so one shard each will do
+    static Test::Schema::KeyValueStoreSharedPtr CreateBackEnd()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Statistics<Schema::KeyType, Schema::ValueType>
+        >(Factory<StdMap<Kvs::Lock::None>>::Create(), 1);
+    }
+
+    static Test::Schema::KeyValueStoreSharedPtr Create()
+    {
+        return std::make_shared<
+            Kvs::KeyValueStore::Statistics<Schema::KeyType, Schema::ValueType>
+        >(std::make_shared<
+            Kvs::KeyValueStore::Compound<Schema::KeyType, Schema::ValueType, LockType>
+          >(FrontEndArrayTableFactory(), &CreateBackEnd));
+    }
+};
 /// @endcond
 
 /// @brief General-purpose creation of a provided key->value store type
@@ -0,0 +1,170 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Random.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <chrono>
+#include <vector>
+
+namespace // anonymous
+{
+
+using Hash = Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>;
+
+/// @brief Keys held by the stores the benchmark looks up, and lookups per miss ratio
+const size_t BenchmarkKeys = 1 << 16;
+const size_t BenchmarkGets = 1 << 18;
+
+/// @brief Makes a key from the provided index, whose first bytes vary so a Compound store spreads keys over its back-ends
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "%c%c%c%09zu", char('A' + index % 26), char('A' + index / 26 % 26), char('A' + index / 676 % 26), index);
+    return key;
+}
+
+/// @brief Counts the hashes of keys never added that the filter lets through, out of the provided number
+template <typename Filter>
+size_t CountFalsePositives(const Filter& filter, size_t first, size_t count)
+{
+    Hash hash;
+    size_t falsePositives = 0;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        falsePositives += filter.MayContain(hash(MakeKey(i)));
+    }
+    return falsePositives;
+}
+
+/// @brief Returns the nanoseconds per Get() of keys missing in the provided ratio, out of BenchmarkKeys present
+double TimeGets(const Kvs::Test::Schema::KeyValueStoreType& store, size_t missPercent)
+{
+    Kvs::Test::XorShift random(missPercent + 1);
+    std::vector<Kvs::Test::Schema::KeyType> keys(BenchmarkGets);
+    for (auto& key : keys)
+    {
+        // present keys are even, absent keys odd
+        key = MakeKey(2 * random.Next(BenchmarkKeys) + (random.Next(100) < missPercent));
+    }
+    // the best of a few rounds, since the first pays for faulting pages in
+    double best = 0.0;
+    for (size_t round = 0; round < 3; ++round)
+    {
+        size_t found = 0;
+        Kvs::Test::Schema::ValueType value;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& key : keys)
+        {
+            found += store.Get(key, value);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_NEAR(1.0 - double(found) / BenchmarkGets, missPercent / 100.0, 0.01);
+        best = round && best < elapsed.count() ? best : elapsed.count();
+    }
+    return best / BenchmarkGets;
+}
+
+/// @brief Prints the cost of a Get() of the store created by the factory, at 0%, 50% and 90% misses
+template <typename KeyValueStoreType>
+void Benchmark(const char* name)
+{
+    auto objectToTest = Kvs::Test::Factory<KeyValueStoreType>::Create();
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < BenchmarkKeys; ++i)
+    {
+        ASSERT_TRUE(objectToTest->Put(MakeKey(2 * i), value));
+    }
+    GTEST_COUT << name << ": ";
+    for (size_t missPercent : { 0, 50, 90 })
+    {
+        std::cout << TimeGets(*objectToTest, missPercent) << " ns/Get at " << missPercent << "% misses" << (missPercent == 90 ? "\n" : ", ");
+    }
+}
+
+} // namespace anonymous
+
+TEST(BlockedBloom, NoFalseNegativesAndFewFalsePositives)
+{
+    const size_t Keys = 10000;
+    Kvs::Filter::BlockedBloom filter(Keys, 10);
+    Hash hash;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        filter.Add(hash(MakeKey(i)));
+    }
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(filter.MayContain(hash(MakeKey(i))));
+    }
+    // about one percent is expected at ten bits per key
+    EXPECT_LT(CountFalsePositives(filter, Keys, Keys), Keys / 50);
+    EXPECT_FALSE(Kvs::Filter::BlockedBloom().MayContain(hash(MakeKey(0))));
+}
+
+TEST(CountingBloom, ForgetsRemovedHashes)
+{
+    const size_t Keys = 10000;
+    Kvs::Filter::CountingBloom filter(Keys, 10);
+    Hash hash;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        filter.Add(hash(MakeKey(i)));
+    }
+    // about three percent is expected at ten counters per key, since blocks are small
+    EXPECT_LT(CountFalsePositives(filter, Keys, Keys), Keys / 25);
+    for (size_t i = 0; i < Keys; i += 2)
+    {
+        filter.Remove(hash(MakeKey(i)));
+    }
+    for (size_t i = 1; i < Keys; i += 2)
+    {
+        EXPECT_TRUE(filter.MayContain(hash(MakeKey(i))));
+    }
+    // the removed half is rejected like keys never added, at a lower rate since the filter is half full
+    size_t falsePositives = 0;
+    for (size_t i = 0; i < Keys; i += 2)
+    {
+        falsePositives += filter.MayContain(hash(MakeKey(i)));
+    }
+    EXPECT_LT(falsePositives, Keys / 100);
+    EXPECT_FALSE(Kvs::Filter::CountingBloom().MayContain(hash(MakeKey(0))));
+}
+
+TEST(Filtered, CountingFilterRejectsRemovedKeysPutTwice)
+{
+    // statistics under the filter count the Get()s that get through it
+    using Store = Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Hash, Kvs::Lock::None>;
+    using Statistics = Kvs::KeyValueStore::Statistics<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType>;
+    const size_t Keys = 10000;
+    auto statistics = std::make_shared<Statistics>(std::make_shared<Store>());
+    Kvs::KeyValueStore::Filtered<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Hash, Kvs::Filter::CountingBloom, Kvs::Lock::None>
+        objectToTest(statistics, Keys);
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(objectToTest.Put(MakeKey(i), value));
+        EXPECT_TRUE(objectToTest.Put(MakeKey(i), value));
+    }
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(objectToTest.Remove(MakeKey(i)));
+        EXPECT_FALSE(objectToTest.Remove(MakeKey(i)));
+    }
+    const auto before = statistics->GetStats().calls[Kvs::KeyValueStore::OperationStats::Get];
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_FALSE(objectToTest.Get(MakeKey(i), value));
+    }
+    // had the second Put() of each key counted it again, every Get() would get through
+    EXPECT_EQ(statistics->GetStats().calls[Kvs::KeyValueStore::OperationStats::Get], before);
+    EXPECT_EQ(objectToTest.Size(), 0u);
+}
+
+TEST(Filtered, GetLatencyByMissRatio)
+{
+    Benchmark<Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>>("Compound_ArrayTable_StdMap");
+    Benchmark<Kvs::Test::BlockedBloom_Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>>("BlockedBloom_Compound_ArrayTable_StdMap");
+    Benchmark<Kvs::Test::CountingBloom_Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>>("CountingBloom_Compound_ArrayTable_StdMap");
+    Benchmark<Kvs::Test::Lsm_StdMap<Kvs::Lock::StdMutex>>("Lsm_StdMap");
+    Benchmark<Kvs::Test::BlockedBloom_Lsm_StdMap<Kvs::Lock::StdMutex>>("BlockedBloom_Lsm_StdMap");
+}
@@ -0,0 +1,97 @@
+/// @file
+/// @brief Defines and implements the Kvs::Test::Footprint struct and MeasureFootprint()
+
+#pragma once
+
+#include "Schema.h"
+#include "AllocationCounter.h"
+#include "Kvs/Reclaim/Epoch.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Kvs { namespace Test {
+
+/// @brief What populating a key->value store cost in memory
+struct Footprint
+{
+    /// @brief Entries held once populated (duplicate keys collapse)
+    size_t entries;
+    /// @brief Heap bytes held by the populated store, allocator rounding included
+    int64_t heapBytes;
+    /// @brief Most heap bytes held at any point while populating, e.g. during a rehash
+    int64_t peakHeapBytes;
+    /// @brief Heap allocations made while populating
+    uint64_t allocations;
+    /// @brief Growth of the peak resident set size while populating
+    size_t peakRssBytes;
+    /// @brief Whether peakRssBytes could be measured
+    bool rssAvailable;
+
+    /// @brief Heap bytes per entry
+    double BytesPerEntry() const
+    {
+        return entries ? static_cast<double>(heapBytes) / entries : 0.0;
+    }
+
+    /// @brief Heap allocations per entry
+    double AllocationsPerEntry() const
+    {
+        return entries ? static_cast<double>(allocations) / entries : 0.0;
+    }
+};
+
+/// @brief Creates a store, puts the first count keys and measures the memory it took
+/// @note Single-threaded; the counters are process-wide so nothing else may allocate meanwhile.
+/// Whatever earlier stores left to Reclaim::Epoch is freed first, or a store that
+/// collects while populating would be credited with freeing it.
+template <typename CreateFunction>
+Footprint MeasureFootprint(CreateFunction create, const std::vector<Schema::KeyType>& keys, size_t count)
+{
+    Footprint footprint = Footprint();
+    Reclaim::Epoch::Synchronize();
+    footprint.rssAvailable = ResidentSetSize::ResetPeak();
+    size_t rssBefore = ResidentSetSize::Current();
+    AllocationCounter::ResetPeak();
+    AllocationCounter::Enable(true);
+    auto before = AllocationCounter::Snapshot();
+    {
+        auto store = std::dynamic_pointer_cast<Schema::KeyValueStoreType>(create());
+        Schema::ValueType value = Schema::ValueType();
+        for (size_t keyIndex = 0; keyIndex < count && keyIndex < keys.size(); ++keyIndex)
+        {
+            store->Put(keys[keyIndex], value);
+        }
+        auto after = AllocationCounter::Snapshot();
+        footprint.entries = store->Size();
+        footprint.heapBytes = after.liveBytes - before.liveBytes;
+        footprint.peakHeapBytes = after.peakBytes - before.liveBytes;
+        footprint.allocations = after.allocations - before.allocations;
+        size_t rssPeak = ResidentSetSize::Peak();
+        footprint.peakRssBytes = rssPeak > rssBefore ? rssPeak - rssBefore : 0;
+        footprint.rssAvailable = footprint.rssAvailable && rssPeak != 0;
+    }
+    AllocationCounter::Enable(false);
+    return footprint;
+}
+
+/// @brief Returns the name of the stand-alone store matching a Compound store's back-end
+/// e.g. "Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::None>" gives "Kvs::Test::StdMap<Kvs::Lock::None>"
+/// @return empty if the provided name is not a Compound store
+inline std::string CompoundBackEndName(const std::string& storeType)
+{
+    const std::string compound = "Compound_";
+    auto position = storeType.find(compound);
+    if (position == std::string::npos)
+    {
+        return std::string();
+    }
+    auto separator = storeType.find('_', position + compound.size());
+    if (separator == std::string::npos)
+    {
+        return std::string();
+    }
+    return storeType.substr(0, position) + storeType.substr(separator + 1);
+}
+
+} } // namespace Kvs::Test
@@ -0,0 +1,107 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "AllocationCounter.h"
+#include "Workload.h"
+#include "Kvs/KeyValueStore/Frozen.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Creates a store of the provided type holding the provided keys, each valued by its index
+template <typename StoreType>
+Kvs::Test::Schema::KeyValueStoreSharedPtr Populate(const std::vector<Kvs::Test::Schema::KeyType>& keys)
+{
+    auto store = std::dynamic_pointer_cast<Kvs::Test::Schema::KeyValueStoreType>(Kvs::Test::Create<StoreType>());
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        value.field2 = i;
+        store->Put(keys[i], value);
+    }
+    return store;
+}
+
+/// @brief Heap bytes per entry held by whatever the provided function allocates and keeps
+template <typename Function>
+double BytesPerEntry(size_t entries, Function function)
+{
+    Kvs::Test::AllocationCounter::Enable(true);
+    auto before = Kvs::Test::AllocationCounter::Snapshot();
+    auto kept = function();
+    auto after = Kvs::Test::AllocationCounter::Snapshot();
+    Kvs::Test::AllocationCounter::Enable(false);
+    return static_cast<double>(after.liveBytes - before.liveBytes) / entries;
+}
+
+} // namespace anonymous
+
+TEST(Frozen, FreezesAnUnorderedStore)
+{
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, 10000);
+    auto source = Populate<Kvs::Test::StdUnorderedMap<Kvs::Lock::None>>(keys);
+    auto frozen = Kvs::KeyValueStore::Freeze<Kvs::Test::Schema::CompareKeyType>(*source);
+    EXPECT_EQ(frozen->Size(), source->Size());
+    Kvs::Test::Schema::ValueType expected, value;
+    for (const auto& key : keys)
+    {
+        ASSERT_TRUE(source->Get(key, expected));
+        ASSERT_TRUE(frozen->Get(key, value));
+        EXPECT_EQ(value.field2, expected.field2);
+    }
+    // GenerateKeys() only uses upper case, so these sort before, among and after every key
+    for (const auto& missing : { Kvs::Test::Schema::KeyType{ "0" }, Kvs::Test::Schema::KeyType{ "Mm" }, Kvs::Test::Schema::KeyType{ "z" } })
+    {
+        EXPECT_FALSE(frozen->Get(missing, value));
+    }
+    size_t visited = 0;
+    Kvs::Test::Schema::KeyType previous = { };
+    frozen->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+        EXPECT_TRUE(Kvs::Test::Schema::CompareKeyType()(previous, key));
+        previous = key;
+        ++visited;
+    });
+    EXPECT_EQ(visited, frozen->Size());
+}
+
+TEST(Frozen, MutatingCallsFail)
+{
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    auto source = Populate<Kvs::Test::StdMap<Kvs::Lock::None>>({ key1 });
+    auto frozen = Kvs::KeyValueStore::Freeze<Kvs::Test::Schema::CompareKeyType>(*source);
+    Kvs::Test::Schema::ValueType value = { 2.72, 7, 'e' };
+    EXPECT_FALSE(frozen->Put(key1, value));
+    EXPECT_FALSE(frozen->Put(key2, value));
+    EXPECT_FALSE(frozen->Remove(key1));
+    frozen->Transform([] (const Kvs::Test::Schema::KeyType&, Kvs::Test::Schema::ValueType& value) {
+        value.field2 = 7;
+    });
+    EXPECT_EQ(frozen->Size(), 1);
+    ASSERT_TRUE(frozen->Get(key1, value));
+    EXPECT_EQ(value.field2, 0);
+    EXPECT_FALSE(frozen->Get(key2, value));
+    // the source is unaffected either way
+    EXPECT_TRUE(source->Remove(key1));
+    EXPECT_TRUE(frozen->Get(key1, value));
+    auto empty = Kvs::KeyValueStore::Freeze<Kvs::Test::Schema::CompareKeyType>(*source);
+    EXPECT_EQ(empty->Size(), 0);
+    EXPECT_FALSE(empty->Get(key1, value));
+}
+
+TEST(Frozen, SmallerThanTrees)
+{
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, 100000);
+    size_t entries = Populate<Kvs::Test::StdMap<Kvs::Lock::None>>(keys)->Size();
+    double stdMap = BytesPerEntry(entries, [&] { return Populate<Kvs::Test::StdMap<Kvs::Lock::None>>(keys); });
+    double gnuTree = BytesPerEntry(entries, [&] { return Populate<Kvs::Test::GnuTree<Kvs::Lock::None>>(keys); });
+    auto source = Populate<Kvs::Test::StdMap<Kvs::Lock::None>>(keys);
+    double frozen = BytesPerEntry(entries, [&] { return Kvs::KeyValueStore::Freeze<Kvs::Test::Schema::CompareKeyType>(*source); });
+    GTEST_COUT << "bytes/entry StdMap " << stdMap << ", GnuTree " << gnuTree << ", Frozen " << frozen << std::endl;
+    EXPECT_LT(frozen, stdMap);
+    EXPECT_LT(frozen, gnuTree);
+    // nothing but the key and value arrays
+    EXPECT_LT(frozen, sizeof(Kvs::Test::Schema::KeyType) + sizeof(Kvs::Test::Schema::ValueType) + 1);
+}
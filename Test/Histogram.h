@@ -0,0 +1,138 @@
+/// @file
+/// @brief Defines and implements the Kvs::Test::Histogram class
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace Kvs { namespace Test {
+
+/// @brief A fixed-size log-linear histogram of non-negative integer samples (e.g. nanoseconds)
+/// Each power of two is split into 8 linear sub-buckets, so a percentile
+/// read back is within 12.5% of the recorded value. Recording is a few
+/// shifts and an increment; merging is element-wise addition.
+class Histogram
+{
+public:
+
+    /// @brief Number of linear sub-buckets per power of two, as a power of two
+    static const size_t SubBucketBits = 3;
+
+    /// @brief Total number of buckets covering the full 64-bit range
+    static const size_t BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+    /// @brief Constructor
+    Histogram()
+        : m_buckets(), m_count(0), m_sum(0), m_max(0)
+    {
+
+    }
+
+    /// @brief Records one sample
+    void Record(uint64_t sample)
+    {
+        ++m_buckets[Index(sample)];
+        ++m_count;
+        m_sum += sample;
+        if (sample > m_max)
+        {
+            m_max = sample;
+        }
+    }
+
+    /// @brief Adds all samples of another histogram to this one
+    void Merge(const Histogram& other)
+    {
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        if (other.m_max > m_max)
+        {
+            m_max = other.m_max;
+        }
+    }
+
+    /// @brief Number of recorded samples
+    uint64_t Count() const { return m_count; }
+
+    /// @brief Largest recorded sample
+    uint64_t Max() const { return m_max; }
+
+    /// @brief Average of the recorded samples
+    double Mean() const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+
+    /// @brief Returns the (upper bound of the bucket holding the) sample at the provided percentile
+    uint64_t Percentile(double percentile) const
+    {
+        if (!m_count)
+        {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * m_count);
+        if (rank >= m_count)
+        {
+            rank = m_count - 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += m_buckets[i];
+            if (seen > rank)
+            {
+                uint64_t upper = UpperBound(i);
+                return upper < m_max ? upper : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    /// @brief Number of samples recorded in the provided bucket
+    uint64_t BucketSamples(size_t index) const { return m_buckets[index]; }
+
+    /// @brief Maps a sample to its bucket
+    static size_t Index(uint64_t sample)
+    {
+        if (sample < (1u << SubBucketBits))
+        {
+            return static_cast<size_t>(sample);
+        }
+        size_t msb = 63 - __builtin_clzll(sample);
+        size_t shift = msb - SubBucketBits;
+        size_t subBucket = static_cast<size_t>(sample >> shift) & ((1u << SubBucketBits) - 1);
+        return ((shift + 1) << SubBucketBits) | subBucket;
+    }
+
+    /// @brief The largest sample that maps to the provided bucket
+    static uint64_t UpperBound(size_t index)
+    {
+        if (index < (1u << SubBucketBits))
+        {
+            return index;
+        }
+        size_t shift = (index >> SubBucketBits) - 1;
+        uint64_t subBucket = index & ((1u << SubBucketBits) - 1);
+        uint64_t lower = ((1ull << SubBucketBits) | subBucket) << shift;
+        return lower + ((1ull << shift) - 1);
+    }
+
+protected:
+
+    /// @brief Sample counts per bucket
+    std::array<uint64_t, BucketCount> m_buckets;
+
+    /// @brief Number of samples
+    uint64_t m_count;
+
+    /// @brief Sum of the samples
+    uint64_t m_sum;
+
+    /// @brief Largest sample
+    uint64_t m_max;
+};
+
+} } // namespace Kvs::Test
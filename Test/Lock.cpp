@@ -0,0 +1,94 @@
+#include "Kvs/Lock/Instrumented.h"
+#include "Kvs/Lock/Scoped.h"
+#include "Kvs/Lock/Spin.h"
+#include "Kvs/Lock/StdMutex.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace // anonymous
+{
+
+/// @brief This fixture runs each test case with every lock type that can be instrumented
+template<typename LockType>
+class InstrumentedFixture : public ::testing::Test
+{
+};
+
+} // namespace anonymous
+
+typedef ::testing::Types<
+    Kvs::Lock::Spin,
+    Kvs::Lock::StdMutex
+> LockTypes;
+
+TYPED_TEST_CASE(InstrumentedFixture, LockTypes);
+
+TYPED_TEST(InstrumentedFixture, TryLock)
+{
+    TypeParam lock;
+    EXPECT_TRUE(lock.TryLock());
+    EXPECT_FALSE(lock.TryLock());
+    lock.Unlock();
+    EXPECT_TRUE(lock.TryLock());
+    lock.Unlock();
+}
+
+TYPED_TEST(InstrumentedFixture, CountsUncontendedAcquisitions)
+{
+    Kvs::Lock::Instrumented<TypeParam> lock;
+    for (int i = 0; i < 3; ++i)
+    {
+        Kvs::Lock::Scoped<Kvs::Lock::Instrumented<TypeParam>> scoped(lock);
+    }
+    EXPECT_TRUE(lock.TryLock());
+    EXPECT_FALSE(lock.TryLock());
+    lock.Unlock();
+    auto stats = lock.GetStats();
+    EXPECT_EQ(stats.acquisitions, 4);
+    EXPECT_EQ(stats.contended, 0);
+    EXPECT_EQ(stats.waitNs.Samples(), 4);
+    EXPECT_EQ(stats.waitNs.Percentile(100), 1);
+    EXPECT_EQ(stats.holdNs.Samples(), 4);
+}
+
+TYPED_TEST(InstrumentedFixture, MeasuresContention)
+{
+    Kvs::Lock::Instrumented<TypeParam> lock;
+    lock.Lock();
+    std::promise<void> waiting;
+    std::thread waiter([&] {
+        waiting.set_value();
+        Kvs::Lock::Scoped<Kvs::Lock::Instrumented<TypeParam>> scoped(lock);
+    });
+    waiting.get_future().wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    lock.Unlock();
+    waiter.join();
+    auto stats = lock.GetStats();
+    EXPECT_EQ(stats.acquisitions, 2);
+    EXPECT_EQ(stats.contended, 1);
+    EXPECT_EQ(stats.ContendedRatio(), 0.5);
+    EXPECT_GE(stats.waitNs.Percentile(100), 8000000u);
+    EXPECT_GE(stats.holdNs.Percentile(100), 8000000u);
+}
+
+TYPED_TEST(InstrumentedFixture, Registry)
+{
+    Kvs::Lock::Instrumentation::ResetAll();
+    {
+        Kvs::Lock::Instrumented<TypeParam> lock1;
+        Kvs::Lock::Instrumented<TypeParam> lock2;
+        lock1.Lock();
+        lock1.Unlock();
+        lock2.Lock();
+        lock2.Unlock();
+        EXPECT_EQ(Kvs::Lock::Instrumentation::Sum().acquisitions, 2);
+        Kvs::Lock::Instrumentation::ResetAll();
+        EXPECT_EQ(Kvs::Lock::Instrumentation::Sum().acquisitions, 0);
+        lock1.Lock();
+        lock1.Unlock();
+    }
+    EXPECT_EQ(Kvs::Lock::Instrumentation::Sum().acquisitions, 0);
+}
@@ -0,0 +1,246 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Random.h"
+#include "Kvs/Log2Histogram.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+using Hash = Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>;
+using Entry = Kvs::KeyValueStore::LsmEntry<Kvs::Test::Schema::ValueType>;
+
+/// @brief An Lsm store over StdMap memtables, serializing its writers
+using LsmStore = Kvs::KeyValueStore::Lsm<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::Schema::CompareKeyType, Hash, Kvs::Lock::StdMutex>;
+
+/// @brief Keys the benchmark writes, and keys its memtables take
+/// Keys and values take about 160 bytes, so the data outgrows what the
+/// memtables may hold at once, MaxImmutables + 1 of them, about 40 times over
+const size_t BenchmarkKeys = 1 << 18;
+const size_t BenchmarkMemtableKeys = 2048;
+
+/// @brief Get()s the benchmark times, of keys present and of keys never put
+const size_t BenchmarkGets = 1 << 14;
+
+/// @brief Makes a key from the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%09zu", index);
+    return key;
+}
+
+/// @brief Makes a value from the provided index
+Kvs::Test::Schema::ValueType MakeValue(size_t index)
+{
+    Kvs::Test::Schema::ValueType value = { };
+    value.field1 = index * 0.5;
+    value.field2 = index;
+    return value;
+}
+
+/// @brief Creates a store with small memtables and levels, so a few thousand keys reach several levels
+std::unique_ptr<LsmStore> MakeStore(Kvs::KeyValueStore::LsmOptions::Compaction compaction, size_t memtableKeys = 64)
+{
+    Kvs::KeyValueStore::LsmOptions options(Kvs::Test::MakeLsmDirectory());
+    options.compaction = compaction;
+    options.memtableKeys = memtableKeys;
+    options.levelRatio = 4;
+    options.blockBytes = 1024;
+    options.workers = 2;
+    return std::unique_ptr<LsmStore>(new LsmStore([]
+        {
+            return std::make_shared<Kvs::KeyValueStore::StdMap<Kvs::Test::Schema::KeyType, Entry, Kvs::Test::Schema::CompareKeyType, Kvs::Lock::StdMutex>>();
+        }, options));
+}
+
+/// @brief Puts and removes random keys in both the store and a std::map, checking they agree all along
+void CompareWithStdMap(Kvs::KeyValueStore::LsmOptions::Compaction compaction)
+{
+    auto objectToTest = MakeStore(compaction);
+    std::map<size_t, size_t> expected;
+    Kvs::Test::XorShift random(compaction + 1);
+    const size_t Keys = 2000;
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        const size_t index = random.Next(Keys);
+        if (random.Next(4) == 0)
+        {
+            EXPECT_EQ(objectToTest->Remove(MakeKey(index)), expected.erase(index) == 1);
+        }
+        else
+        {
+            EXPECT_TRUE(objectToTest->Put(MakeKey(index), MakeValue(i)));
+            expected[index] = i;
+        }
+        if (i % 5000 == 4999)
+        {
+            objectToTest->WaitUntilIdle();
+        }
+    }
+    for (size_t index = 0; index < Keys; ++index)
+    {
+        Kvs::Test::Schema::ValueType value;
+        auto found = expected.find(index);
+        ASSERT_EQ(objectToTest->Get(MakeKey(index), value), found != expected.end());
+        if (found != expected.end())
+        {
+            EXPECT_EQ(value, MakeValue(found->second));
+        }
+    }
+    EXPECT_EQ(objectToTest->Size(), expected.size());
+    auto next = expected.begin();
+    objectToTest->ForEach([&](const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value)
+        {
+            ASSERT_TRUE(next != expected.end());
+            EXPECT_EQ(key, MakeKey(next->first));
+            EXPECT_EQ(value, MakeValue(next->second));
+            ++next;
+        } );
+    EXPECT_TRUE(next == expected.end());
+    auto stats = objectToTest->GetStats();
+    EXPECT_GT(stats.runs.size(), 2u);
+}
+
+/// @brief Writes BenchmarkKeys keys, then times Get()s of keys present and absent
+void Benchmark(Kvs::KeyValueStore::LsmOptions::Compaction compaction, const char* name)
+{
+    auto objectToTest = MakeStore(compaction, BenchmarkMemtableKeys);
+    Kvs::Test::XorShift random(1);
+    std::vector<size_t> order(BenchmarkKeys);
+    for (size_t i = 0; i < BenchmarkKeys; ++i)
+    {
+        order[i] = i;
+    }
+    for (size_t i = BenchmarkKeys - 1; i > 0; --i)
+    {
+        std::swap(order[i], order[random.Next(i + 1)]);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (auto index : order)
+    {
+        ASSERT_TRUE(objectToTest->Put(MakeKey(index * 2), MakeValue(index)));
+    }
+    objectToTest->WaitUntilIdle();
+    const double putSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto written = objectToTest->GetStats();
+
+    // present keys are even, absent keys odd
+    Kvs::Log2Histogram present;
+    Kvs::Log2Histogram absent;
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; i < BenchmarkGets; ++i)
+    {
+        const size_t index = random.Next(BenchmarkKeys);
+        auto getStart = std::chrono::steady_clock::now();
+        EXPECT_TRUE(objectToTest->Get(MakeKey(index * 2), value));
+        present.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getStart).count());
+        getStart = std::chrono::steady_clock::now();
+        EXPECT_FALSE(objectToTest->Get(MakeKey(index * 2 + 1), value));
+        absent.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getStart).count());
+    }
+    const auto read = objectToTest->GetStats();
+
+    size_t runs = 0;
+    for (auto levelRuns : written.runs)
+    {
+        runs += levelRuns;
+    }
+    GTEST_COUT << name << ": put " << static_cast<size_t>(BenchmarkKeys / putSeconds) << " keys/s, write amplification "
+               << written.GetWriteAmplification() << ", " << written.writeStalls << " stalls, "
+               << runs << " runs in " << written.runs.size() << " levels" << std::endl;
+    GTEST_COUT << name << ": Get p50/p99 < " << present.Percentile(50) << "/" << present.Percentile(99) << " ns present, "
+               << absent.Percentile(50) << "/" << absent.Percentile(99) << " ns absent, "
+               << double(read.blockReads - written.blockReads) / (2 * BenchmarkGets) << " blocks read per Get" << std::endl;
+}
+
+} // namespace anonymous
+
+TEST(Lsm, LeveledAgreesWithStdMap)
+{
+    CompareWithStdMap(Kvs::KeyValueStore::LsmOptions::Leveled);
+}
+
+TEST(Lsm, TieredAgreesWithStdMap)
+{
+    CompareWithStdMap(Kvs::KeyValueStore::LsmOptions::Tiered);
+}
+
+TEST(Lsm, RemovedKeysStayRemovedThroughCompaction)
+{
+    auto objectToTest = MakeStore(Kvs::KeyValueStore::LsmOptions::Leveled);
+    const size_t Keys = 1000;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Put(MakeKey(i), MakeValue(i)));
+    }
+    objectToTest->WaitUntilIdle();
+    for (size_t i = 0; i < Keys; i += 2)
+    {
+        EXPECT_TRUE(objectToTest->Remove(MakeKey(i)));
+        EXPECT_FALSE(objectToTest->Remove(MakeKey(i)));
+    }
+    // push the removals down to where the values are, and past them
+    for (size_t i = Keys; i < 8 * Keys; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Put(MakeKey(i), MakeValue(i)));
+    }
+    objectToTest->WaitUntilIdle();
+    Kvs::Test::Schema::ValueType value;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_EQ(objectToTest->Get(MakeKey(i), value), i % 2 == 1);
+    }
+    EXPECT_EQ(objectToTest->Size(), 8 * Keys - Keys / 2);
+}
+
+TEST(Lsm, ReadersSeeEveryKeyWhileRunsAreMerged)
+{
+    auto objectToTest = MakeStore(Kvs::KeyValueStore::LsmOptions::Leveled);
+    const size_t Keys = 20000;
+    const size_t Stable = 500;
+    for (size_t i = 0; i < Stable; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Put(MakeKey(i), MakeValue(i)));
+    }
+    std::atomic<bool> stopped(false);
+    std::atomic<size_t> misses(0);
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < 2; ++reader)
+    {
+        readers.emplace_back([&]
+            {
+                Kvs::Test::Schema::ValueType value;
+                for (size_t i = 0; !stopped.load(std::memory_order_relaxed); ++i)
+                {
+                    if (!objectToTest->Get(MakeKey(i % Stable), value) || !(value == MakeValue(i % Stable)))
+                    {
+                        ++misses;
+                    }
+                }
+            } );
+    }
+    for (size_t i = Stable; i < Keys; ++i)
+    {
+        EXPECT_TRUE(objectToTest->Put(MakeKey(i), MakeValue(i)));
+    }
+    objectToTest->WaitUntilIdle();
+    stopped = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(misses, 0u);
+    EXPECT_EQ(objectToTest->Size(), Keys);
+}
+
+TEST(Lsm, WriteAmplificationAndReadLatency)
+{
+    Benchmark(Kvs::KeyValueStore::LsmOptions::Leveled, "leveled");
+    Benchmark(Kvs::KeyValueStore::LsmOptions::Tiered, "tiered");
+}
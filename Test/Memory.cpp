@@ -0,0 +1,110 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Footprint.h"
+#include "Workload.h"
+#include "Report.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <ctime>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Largest population measured here; larger ones are left to KeyValueStoreBench --memory
+const size_t MaxKeys = 1000000;
+
+/// @brief The shared key pool, generated once in MemoryEnvironment::SetUp()
+static std::vector<Kvs::Test::Schema::KeyType> Keys;
+
+static Kvs::Test::MemoryReport TestResultsMemory;
+
+/// @brief The global setup/teardown class
+class MemoryEnvironment : public ::testing::Environment
+{
+public:
+    // Populate the static Keys container for all tests to share
+    virtual void SetUp()
+    {
+        Keys = Kvs::Test::Workload::GenerateKeys(time(nullptr), MaxKeys);
+    }
+
+    virtual void TearDown()
+    {
+        TestResultsMemory.Print("Memory Footprint");
+    }
+};
+
+/// @brief This call registers the global test environment data
+auto env = ::testing::AddGlobalTestEnvironment(new MemoryEnvironment);
+
+/// @brief This fixture measures the memory each key->value store type needs
+template<typename KeyValueStoreType>
+class MemoryFixture : public ::testing::Test
+{
+public:
+    /// @brief Populates a fresh store with the provided amount of keys and records what it cost
+    void Measure(size_t totalKeys)
+    {
+        auto footprint = Kvs::Test::MeasureFootprint(&Kvs::Test::Create<KeyValueStoreType>, Keys, totalKeys);
+        EXPECT_GT(footprint.entries, 0u);
+        EXPECT_LE(footprint.entries, totalKeys);
+        EXPECT_GT(footprint.heapBytes, 0);
+        GTEST_COUT << footprint.entries << " entries: " << footprint.BytesPerEntry() << " bytes/entry, "
+                   << footprint.AllocationsPerEntry() << " allocations/entry" << std::endl;
+        const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        TestResultsMemory.Record(test_info->name(), test_info->type_param(), footprint);
+    }
+};
+
+} // namespace anonymous
+
+/// @brief add new Key Value Store implementations using Kvs::Test::Schema here:
+/// @note populated from a single thread, so no locking is needed
+typedef ::testing::Types<
+    Kvs::Test::StdMap<Kvs::Lock::None>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::GnuTrie<Kvs::Lock::None>,
+    Kvs::Test::GnuTree<Kvs::Lock::None>,
+    Kvs::Test::GnuCcHashTable<Kvs::Lock::None>,
+    Kvs::Test::GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Art<Kvs::Lock::None>,
+    Kvs::Test::BTree<Kvs::Lock::None>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>,
+    Kvs::Test::RobinHood<Kvs::Lock::None>,
+    Kvs::Test::Hopscotch<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuTree<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuTrie<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuCcHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_GnuTree<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_GnuTrie<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_GnuCcHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_ArrayTable_Art<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_GnuTree<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_GnuTrie<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_GnuCcHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_StdMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_StdUnorderedMap<Kvs::Lock::None>,
+    Kvs::Test::Compound_Art_Art<Kvs::Lock::None>
+> KeyValueStoreTypes;
+
+TYPED_TEST_CASE(MemoryFixture, KeyValueStoreTypes);
+
+TYPED_TEST(MemoryFixture, Populate10K)
+{
+    this->Measure(10000);
+}
+
+TYPED_TEST(MemoryFixture, Populate1M)
+{
+    this->Measure(MaxKeys);
+}
@@ -0,0 +1,197 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Payload bytes copied, and payloads constructed other than by copying or moving, since the last reset
+size_t PayloadBytesCopied = 0;
+size_t PayloadConstructions = 0;
+
+/// @brief A value owning a heap buffer, which counts the bytes copied and how often it is constructed
+/// A copy allocates and copies the buffer unless it is empty; a move only takes it over.
+struct Payload
+{
+    Payload() : bytes()
+    {
+        ++PayloadConstructions;
+    }
+
+    explicit Payload(size_t size) : bytes(size, 'p')
+    {
+        ++PayloadConstructions;
+    }
+
+    Payload(const Payload& other) : bytes(other.bytes)
+    {
+        PayloadBytesCopied += bytes.size();
+    }
+
+    Payload(Payload&& other) : bytes(std::move(other.bytes))
+    {
+
+    }
+
+    Payload& operator=(const Payload& other)
+    {
+        bytes = other.bytes;
+        PayloadBytesCopied += bytes.size();
+        return *this;
+    }
+
+    Payload& operator=(Payload&& other)
+    {
+        bytes = std::move(other.bytes);
+        return *this;
+    }
+
+    std::vector<char> bytes;
+};
+
+using Key = Kvs::Test::Schema::KeyType;
+using Hash = Kvs::Hash::Jenkins::OneAtATime<Key>;
+using PayloadStoreSharedPtr = Kvs::TypedKeyValueStore<Key, Payload>::SharedPtr;
+
+/// @brief Bytes each payload owns, keys the benchmark puts, and rounds it overwrites them
+const size_t PayloadBytes = 4096;
+const size_t BenchmarkKeys = 1 << 14;
+const size_t BenchmarkRounds = 4;
+
+/// @brief Makes a key from the provided index, whose first bytes vary so a Compound store spreads keys over its back-ends
+Key MakeKey(size_t index)
+{
+    Key key = { };
+    snprintf(key.field, sizeof(key.field), "%c%c%c%09zu", char('A' + index % 26), char('A' + index / 26 % 26), char('A' + index / 676 % 26), index);
+    return key;
+}
+
+PayloadStoreSharedPtr MakeStdMap()
+{
+    return std::make_shared<Kvs::KeyValueStore::StdMap<Key, Payload, Kvs::Test::Schema::CompareKeyType, Kvs::Lock::None>>();
+}
+
+PayloadStoreSharedPtr MakeStdUnorderedMap()
+{
+    return std::make_shared<Kvs::KeyValueStore::StdUnorderedMap<Key, Payload, Hash, Kvs::Lock::None>>();
+}
+
+PayloadStoreSharedPtr MakeGnuCcHashTable()
+{
+    return std::make_shared<Kvs::KeyValueStore::GnuCcHashTable<Key, Payload, Hash, Kvs::Lock::None>>();
+}
+
+PayloadStoreSharedPtr MakeCompoundArrayTableStdMap()
+{
+    return std::make_shared<Kvs::KeyValueStore::Compound<Key, Payload, Kvs::Lock::None>>(
+        std::make_shared<Kvs::KeyValueStore::ArrayTable<Key, PayloadStoreSharedPtr, 256, Kvs::Hash::FirstByte<Key>, Kvs::Lock::None>>(),
+        &MakeStdMap);
+}
+
+/// @brief Checks that Emplace() and Put() of values moved never copy them, and that
+/// the store constructs a new value the provided number of times
+void ExpectNoCopies(PayloadStoreSharedPtr store, size_t constructionsPerInsert)
+{
+    const size_t Keys = 1000;
+    PayloadBytesCopied = PayloadConstructions = 0;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(store->Emplace(MakeKey(i), PayloadBytes));
+    }
+    EXPECT_EQ(PayloadBytesCopied, 0u);
+    EXPECT_EQ(PayloadConstructions, constructionsPerInsert * Keys);
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_TRUE(store->Put(MakeKey(i), Payload(2 * PayloadBytes)));
+    }
+    EXPECT_EQ(PayloadBytesCopied, 0u);
+    EXPECT_EQ(store->Size(), Keys);
+    Payload value;
+    EXPECT_TRUE(store->Get(MakeKey(0), value));
+    EXPECT_EQ(value.bytes.size(), 2 * PayloadBytes);
+
+    // whereas a value the caller keeps is copied once per Put()
+    PayloadBytesCopied = 0;
+    const Payload kept(PayloadBytes);
+    for (size_t i = Keys; i < 2 * Keys; ++i)
+    {
+        EXPECT_TRUE(store->Put(MakeKey(i), kept));
+    }
+    EXPECT_EQ(PayloadBytesCopied, Keys * PayloadBytes);
+}
+
+/// @brief Returns the nanoseconds per Put() of a new payload, copied or moved into the store
+double TimePuts(PayloadStoreSharedPtr store, bool move)
+{
+    std::vector<Key> keys(BenchmarkKeys);
+    for (size_t i = 0; i < BenchmarkKeys; ++i)
+    {
+        keys[i] = MakeKey(i);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    // the first round inserts, the others overwrite
+    for (size_t round = 0; round < BenchmarkRounds; ++round)
+    {
+        for (const auto& key : keys)
+        {
+            Payload value(PayloadBytes);
+            if (move)
+            {
+                store->Put(Key(key), std::move(value));
+            }
+            else
+            {
+                store->Put(key, value);
+            }
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (BenchmarkKeys * BenchmarkRounds);
+}
+
+/// @brief Prints the cost of a Put() of a heap-owning value and the bytes it copies, copied against moved
+void Benchmark(PayloadStoreSharedPtr (*create)(), const char* name)
+{
+    for (bool move : { false, true })
+    {
+        PayloadBytesCopied = 0;
+        const double nanoseconds = TimePuts(create(), move);
+        GTEST_COUT << name << (move ? " moved: " : " copied: ") << nanoseconds << " ns/Put, "
+                   << PayloadBytesCopied / (BenchmarkKeys * BenchmarkRounds) << " bytes copied/Put" << std::endl;
+    }
+}
+
+} // namespace anonymous
+
+TEST(Move, StdMapNeverCopiesMovedValues)
+{
+    ExpectNoCopies(MakeStdMap(), 1);
+}
+
+TEST(Move, StdUnorderedMapNeverCopiesMovedValues)
+{
+    ExpectNoCopies(MakeStdUnorderedMap(), 1);
+}
+
+TEST(Move, GnuCcHashTableNeverCopiesMovedValues)
+{
+    // the container default-constructs the value it then moves into, and copies it while empty
+    ExpectNoCopies(MakeGnuCcHashTable(), 2);
+}
+
+TEST(Move, CompoundNeverCopiesMovedValues)
+{
+    ExpectNoCopies(MakeCompoundArrayTableStdMap(), 1);
+}
+
+TEST(Move, PutLatencyOfHeapValues)
+{
+    Benchmark(&MakeStdMap, "StdMap");
+    Benchmark(&MakeStdUnorderedMap, "StdUnorderedMap");
+    Benchmark(&MakeGnuCcHashTable, "GnuCcHashTable");
+    Benchmark(&MakeCompoundArrayTableStdMap, "Compound_ArrayTable_StdMap");
+}
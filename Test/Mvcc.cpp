@@ -0,0 +1,94 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+
+namespace // anonymous
+{
+
+using MvccStore = Kvs::KeyValueStore::Mvcc<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::Schema::CompareKeyType, Kvs::Lock::StdMutex>;
+
+/// @brief Creates the Mvcc store as built by Factories.h
+std::shared_ptr<MvccStore> CreateMvcc()
+{
+    return std::dynamic_pointer_cast<MvccStore>(Kvs::Test::Create<Kvs::Test::Mvcc<Kvs::Lock::StdMutex>>());
+}
+
+} // namespace anonymous
+
+TEST(Mvcc, SnapshotIsConsistent)
+{
+    auto store = CreateMvcc();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    Kvs::Test::Schema::ValueType value1 = { 3.14, 3, 'p' };
+    Kvs::Test::Schema::ValueType value2 = { 2.72, 2, 'e' };
+    EXPECT_TRUE(store->Put(key1, value1));
+    auto snapshot = store->Snapshot();
+    EXPECT_TRUE(store->Put(key1, value2));
+    EXPECT_TRUE(store->Put(key2, value2));
+    Kvs::Test::Schema::ValueType value;
+    EXPECT_TRUE(snapshot->Get(key1, value));
+    EXPECT_EQ(value, value1);
+    EXPECT_FALSE(snapshot->Get(key2, value));
+    EXPECT_TRUE(store->Get(key1, value));
+    EXPECT_EQ(value, value2);
+    size_t visited = 0;
+    snapshot->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        EXPECT_EQ(key, key1);
+        EXPECT_EQ(value, value1);
+        ++visited;
+    });
+    EXPECT_EQ(visited, 1);
+    EXPECT_TRUE(store->Remove(key1));
+    EXPECT_TRUE(snapshot->Get(key1, value));
+    EXPECT_FALSE(store->Get(key1, value));
+    EXPECT_EQ(store->Size(), 1);
+}
+
+TEST(Mvcc, ScanDoesNotBlockWriters)
+{
+    auto store = CreateMvcc();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    const size_t Keys = 4 * MvccStore::ScanChunk;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        Kvs::Test::Schema::KeyType key = { };
+        snprintf(key.field, sizeof(key.field), "key%04zu", i);
+        store->Put(key, value);
+    }
+    size_t visited = 0;
+    store->ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+        // writing from inside the scan would deadlock if the scan held the lock
+        store->Remove(key);
+        Kvs::Test::Schema::KeyType added = key;
+        added.field[0] = 'z';
+        store->Put(added, value);
+        ++visited;
+    });
+    EXPECT_EQ(visited, Keys);
+    EXPECT_EQ(store->Size(), Keys);
+}
+
+TEST(Mvcc, PrunesVersionsNoSnapshotNeeds)
+{
+    auto store = CreateMvcc();
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    store->Put(key1, value);
+    store->Put(key1, value);
+    EXPECT_EQ(store->Versions(), 1);
+    {
+        auto snapshot = store->Snapshot();
+        store->Put(key1, value);
+        store->Put(key2, value);
+        store->Remove(key2);
+        // key1's old version is kept for the snapshot, key2 never existed for it
+        EXPECT_EQ(store->Versions(), 2);
+    }
+    store->CollectGarbage();
+    EXPECT_EQ(store->Versions(), 1);
+}
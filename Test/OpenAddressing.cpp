@@ -0,0 +1,238 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Workload.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
+namespace // anonymous
+{
+
+using RobinHoodStore = Kvs::KeyValueStore::RobinHood<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType,
+    Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>, Kvs::Lock::None>;
+using HopscotchStore = Kvs::KeyValueStore::Hopscotch<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType,
+    Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>, Kvs::Lock::None>;
+
+/// @brief Keys held while churning
+const size_t ChurnKeys = 10000;
+
+/// @brief Intervals the churn benchmark reports on, and how long each runs
+const size_t ChurnIntervals = 6;
+const std::chrono::milliseconds ChurnInterval(500);
+
+/// @brief A hash sending every key to the same home slot
+struct SameHome
+{
+    size_t operator()(const Kvs::Test::Schema::KeyType&) const
+    {
+        return 0;
+    }
+};
+
+/// @brief Makes a key from the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%06zu", index);
+    return key;
+}
+
+/// @brief A summary of the probe lengths of an open-addressing store
+struct ProbeSummary
+{
+    double mean;
+    size_t p99;
+    size_t max;
+};
+
+/// @brief Summarizes probe lengths as returned by GetProbeLengths()
+ProbeSummary Summarize(const std::vector<size_t>& lengths)
+{
+    size_t count = 0;
+    size_t total = 0;
+    for (size_t length = 0; length < lengths.size(); ++length)
+    {
+        count += lengths[length];
+        total += length * lengths[length];
+    }
+    ProbeSummary summary = { count ? static_cast<double>(total) / count : 0.0, 0, lengths.empty() ? 0 : lengths.size() - 1 };
+    for (size_t length = 0, seen = 0; length < lengths.size(); ++length)
+    {
+        seen += lengths[length];
+        if (seen * 100 >= count * 99)
+        {
+            summary.p99 = length;
+            break;
+        }
+    }
+    return summary;
+}
+
+/// @brief Summarizes the probe lengths of the provided store, if it reports them
+bool Summarize(const Kvs::Test::Schema::KeyValueStoreType& store, ProbeSummary& summary)
+{
+    if (auto robinHood = dynamic_cast<const RobinHoodStore*>(&store))
+    {
+        summary = Summarize(robinHood->GetProbeLengths());
+        return true;
+    }
+    if (auto hopscotch = dynamic_cast<const HopscotchStore*>(&store))
+    {
+        summary = Summarize(hopscotch->GetProbeLengths());
+        return true;
+    }
+    return false;
+}
+
+} // namespace anonymous
+
+/// @brief The open-addressing stores and the store with tombstones they replace
+template<typename KeyValueStoreType>
+class OpenAddressingFixture : public ::testing::Test
+{
+public:
+    OpenAddressingFixture()
+        : m_store(std::dynamic_pointer_cast<Kvs::Test::Schema::KeyValueStoreType>(Kvs::Test::Create<KeyValueStoreType>()))
+    {
+
+    }
+
+protected:
+    Kvs::Test::Schema::KeyValueStoreSharedPtr m_store;
+};
+
+/// @brief The stores that report probe lengths
+template<typename KeyValueStoreType>
+class NoTombstonesFixture : public OpenAddressingFixture<KeyValueStoreType> { };
+
+typedef ::testing::Types<
+    Kvs::Test::RobinHood<Kvs::Lock::None>,
+    Kvs::Test::Hopscotch<Kvs::Lock::None>
+> NoTombstonesKeyValueStoreTypes;
+
+TYPED_TEST_CASE(NoTombstonesFixture, NoTombstonesKeyValueStoreTypes);
+
+TYPED_TEST(NoTombstonesFixture, ChurnKeepsProbesShort)
+{
+    // a little under the most either table holds before growing past 2048 slots
+    const size_t Keys = 1700;
+    const size_t Cycles = 50000;
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        value.field2 = i;
+        this->m_store->Put(MakeKey(i), value);
+    }
+    ProbeSummary fresh;
+    ASSERT_TRUE(Summarize(*this->m_store, fresh));
+    // remove the oldest key and put a new one, the size never changes
+    for (size_t i = Keys; i < Keys + Cycles; ++i)
+    {
+        ASSERT_TRUE(this->m_store->Remove(MakeKey(i - Keys)));
+        value.field2 = i;
+        this->m_store->Put(MakeKey(i), value);
+    }
+    ProbeSummary churned;
+    ASSERT_TRUE(Summarize(*this->m_store, churned));
+    GTEST_COUT << "mean probe fresh " << fresh.mean << ", after churn " << churned.mean
+               << "; longest " << fresh.max << ", " << churned.max << std::endl;
+    EXPECT_EQ(this->m_store->Size(), Keys);
+    EXPECT_LT(churned.mean, fresh.mean * 1.5 + 0.1);
+    for (size_t i = 0; i < Keys + Cycles; ++i)
+    {
+        EXPECT_EQ(this->m_store->Get(MakeKey(i), value), i >= Cycles);
+    }
+}
+
+TEST(RobinHood, RemoveShiftsTheRunBack)
+{
+    Kvs::KeyValueStore::RobinHood<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, SameHome, Kvs::Lock::None> objectToTest;
+    const size_t Keys = 8;
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value);
+    }
+    EXPECT_EQ(objectToTest.GetProbeLengths(), std::vector<size_t>(Keys, 1));
+    ASSERT_TRUE(objectToTest.Remove(MakeKey(3)));
+    // one run of keys all at home in slot 0, so no gap is left behind the removed key
+    EXPECT_EQ(objectToTest.GetProbeLengths(), std::vector<size_t>(Keys - 1, 1));
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        EXPECT_EQ(objectToTest.Get(MakeKey(i), value), i != 3);
+    }
+}
+
+TEST(Hopscotch, PutFailsWhenTooManyKeysShareAHome)
+{
+    Kvs::KeyValueStore::Hopscotch<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, SameHome, Kvs::Lock::None, 8> objectToTest;
+    const size_t capacity = objectToTest.GetCapacity();
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < 8; ++i)
+    {
+        objectToTest.Put(MakeKey(i), value);
+    }
+    EXPECT_EQ(objectToTest.GetCapacity(), capacity);
+    // every key has the same home whatever the table's size, and it has only 8 slots
+    EXPECT_FALSE(objectToTest.Put(MakeKey(8), value));
+    EXPECT_GT(objectToTest.GetCapacity(), capacity);
+    EXPECT_EQ(objectToTest.Size(), 8);
+    EXPECT_FALSE(objectToTest.Get(MakeKey(8), value));
+}
+
+/// @brief The stores compared by the churn benchmark
+template<typename KeyValueStoreType>
+class SustainedChurnFixture : public OpenAddressingFixture<KeyValueStoreType> { };
+
+typedef ::testing::Types<
+    Kvs::Test::GnuGpHashTable<Kvs::Lock::None>,
+    Kvs::Test::RobinHood<Kvs::Lock::None>,
+    Kvs::Test::Hopscotch<Kvs::Lock::None>
+> SustainedChurnKeyValueStoreTypes;
+
+TYPED_TEST_CASE(SustainedChurnFixture, SustainedChurnKeyValueStoreTypes);
+
+TYPED_TEST(SustainedChurnFixture, FixedSizeInsertRemove)
+{
+    // each cycle removes the oldest key, puts a new one and gets a live one
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, ChurnKeys);
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < ChurnKeys; ++i)
+    {
+        this->m_store->Put(keys[i], value);
+    }
+    // the random keys may repeat, so fewer than ChurnKeys may be held
+    const size_t entries = this->m_store->Size();
+    size_t cycles = 0;
+    for (size_t interval = 0; interval < ChurnIntervals; ++interval)
+    {
+        size_t intervalCycles = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto stop = start + ChurnInterval;
+        while (std::chrono::steady_clock::now() < stop)
+        {
+            for (size_t batch = 0; batch < 64; ++batch, ++cycles, ++intervalCycles)
+            {
+                size_t oldest = cycles % ChurnKeys;
+                this->m_store->Remove(keys[oldest]);
+                // a new key: the old one with its last character cycled through the lower case letters
+                keys[oldest].field[sizeof(keys[oldest].field) - 2] = 'a' + (cycles / ChurnKeys) % 26;
+                this->m_store->Put(keys[oldest], value);
+                this->m_store->Get(keys[(oldest + ChurnKeys / 2) % ChurnKeys], value);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        GTEST_COUT << "interval " << interval << ": " << std::fixed << std::setprecision(0)
+                   << intervalCycles * 3 / seconds << " ops/s, " << cycles << " keys replaced";
+        ProbeSummary summary;
+        if (Summarize(*this->m_store, summary))
+        {
+            std::cout << std::setprecision(2) << ", probe mean " << summary.mean
+                      << " p99 " << summary.p99 << " max " << summary.max;
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+    EXPECT_EQ(this->m_store->Size(), entries);
+}
@@ -0,0 +1,227 @@
+/// @file
+/// @brief Defines and implements the Kvs::Test::PerfCounters class
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Kvs { namespace Test {
+
+/// @brief A group of hardware performance counters for the calling thread
+/// Opened with perf_event_open(2) so they count only the thread that
+/// constructed them. Events the machine or the kernel will not provide are
+/// left out of the group; if none can be opened the counters are simply
+/// unavailable and every read returns zeros.
+class PerfCounters
+{
+public:
+
+    /// @brief The events counted
+    enum Event
+    {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        LlcMisses,
+        DtlbMisses,
+        EventCount      ///< not an event, the number of events
+    };
+
+    /// @brief Returns a printable name for the provided event
+    static const char* Name(size_t event)
+    {
+        static const char* names[EventCount] =
+            { "cycles", "instructions", "branch-misses", "llc-misses", "dtlb-misses" };
+        return event < EventCount ? names[event] : "unknown";
+    }
+
+    /// @brief Counter values, which can be summed across threads
+    struct Values
+    {
+        /// @brief Count per event, scaled up if the kernel had to multiplex
+        std::array<uint64_t, EventCount> counts;
+        /// @brief Whether each event was actually counted
+        std::array<bool, EventCount> valid;
+
+        /// @brief Adds the counts of another thread
+        Values& operator+=(const Values& other)
+        {
+            for (size_t i = 0; i < EventCount; ++i)
+            {
+                counts[i] += other.counts[i];
+                valid[i] = valid[i] || other.valid[i];
+            }
+            return *this;
+        }
+
+        /// @brief Whether any event was counted
+        bool Any() const
+        {
+            for (auto isValid : valid)
+            {
+                if (isValid)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /// @brief Opens the counter group for the calling thread, disabled
+    PerfCounters()
+        : m_leader(-1), m_members(0), m_error()
+    {
+        m_fds.fill(-1);
+        m_order.fill(EventCount);
+#ifdef __linux__
+        const uint64_t cacheMiss =
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint32_t types[EventCount] =
+            { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE };
+        const uint64_t configs[EventCount] =
+            { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+              PERF_COUNT_HW_CACHE_LL | cacheMiss, PERF_COUNT_HW_CACHE_DTLB | cacheMiss };
+        for (size_t event = 0; event < EventCount; ++event)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[event];
+            attr.config = configs[event];
+            attr.disabled = m_leader == -1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, m_leader, 0));
+            if (fd == -1)
+            {
+                if (m_error.empty())
+                {
+                    m_error = std::string(Name(event)) + ": " + strerror(errno);
+                }
+                continue;
+            }
+            if (m_leader == -1)
+            {
+                m_leader = fd;
+            }
+            m_fds[event] = fd;
+            m_order[m_members++] = event;
+        }
+#else
+        m_error = "perf_event_open is only available on Linux";
+#endif
+    }
+
+    /// @brief Closes the counters
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (auto fd : m_fds)
+        {
+            if (fd != -1)
+            {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    /// @brief make non-copyable
+    PerfCounters(const PerfCounters&) = delete;
+
+    /// @brief make non-assignable
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// @brief Whether at least one event could be opened
+    bool Available() const
+    {
+        return m_leader != -1;
+    }
+
+    /// @brief Why the first event that failed to open did so, empty if none failed
+    const std::string& Error() const
+    {
+        return m_error;
+    }
+
+    /// @brief Zeros and starts every counter in the group
+    void Start()
+    {
+#ifdef __linux__
+        if (Available())
+        {
+            ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    /// @brief Stops every counter in the group
+    void Stop()
+    {
+#ifdef __linux__
+        if (Available())
+        {
+            ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    /// @brief Reads the whole group at once
+    Values Read() const
+    {
+        Values values = Values();
+#ifdef __linux__
+        if (!Available())
+        {
+            return values;
+        }
+        // layout for PERF_FORMAT_GROUP with both times: nr, time_enabled, time_running, value[nr]
+        uint64_t buffer[3 + EventCount];
+        if (read(m_leader, buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(uint64_t)))
+        {
+            return values;
+        }
+        uint64_t members = buffer[0];
+        double scale = buffer[2] ? static_cast<double>(buffer[1]) / buffer[2] : 0.0;
+        for (size_t i = 0; i < members && i < m_members; ++i)
+        {
+            values.counts[m_order[i]] = static_cast<uint64_t>(buffer[3 + i] * scale);
+            values.valid[m_order[i]] = buffer[2] != 0;
+        }
+#endif
+        return values;
+    }
+
+protected:
+
+    /// @brief File descriptor of the group leader, -1 if nothing could be opened
+    int m_leader;
+
+    /// @brief File descriptor per event, -1 if that event could not be opened
+    std::array<int, EventCount> m_fds;
+
+    /// @brief Event of each group member, in the order the kernel reports them
+    std::array<size_t, EventCount> m_order;
+
+    /// @brief Number of events in the group
+    size_t m_members;
+
+    /// @brief First failure to open an event
+    std::string m_error;
+};
+
+} } // namespace Kvs::Test
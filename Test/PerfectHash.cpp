@@ -0,0 +1,120 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "AllocationCounter.h"
+#include "Workload.h"
+#include "Kvs/Hash/Murmur.h"
+#include "Kvs/KeyValueStore/PerfectHash.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <vector>
+
+namespace // anonymous
+{
+
+using MurmurHash = Kvs::Hash::Murmur::Hash64A<Kvs::Test::Schema::KeyType>;
+
+/// @brief A hash under which every key collides with every other until the seed changes
+struct CollidingUntilReseeded : MurmurHash
+{
+    explicit CollidingUntilReseeded(uint64_t seed = 0) : MurmurHash(seed) { }
+
+    size_t operator()(const Kvs::Test::Schema::KeyType& key) const
+    {
+        return m_seed == 0 ? 42 : MurmurHash::operator()(key);
+    }
+};
+
+/// @brief Creates a store of the provided type holding the provided keys, each valued by its index
+template <typename StoreType>
+Kvs::Test::Schema::KeyValueStoreSharedPtr Populate(const std::vector<Kvs::Test::Schema::KeyType>& keys)
+{
+    auto store = std::dynamic_pointer_cast<Kvs::Test::Schema::KeyValueStoreType>(Kvs::Test::Create<StoreType>());
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        value.field2 = i;
+        store->Put(keys[i], value);
+    }
+    return store;
+}
+
+/// @brief Expects the provided perfect hash store to hold exactly what the provided source does
+template <typename PerfectHashType>
+void ExpectSameAs(const PerfectHashType& objectToTest, const Kvs::Test::Schema::KeyValueStoreType& source)
+{
+    EXPECT_EQ(objectToTest.Size(), source.Size());
+    size_t visited = 0;
+    source.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& expected) {
+        Kvs::Test::Schema::ValueType value;
+        ASSERT_TRUE(objectToTest.Get(key, value));
+        EXPECT_EQ(value.field2, expected.field2);
+        // GenerateKeys() only uses upper case, so the key turned lower case is absent
+        Kvs::Test::Schema::KeyType absent = key;
+        absent.field[0] = 'a';
+        EXPECT_FALSE(objectToTest.Get(absent, value));
+    });
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        Kvs::Test::Schema::ValueType expected;
+        ASSERT_TRUE(source.Get(key, expected));
+        EXPECT_EQ(value.field2, expected.field2);
+        ++visited;
+    });
+    EXPECT_EQ(visited, source.Size());
+}
+
+} // namespace anonymous
+
+TEST(PerfectHash, BuildsFromAnyStore)
+{
+    for (size_t count : { 0, 1, 2, 5, 10000 })
+    {
+        auto keys = Kvs::Test::Workload::GenerateKeys(1, count);
+        auto source = Populate<Kvs::Test::StdMap<Kvs::Lock::None>>(keys);
+        ExpectSameAs(*Kvs::KeyValueStore::BuildPerfectHash<MurmurHash>(*source), *source);
+    }
+}
+
+TEST(PerfectHash, ReseedsWhenKeysCollide)
+{
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, 100);
+    auto source = Populate<Kvs::Test::StdUnorderedMap<Kvs::Lock::None>>(keys);
+    ExpectSameAs(*Kvs::KeyValueStore::BuildPerfectHash<CollidingUntilReseeded>(*source), *source);
+}
+
+TEST(PerfectHash, MutatingCallsFail)
+{
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    auto source = Populate<Kvs::Test::StdMap<Kvs::Lock::None>>({ key1 });
+    auto objectToTest = Kvs::KeyValueStore::BuildPerfectHash<MurmurHash>(*source);
+    Kvs::Test::Schema::ValueType value = { 2.72, 7, 'e' };
+    EXPECT_FALSE(objectToTest->Put(key1, value));
+    EXPECT_FALSE(objectToTest->Put(key2, value));
+    EXPECT_FALSE(objectToTest->Remove(key1));
+    objectToTest->Transform([] (const Kvs::Test::Schema::KeyType&, Kvs::Test::Schema::ValueType& value) {
+        value.field2 = 7;
+    });
+    EXPECT_EQ(objectToTest->Size(), 1);
+    ASSERT_TRUE(objectToTest->Get(key1, value));
+    EXPECT_EQ(value.field2, 0);
+    EXPECT_FALSE(objectToTest->Get(key2, value));
+}
+
+TEST(PerfectHash, SmallerThanHashTables)
+{
+    auto keys = Kvs::Test::Workload::GenerateKeys(1, 100000);
+    auto source = Populate<Kvs::Test::StdUnorderedMap<Kvs::Lock::None>>(keys);
+    Kvs::Test::AllocationCounter::Enable(true);
+    auto before = Kvs::Test::AllocationCounter::Snapshot();
+    auto hashTable = Populate<Kvs::Test::GnuGpHashTable<Kvs::Lock::None>>(keys);
+    auto middle = Kvs::Test::AllocationCounter::Snapshot();
+    auto objectToTest = Kvs::KeyValueStore::BuildPerfectHash<MurmurHash>(*source);
+    auto after = Kvs::Test::AllocationCounter::Snapshot();
+    Kvs::Test::AllocationCounter::Enable(false);
+    double hashTableBytes = static_cast<double>(middle.liveBytes - before.liveBytes) / hashTable->Size();
+    double perfectHashBytes = static_cast<double>(after.liveBytes - middle.liveBytes) / objectToTest->Size();
+    GTEST_COUT << "bytes/entry GnuGpHashTable " << hashTableBytes << ", PerfectHash " << perfectHashBytes << std::endl;
+    EXPECT_LT(perfectHashBytes, hashTableBytes);
+    // the entries plus a pilot per bucket and a few remapped slots
+    EXPECT_LT(perfectHashBytes, sizeof(Kvs::Test::Schema::KeyType) + sizeof(Kvs::Test::Schema::ValueType) + 2);
+}
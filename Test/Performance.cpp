@@ -3,13 +3,18 @@
 #include "Kvs/KeyValueStoreUser.h"
 #include "gtest/gtest.h"
 #include "gtestcout.h"
-#include <cstdlib>
+#include "Random.h"
+#include "Workload.h"
+#include "Report.h"
+#include "PerfCounters.h"
+#include <atomic>
 #include <vector>
 #include <thread>
 #include <future>
 #include <chrono>
 #include <numeric>
-#include <iomanip>
+#include <algorithm>
+#include <functional>
 
 namespace // anonymous
 {
@@ -20,26 +25,27 @@ const size_t TotalKeys = 10000;
 /// @brief Number of seconds for each test to run
 const size_t SecondsToRun = 3;
 
+/// @brief Length of the precomputed key index stream each thread cycles through
+/// @note Must be a power of two so the stream position can wrap with a mask
+const size_t KeyIndexStreamLength = 1 << 16;
+
+/// @brief Assumed size of a cache line, used to keep per-thread data apart
+const size_t CacheLineSize = 64;
+
 /// @brief A shared container of keys to use for each test.
 /// To ensure the test results are comparable it seems like a
 /// good idea to use the same keys and the same order determined
-/// by the srand() in the global Kvs::Test::SchemaPerformanceEnvironment::SetUp()
+/// by the seed in the global PerformanceEnvironment::SetUp()
 static std::vector<Kvs::Test::Schema::KeyType> Keys;
 
-using TestTypeAndThroughput_t = std::pair<std::string, size_t>;
-struct TestTypeAndThroughputCompare
-{
-    bool operator () (const TestTypeAndThroughput_t& lhs, const TestTypeAndThroughput_t& rhs) const
-    {
-        return lhs.second > rhs.second;
-    }
-};
+/// @brief The seed used to generate the keys and every thread's key index stream
+static uint64_t Seed;
 
-using TestResultsPerTestType_t = std::set<TestTypeAndThroughput_t, TestTypeAndThroughputCompare>;
-using TestResults_t = std::map<std::string, TestResultsPerTestType_t>;
-static TestResults_t TestResultsReadThroughput;
-static TestResults_t TestResultsWriteThroughput;
-static TestResults_t TestResultsTotalThroughput;
+static Kvs::Test::ThroughputReport TestResultsReadThroughput;
+static Kvs::Test::ThroughputReport TestResultsWriteThroughput;
+static Kvs::Test::ThroughputReport TestResultsTotalThroughput;
+static Kvs::Test::CounterReport TestResultsCounters;
+static Kvs::Test::ContentionReport TestResultsContention;
 
 /// @brief The global setup/teardown class
 class PerformanceEnvironment : public ::testing::Environment
@@ -48,45 +54,66 @@ public:
     // Populate the static Keys container for all tests to share
     virtual void SetUp()
     {
-        srand(time(nullptr));
-        for (size_t keyIndex = 0; keyIndex < TotalKeys; ++keyIndex)
-        {
-            Kvs::Test::Schema::KeyType key;
-            auto buffer = reinterpret_cast<uint8_t*>(&key);
-            memset(buffer, 0, sizeof(key));
-            auto keyLength = rand() % (sizeof(key)-1) + 1;
-            for (size_t c = 0; c < keyLength; ++c)
-            {
-                buffer[c] = 'A' + rand() % ('Z' - 'A');
-            }
-            Keys.emplace_back(key);
-        }
-    }
-
-    void Report(const std::string& title, const TestResults_t& testResults)
-    {
-        GTEST_COUT << "*** " << title << " ***" << std::endl;
-        for (const auto& pair1 : testResults)
-        {
-            GTEST_COUT << "  Results for " << pair1.first << " test case:" << std::endl;
-            for (const auto& pair2 : pair1.second)
-            {
-                GTEST_COUT << "    " << std::setw(8) << pair2.second << " ops/sec: " << pair2.first << std::endl;
-            }
-        }
+        Seed = time(nullptr);
+        Keys = Kvs::Test::Workload::GenerateKeys(Seed, TotalKeys);
     }
 
     virtual void TearDown()
     {
-        Report("Read Throughput", TestResultsReadThroughput);
-        Report("Write Throughput", TestResultsWriteThroughput);
-        Report("Total Throughput", TestResultsTotalThroughput);
+        GTEST_COUT << "Kvs::Test::NoOp is the calibration baseline: "
+                   << "the most the harness itself can drive" << std::endl;
+        TestResultsReadThroughput.Print("Read Throughput");
+        TestResultsWriteThroughput.Print("Write Throughput");
+        TestResultsTotalThroughput.Print("Total Throughput");
+        TestResultsCounters.Print("Hardware Counters");
+        TestResultsContention.Print("Lock Contention");
     }
 };
 
 /// @brief This call registers the global test environment data
 auto env = ::testing::AddGlobalTestEnvironment(new PerformanceEnvironment);
 
+/// @brief The Statistics decorator and Compound store as built by Factories.h
+using StatisticsStore = Kvs::KeyValueStore::Statistics<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType>;
+using CompoundStore = Kvs::KeyValueStore::Compound<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Lock::StdMutex>;
+
+/// @brief The Rcu store as built by Factories.h, which copies itself on every Put
+using RcuStore = Kvs::KeyValueStore::Rcu<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType,
+    Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>, Kvs::Lock::None>,
+    Kvs::Lock::StdMutex>;
+
+/// @brief The tries as built by Factories.h, which can also scan the keys under a prefix
+using GnuTrieStore = Kvs::KeyValueStore::GnuTrie<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::FullKeyAccessTraits, Kvs::Lock::StdMutex>;
+using ArtStore = Kvs::KeyValueStore::Art<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Test::FullKeyAccessTraits, Kvs::Lock::StdMutex>;
+
+/// @brief The caches as built by Factories.h, which count their hits, misses and evictions
+template <typename EvictionPolicy>
+using CacheStore = Kvs::KeyValueStore::Cache<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType,
+    Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>, EvictionPolicy, Kvs::Lock::StdMutex>;
+
+/// @brief Skew of the key popularity in the cache tests, YCSB's default
+const double CacheZipfianTheta = 0.99;
+
+/// @brief Characters of a key that prefix scans look up, about 15 of the generated keys each
+const size_t PrefixLength = 2;
+
+/// @brief Hot keys that every writer increments in the contended-counter tests
+const size_t CounterKeys = 16;
+
+/// @brief Per-thread operation counter padded to its own cache line
+/// so that neighbouring threads never false-share a counter
+struct alignas(CacheLineSize) ThreadCounter
+{
+    /// @brief The number of operations completed by the owning thread
+    size_t operations;
+    /// @brief The owning thread's hardware counters over the measured phase
+    Kvs::Test::PerfCounters::Values counters;
+    /// @brief Why the owning thread's hardware counters could not be opened, if they could not
+    std::string counterError;
+    /// @brief The owning writer's Put() latency, only timed while readers scan
+    Kvs::Log2Histogram latency;
+};
+
 /// @brief This fixture captures the common data and methods for each test case
 template<typename KeyValueStoreType>
 class PerformanceFixture : public ::testing::Test,
@@ -94,14 +121,28 @@ class PerformanceFixture : public ::testing::Test,
 {
 public:
     /// @brief Setup each test by constructing the key->value store
-    PerformanceFixture() : m_stopped(false)
+    PerformanceFixture() : m_stopped(false), m_removeChurn(false), m_writerPause(0), m_fullScans(false), m_zipfianTheta(0), m_cacheAside(false), m_totalWrites(0)
     {
         this->AttachKeyValueStore(Kvs::Test::Create<KeyValueStoreType>());
     }
 
     /// @brief Populates the key->value store with a provided amount of keys
+    /// @note An Rcu store is populated in one batch rather than copied once per key
     void Populate(size_t totalKeys)
     {
+        auto rcu = std::dynamic_pointer_cast<RcuStore>(m_KeyValueStore);
+        if (rcu)
+        {
+            rcu->Update([&] (Kvs::Test::Schema::KeyValueStoreType& store)
+            {
+                for (size_t keyIndex = 0; keyIndex < totalKeys; ++keyIndex)
+                {
+                    Kvs::Test::Schema::ValueType value;
+                    store.Put(Keys[keyIndex], value);
+                }
+            });
+            return;
+        }
         for (size_t keyIndex = 0; keyIndex < totalKeys; ++keyIndex)
         {
             Kvs::Test::Schema::ValueType value;
@@ -112,86 +153,409 @@ public:
     /// @brief Kicks off the provided number of reader and writer threads and collects the results
     void RunTests(size_t readerThreads, size_t writerThreads, size_t secondsToRun, size_t totalKeys)
     {
-        std::vector<size_t> reads(readerThreads);
-        std::vector<size_t> writes(writerThreads);
+        std::vector<ThreadCounter> reads(readerThreads);
+        std::vector<ThreadCounter> writes(writerThreads);
+        std::vector<std::vector<uint32_t>> streams;
+        for (size_t i = 0; i < readerThreads + writerThreads; ++i)
+        {
+            if (m_zipfianTheta)
+            {
+                streams.emplace_back(Kvs::Test::Workload::MakeZipfianKeyIndexStream(Seed + i, totalKeys, m_zipfianTheta, KeyIndexStreamLength));
+            }
+            else
+            {
+                streams.emplace_back(Kvs::Test::MakeKeyIndexStream(Seed + i, totalKeys, KeyIndexStreamLength));
+            }
+        }
         std::vector<std::thread> threads;
         std::promise<void> startSignal;
         std::shared_future<void> startFlag(startSignal.get_future());
         for (size_t i = 0; i < readerThreads; ++i)
         {
+            const auto& stream = streams[i];
             threads.emplace_back(
-                [=, &reads] { this->ReaderThread(startFlag, totalKeys, reads[i]); }
+                [=, &reads, &stream] { this->ReaderThread(startFlag, stream, reads[i]); }
             );
         }
         for (size_t i = 0; i < writerThreads; ++i)
         {
+            const auto& stream = streams[readerThreads + i];
             threads.emplace_back(
-                [=, &writes] { this->WriterThread(startFlag, totalKeys, writes[i]); }
+                [=, &writes, &stream] { this->WriterThread(startFlag, stream, writes[i]); }
             );
         }
+        Kvs::Lock::Instrumentation::ResetAll(); // leave out populating
         startSignal.set_value(); // and they're off!
         std::this_thread::sleep_for(std::chrono::seconds(secondsToRun));
         this->StopThreads();
         std::for_each(threads.begin(), threads.end(),
             [] (std::thread& th) { if (th.joinable()) th.join(); }
         );
-        size_t totalReads = std::accumulate(reads.begin(), reads.end(), 0);
-        size_t totalWrites = std::accumulate(writes.begin(), writes.end(), 0);
+        auto contention = Kvs::Lock::Instrumentation::Sum();
+        auto sum = [] (size_t total, const ThreadCounter& counter) { return total + counter.operations; };
+        size_t totalReads = std::accumulate(reads.begin(), reads.end(), size_t(0), sum);
+        size_t totalWrites = std::accumulate(writes.begin(), writes.end(), size_t(0), sum);
+        m_totalWrites = totalWrites;
         size_t totalThoughput = totalReads + totalWrites;
+        Kvs::Log2Histogram writeLatency;
+        for (const auto& counter : writes)
+        {
+            writeLatency += counter.latency;
+        }
+        Kvs::Test::PerfCounters::Values counters = Kvs::Test::PerfCounters::Values();
+        for (const auto* threadCounters : { &reads, &writes })
+        {
+            for (const auto& counter : *threadCounters)
+            {
+                counters += counter.counters;
+                TestResultsCounters.RecordError(counter.counterError);
+            }
+        }
         GTEST_COUT << "Total Reads : " << totalReads
                   << " (" << totalReads/secondsToRun << " reads/sec)" << std::endl;
         GTEST_COUT << "Total Writes: " << totalWrites
                   << " (" << totalWrites/secondsToRun << " writes/sec)" << std::endl;
+        if (writeLatency.Samples())
+        {
+            GTEST_COUT << "Put p99/max < " << writeLatency.Percentile(99)
+                       << "/" << writeLatency.Percentile(100) << " ns" << std::endl;
+        }
 
         const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
-        TestResultsReadThroughput[test_info->name()].insert(std::make_pair(test_info->type_param(), totalReads/secondsToRun));
-        TestResultsWriteThroughput[test_info->name()].insert(std::make_pair(test_info->type_param(), totalWrites/secondsToRun));
-        TestResultsTotalThroughput[test_info->name()].insert(std::make_pair(test_info->type_param(), totalThoughput/secondsToRun));
+        TestResultsReadThroughput.Record(test_info->name(), test_info->type_param(), totalReads/secondsToRun);
+        TestResultsWriteThroughput.Record(test_info->name(), test_info->type_param(), totalWrites/secondsToRun);
+        TestResultsTotalThroughput.Record(test_info->name(), test_info->type_param(), totalThoughput/secondsToRun);
+        TestResultsCounters.Record(test_info->name(), test_info->type_param(), counters, totalThoughput);
+        if (contention.acquisitions)
+        {
+            TestResultsContention.Record(test_info->name(), test_info->type_param(), contention, secondsToRun);
+        }
+        PrintStatistics();
+        PrintCacheStats<CacheStore<Kvs::Eviction::Clock>>();
+        PrintCacheStats<CacheStore<Kvs::Eviction::SegmentedLru>>();
+        PrintCacheStats<CacheStore<Kvs::Eviction::S3Fifo>>();
+    }
+
+    /// @brief Prints what a cache counted, if the store is one of the provided type
+    template <typename CacheType>
+    void PrintCacheStats() const
+    {
+        auto cache = std::dynamic_pointer_cast<CacheType>(m_KeyValueStore);
+        if (!cache)
+        {
+            return;
+        }
+        auto stats = cache->GetStats();
+        GTEST_COUT << "Cache hit ratio: " << stats.HitRatio()
+                   << " (" << stats.hits << " hits, " << stats.misses << " misses)"
+                   << ", " << stats.evictions << " evictions of " << cache->GetCapacity() << " keys" << std::endl;
+    }
+
+    /// @brief Prints what a Statistics decorated store counted, including Compound back-end skew
+    void PrintStatistics() const
+    {
+        auto statistics = std::dynamic_pointer_cast<StatisticsStore>(m_KeyValueStore);
+        if (!statistics)
+        {
+            return;
+        }
+        using Stats = Kvs::KeyValueStore::OperationStats;
+        auto stats = statistics->GetStats();
+        GTEST_COUT << "Get hit ratio: " << stats.GetHitRatio()
+                   << ", Get p50/p99 < " << stats.latency[Stats::Get].Percentile(50)
+                   << "/" << stats.latency[Stats::Get].Percentile(99) << " ns"
+                   << ", Put p50/p99 < " << stats.latency[Stats::Put].Percentile(50)
+                   << "/" << stats.latency[Stats::Put].Percentile(99) << " ns" << std::endl;
+        auto compound = std::dynamic_pointer_cast<CompoundStore>(statistics->GetKeyValueStore());
+        if (!compound)
+        {
+            return;
+        }
+        auto backEnds = Kvs::KeyValueStore::GetBackEndStats(*compound);
+        size_t totalSize = 0, maxSize = 0;
+        uint64_t totalAccesses = 0, maxAccesses = 0;
+        for (const auto& backEnd : backEnds)
+        {
+            totalSize += backEnd.size;
+            maxSize = std::max(maxSize, backEnd.size);
+            totalAccesses += backEnd.accesses;
+            maxAccesses = std::max(maxAccesses, backEnd.accesses);
+        }
+        if (!backEnds.empty() && totalSize && totalAccesses)
+        {
+            GTEST_COUT << backEnds.size() << " back-ends, busiest holds " << maxSize * backEnds.size() / double(totalSize)
+                       << "x the mean size and takes " << maxAccesses * backEnds.size() / double(totalAccesses)
+                       << "x the mean accesses" << std::endl;
+        }
     }
 
-    /// @brief Starts a reader thread that just performs Get()s
-    void ReaderThread(std::shared_future<void> start, size_t totalKeys, size_t& reads)
+    /// @brief Starts a reader thread that performs Get()s, or full ForEach() scans when scanning,
+    /// or scans of the keys sharing a prefix with the next key when prefix scanning;
+    /// a Get() that misses is followed by a Put() of the key when caching aside
+    /// @note The count is kept in a local and published once so the
+    /// measured loop never writes to memory shared with other threads
+    void ReaderThread(std::shared_future<void> start, const std::vector<uint32_t>& stream, ThreadCounter& reads)
     {
-        reads = 0;
+        size_t count = 0;
+        size_t position = 0;
+        Kvs::Test::PerfCounters perfCounters;
         start.wait();
-        while (!m_stopped)
+        perfCounters.Start();
+        while (!m_stopped.load(std::memory_order_relaxed))
         {
-            size_t keyIndex = rand() % totalKeys;
+            if (m_fullScans)
+            {
+                m_KeyValueStore->ForEach([] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType&) { });
+                ++count;
+                continue;
+            }
+            if (m_prefixScan)
+            {
+                m_prefixScan(Keys[stream[position++ & (KeyIndexStreamLength - 1)]]);
+                ++count;
+                continue;
+            }
+            size_t keyIndex = stream[position++ & (KeyIndexStreamLength - 1)];
             Kvs::Test::Schema::ValueType value;
-            m_KeyValueStore->Get(Keys[keyIndex], value);
-            ++reads;
+            if (!m_KeyValueStore->Get(Keys[keyIndex], value) && m_cacheAside)
+            {
+                m_KeyValueStore->Put(Keys[keyIndex], value);
+            }
+            ++count;
         }
+        perfCounters.Stop();
+        reads.operations = count;
+        reads.counters = perfCounters.Read();
+        reads.counterError = perfCounters.Error();
     }
 
-    /// @brief Starts a writer thread that just performs Put()s
-    void WriterThread(std::shared_future<void> start, size_t totalKeys, size_t& writes)
+    /// @brief Starts a writer thread that performs Put()s, or alternately
+    /// Remove()s and re-Put()s each key when churning, or increments each key when counting
+    /// @note The count is kept in a local and published once so the
+    /// measured loop never writes to memory shared with other threads
+    void WriterThread(std::shared_future<void> start, const std::vector<uint32_t>& stream, ThreadCounter& writes)
     {
-        writes = 0;
+        size_t count = 0;
+        Kvs::Log2Histogram latency;
+        size_t position = 0;
+        Kvs::Test::PerfCounters perfCounters;
         start.wait();
-        while (!m_stopped)
+        perfCounters.Start();
+        while (!m_stopped.load(std::memory_order_relaxed))
         {
-            size_t keyIndex = rand() % totalKeys;
+            size_t keyIndex = stream[position++ & (KeyIndexStreamLength - 1)];
             Kvs::Test::Schema::ValueType value;
-            m_KeyValueStore->Put(Keys[keyIndex], value);
-            ++writes;
+            if (m_removeChurn)
+            {
+                m_KeyValueStore->Remove(Keys[keyIndex]);
+                ++count;
+            }
+            if (m_fullScans)
+            {
+                auto start = std::chrono::steady_clock::now();
+                m_KeyValueStore->Put(Keys[keyIndex], value);
+                latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            else if (m_increment)
+            {
+                m_increment(Keys[keyIndex]);
+            }
+            else
+            {
+                m_KeyValueStore->Put(Keys[keyIndex], value);
+            }
+            ++count;
+            if (m_writerPause.count())
+            {
+                std::this_thread::sleep_for(m_writerPause);
+            }
         }
+        perfCounters.Stop();
+        writes.operations = count;
+        writes.latency = latency;
+        writes.counters = perfCounters.Read();
+        writes.counterError = perfCounters.Error();
     }
 
-    /// @brief Sets the boolean that tells threads to stop running
+    /// @brief Sets the flag that tells threads to stop running
     void StopThreads()
     {
-        m_stopped = true;
+        m_stopped.store(true, std::memory_order_relaxed);
     }
 
 protected:
 
-    /// @brief boolean to inform threads to stop running
-    bool m_stopped;
+    /// @brief flag to inform threads to stop running
+    std::atomic<bool> m_stopped;
+
+    /// @brief flag to make writers remove every key before putting it back
+    bool m_removeChurn;
+
+    /// @brief how long writers sleep after each write, zero for not at all
+    std::chrono::milliseconds m_writerPause;
+
+    /// @brief flag to make readers scan the whole store instead of Get()ting keys
+    bool m_fullScans;
+
+    /// @brief if set, readers scan the keys sharing a prefix with each key instead of Get()ting it
+    std::function<void(const Kvs::Test::Schema::KeyType&)> m_prefixScan;
+
+    /// @brief skew of the Zipfian distribution threads pick keys from, zero for uniformly
+    double m_zipfianTheta;
+
+    /// @brief flag to make readers Put() every key their Get() missed, as in front of a slower service
+    bool m_cacheAside;
+
+    /// @brief if set, writers increment the value of each key with it instead of Put()ting it
+    std::function<void(const Kvs::Test::Schema::KeyType&)> m_increment;
+
+    /// @brief The writes counted by the last RunTests()
+    size_t m_totalWrites;
+};
+
+/// @brief This fixture runs the writers with heavy Remove() churn, so
+/// stores that free nodes on Remove() do so as fast as writers can go
+template<typename KeyValueStoreType>
+class ChurnFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Setup each test with churning writers
+    ChurnFixture()
+    {
+        this->m_removeChurn = true;
+    }
+};
+
+/// @brief This fixture runs readers that scan the whole store over and
+/// over, to show how much a long ForEach() holds writers back
+/// @note Read throughput is counted in full scans
+template<typename KeyValueStoreType>
+class ScanFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Setup each test with scanning readers
+    ScanFixture()
+    {
+        this->m_fullScans = true;
+    }
+};
+
+/// @brief This fixture runs readers that scan the few keys sharing the
+/// first PrefixLength characters with each key, for stores that can
+/// find a prefix without visiting every key
+/// @note Read throughput is counted in prefix scans
+template<typename KeyValueStoreType>
+class PrefixScanFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Setup each test with prefix scanning readers
+    PrefixScanFixture()
+    {
+        auto visit = [] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType&) { };
+        if (auto trie = dynamic_cast<GnuTrieStore*>(this->m_KeyValueStore.get()))
+        {
+            this->m_prefixScan = [=] (const Kvs::Test::Schema::KeyType& key) { trie->ForEachPrefix(Prefix(key), visit); };
+        }
+        if (auto art = dynamic_cast<ArtStore*>(this->m_KeyValueStore.get()))
+        {
+            this->m_prefixScan = [=] (const Kvs::Test::Schema::KeyType& key) { art->ForEachPrefix(Prefix(key), visit); };
+        }
+    }
+
+    /// @brief The first PrefixLength characters of a key
+    static Kvs::Test::Schema::KeyType Prefix(const Kvs::Test::Schema::KeyType& key)
+    {
+        Kvs::Test::Schema::KeyType prefix = { };
+        memcpy(prefix.field, key.field, PrefixLength);
+        return prefix;
+    }
+};
+
+/// @brief This fixture uses the store as a cache in front of a slower
+/// service: readers Put() the keys they miss, and every thread picks
+/// keys from a Zipfian distribution so that a few keys are hot
+/// @note A read that misses is counted once, with its Put()
+template<typename KeyValueStoreType>
+class CacheAsideFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Setup each test with cache-aside readers and skewed keys
+    CacheAsideFixture()
+    {
+        this->m_zipfianTheta = CacheZipfianTheta;
+        this->m_cacheAside = true;
+    }
+};
+
+/// @brief This fixture models a read-mostly table: a writer that only
+/// updates now and then while readers scale up to every core
+template<typename KeyValueStoreType>
+class ReadScalingFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Setup each test with an occasional writer
+    ReadScalingFixture()
+    {
+        this->m_writerPause = std::chrono::milliseconds(250);
+    }
+
+    /// @brief One reader per core
+    static size_t AllCores()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+};
+
+/// @brief This fixture runs writers that all increment the same few
+/// counters, either with a Get() then a Put(), which loses the increments
+/// of writers that interleave, or with a single Upsert()
+/// @note Write throughput is counted in increments
+template<typename KeyValueStoreType>
+class CounterFixture : public PerformanceFixture<KeyValueStoreType>
+{
+public:
+    /// @brief Makes writers increment with a Get() then a Put()
+    void IncrementWithGetThenPut()
+    {
+        auto store = this->m_KeyValueStore.get();
+        this->m_increment = [=] (const Kvs::Test::Schema::KeyType& key)
+            {
+                Kvs::Test::Schema::ValueType value = Kvs::Test::Schema::ValueType();
+                store->Get(key, value);
+                ++value.field2;
+                store->Put(key, value);
+            };
+    }
+
+    /// @brief Makes writers increment with an Upsert()
+    void IncrementWithUpsert()
+    {
+        auto store = this->m_KeyValueStore.get();
+        this->m_increment = [=] (const Kvs::Test::Schema::KeyType& key)
+            {
+                store->Upsert(key, [] (Kvs::Test::Schema::ValueType& value, bool) { ++value.field2; return true; });
+            };
+    }
+
+    /// @brief Prints and returns the increments the counters are missing
+    size_t CountLostIncrements() const
+    {
+        size_t counted = 0;
+        this->m_KeyValueStore->ForEach([&] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType& value)
+            {
+                counted += value.field2;
+            } );
+        const size_t lost = this->m_totalWrites - counted;
+        GTEST_COUT << "Lost increments: " << lost << " of " << this->m_totalWrites << std::endl;
+        return lost;
+    }
 };
 
 /// @brief add new Key Value Store implementations using Kvs::Test::Schema here:
 /// @note that multi-threaded Kvs::Lock::None tests are not correct and may crash
 typedef ::testing::Types<
+    Kvs::Test::NoOp<Kvs::Lock::None>,
     Kvs::Test::StdMap<Kvs::Lock::StdMutex>,
     Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
     Kvs::Test::GnuTrie<Kvs::Lock::StdMutex>,
@@ -214,7 +578,28 @@ typedef ::testing::Types<
     Kvs::Test::Compound_GnuTrie_GnuTree<Kvs::Lock::StdMutex>,
     Kvs::Test::Compound_GnuTrie_GnuTrie<Kvs::Lock::StdMutex>,
     Kvs::Test::Compound_GnuTrie_GnuCcHashTable<Kvs::Lock::StdMutex>,
-    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::StdMutex>
+    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Stats_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Stats_Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::Instrumented<Kvs::Lock::StdMutex>>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::Instrumented<Kvs::Lock::Spin>>,
+    Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::Instrumented<Kvs::Lock::StdMutex>>,
+    Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::Instrumented<Kvs::Lock::Spin>>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_EpochHashTable_EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::SkipList<Kvs::Lock::StdMutex>,
+    Kvs::Test::SkipList<Kvs::Lock::Spin>,
+    Kvs::Test::Art<Kvs::Lock::StdMutex>,
+    Kvs::Test::BTree<Kvs::Lock::None>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>,
+    Kvs::Test::RobinHood<Kvs::Lock::StdMutex>,
+    Kvs::Test::Hopscotch<Kvs::Lock::StdMutex>,
+    Kvs::Test::Expiring_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Lsm_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::BlockedBloom_Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::CountingBloom_Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_Art_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_Art_Art<Kvs::Lock::StdMutex>
 > KeyValueStoreTypes;
 
 TYPED_TEST_CASE(PerformanceFixture, KeyValueStoreTypes);
@@ -251,4 +636,163 @@ TYPED_TEST(PerformanceFixture, MultipleReadersMultipleWriters)
     this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
 }
 
+/// @brief Stores compared under Remove() churn: locked readers against epoch readers,
+/// and open addressing with tombstones against open addressing without
+typedef ::testing::Types<
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::Spin>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::Spin>,
+    Kvs::Test::GnuGpHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::RobinHood<Kvs::Lock::StdMutex>,
+    Kvs::Test::Hopscotch<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_EpochHashTable_EpochHashTable<Kvs::Lock::StdMutex>
+> ChurnKeyValueStoreTypes;
+
+TYPED_TEST_CASE(ChurnFixture, ChurnKeyValueStoreTypes);
+
+TYPED_TEST(ChurnFixture, MultipleReadersRemoveChurn)
+{
+    const size_t ReaderThreads = 3;
+    const size_t WriterThreads = 1;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+/// @brief Stores compared on a read-mostly table: locked readers against lock-free readers
+typedef ::testing::Types<
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::Spin>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Rcu_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::GnuTree<Kvs::Lock::StdMutex>,
+    Kvs::Test::BTree<Kvs::Lock::None>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>
+> ReadScalingKeyValueStoreTypes;
+
+TYPED_TEST_CASE(ReadScalingFixture, ReadScalingKeyValueStoreTypes);
+
+TYPED_TEST(ReadScalingFixture, SingleReaderOccasionalWriter)
+{
+    const size_t ReaderThreads = 1;
+    const size_t WriterThreads = 1;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+TYPED_TEST(ReadScalingFixture, AllCoresReadersOccasionalWriter)
+{
+    const size_t ReaderThreads = this->AllCores();
+    const size_t WriterThreads = 1;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+/// @brief Caches compared on skewed keys: the eviction policies against
+/// the stores they are built on, which hold every key
+typedef ::testing::Types<
+    Kvs::Test::Cache_Clock<Kvs::Lock::StdMutex>,
+    Kvs::Test::Cache_SegmentedLru<Kvs::Lock::StdMutex>,
+    Kvs::Test::Cache_S3Fifo<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>
+> CacheAsideKeyValueStoreTypes;
+
+TYPED_TEST_CASE(CacheAsideFixture, CacheAsideKeyValueStoreTypes);
+
+TYPED_TEST(CacheAsideFixture, SingleReaderSingleWriter)
+{
+    const size_t ReaderThreads = 1;
+    const size_t WriterThreads = 1;
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+TYPED_TEST(CacheAsideFixture, MultipleReadersSingleWriter)
+{
+    const size_t ReaderThreads = 3;
+    const size_t WriterThreads = 1;
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+/// @brief Stores compared on writes during full scans: locked scans against chunked snapshot scans
+typedef ::testing::Types<
+    Kvs::Test::StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Mvcc<Kvs::Lock::StdMutex>
+> ScanKeyValueStoreTypes;
+
+TYPED_TEST_CASE(ScanFixture, ScanKeyValueStoreTypes);
+
+TYPED_TEST(ScanFixture, SingleScannerSingleWriter)
+{
+    const size_t ReaderThreads = 1;
+    const size_t WriterThreads = 1;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+TYPED_TEST(ScanFixture, MultipleScannersMultipleWriters)
+{
+    const size_t ReaderThreads = 2;
+    const size_t WriterThreads = 2;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+/// @brief Stores compared on prefix scans: the trie against the adaptive radix tree
+typedef ::testing::Types<
+    Kvs::Test::GnuTrie<Kvs::Lock::StdMutex>,
+    Kvs::Test::Art<Kvs::Lock::StdMutex>
+> PrefixScanKeyValueStoreTypes;
+
+TYPED_TEST_CASE(PrefixScanFixture, PrefixScanKeyValueStoreTypes);
+
+TYPED_TEST(PrefixScanFixture, SinglePrefixScannerSingleWriter)
+{
+    const size_t ReaderThreads = 1;
+    const size_t WriterThreads = 1;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+TYPED_TEST(PrefixScanFixture, MultiplePrefixScannersMultipleWriters)
+{
+    const size_t ReaderThreads = 2;
+    const size_t WriterThreads = 2;
+    this->Populate(TotalKeys);
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, TotalKeys);
+}
+
+/// @brief Stores compared on contended counters: locked stores against lock-free ones
+typedef ::testing::Types<
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::EpochHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::SkipList<Kvs::Lock::StdMutex>,
+    Kvs::Test::BTree<Kvs::Lock::None>,
+    Kvs::Test::Cuckoo<Kvs::Lock::None>
+> CounterKeyValueStoreTypes;
+
+TYPED_TEST_CASE(CounterFixture, CounterKeyValueStoreTypes);
+
+TYPED_TEST(CounterFixture, MultipleWritersGetThenPut)
+{
+    const size_t ReaderThreads = 0;
+    const size_t WriterThreads = 4;
+    this->IncrementWithGetThenPut();
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, CounterKeys);
+    this->CountLostIncrements();
+}
+
+TYPED_TEST(CounterFixture, MultipleWritersUpsert)
+{
+    const size_t ReaderThreads = 0;
+    const size_t WriterThreads = 4;
+    this->IncrementWithUpsert();
+    this->RunTests(ReaderThreads, WriterThreads, SecondsToRun, CounterKeys);
+    EXPECT_EQ(this->CountLostIncrements(), 0u);
+}
+
 } // namespace anonymous
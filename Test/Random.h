@@ -0,0 +1,64 @@
+/// @file
+/// @brief Defines and implements the Kvs::Test::XorShift random number generator
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Kvs { namespace Test {
+
+/// @brief A small and fast pseudo random number generator (xorshift64*)
+/// Unlike rand() it keeps its state in the object rather than behind a
+/// process-wide lock, so each thread can own one without serializing.
+class XorShift
+{
+public:
+    /// @brief Construct with the provided seed (zero is replaced since it is a fixed point)
+    explicit XorShift(uint64_t seed)
+        : m_state(seed ? seed : 0x9E3779B97F4A7C15ull)
+    {
+
+    }
+
+    /// @brief Returns the next pseudo random number
+    uint64_t operator()()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1Dull;
+    }
+
+    /// @brief Returns a pseudo random number in the range [0, bound)
+    uint64_t Next(uint64_t bound)
+    {
+        return (*this)() % bound;
+    }
+
+    /// @brief Returns a pseudo random number in the range [0.0, 1.0)
+    double NextDouble()
+    {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+protected:
+    /// @brief The generator state
+    uint64_t m_state;
+};
+
+/// @brief Precomputes a stream of key indexes in the range [0, totalKeys)
+/// so that measured loops only read the next index instead of generating one
+inline std::vector<uint32_t> MakeKeyIndexStream(uint64_t seed, size_t totalKeys, size_t length)
+{
+    XorShift random(seed);
+    std::vector<uint32_t> stream(length);
+    for (auto& keyIndex : stream)
+    {
+        keyIndex = static_cast<uint32_t>(random.Next(totalKeys));
+    }
+    return stream;
+}
+
+} } // namespace Kvs::Test
@@ -0,0 +1,62 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+#include <future>
+#include <thread>
+
+namespace // anonymous
+{
+
+using RcuStore = Kvs::KeyValueStore::Rcu<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType,
+    Kvs::KeyValueStore::StdUnorderedMap<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Hash::Jenkins::OneAtATime<Kvs::Test::Schema::KeyType>, Kvs::Lock::None>,
+    Kvs::Lock::StdMutex>;
+
+} // namespace anonymous
+
+TEST(Rcu, UpdateAppliesBatch)
+{
+    auto store = std::dynamic_pointer_cast<RcuStore>(
+        Kvs::Test::Create<Kvs::Test::Rcu_StdUnorderedMap<Kvs::Lock::StdMutex>>());
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    store->Update([&] (Kvs::TypedKeyValueStore<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType>& next) {
+        next.Put(key1, value);
+        next.Put(key2, value);
+        // nothing of the batch is visible until it is published
+        EXPECT_EQ(store->Size(), 0);
+    });
+    EXPECT_EQ(store->Size(), 2);
+    EXPECT_FALSE(store->Remove(key1) && store->Remove(key1));
+    EXPECT_EQ(store->Size(), 1);
+}
+
+TEST(Rcu, ForEachSeesOneVersion)
+{
+    auto store = Kvs::Test::Create<Kvs::Test::Rcu_StdUnorderedMap<Kvs::Lock::StdMutex>>();
+    auto& objectToTest = dynamic_cast<Kvs::Test::Schema::KeyValueStoreType&>(*store);
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    objectToTest.Put(key1, value);
+    std::promise<void> iterating;
+    std::promise<void> updated;
+    size_t visited = 0;
+    std::thread reader([&] {
+        objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType&, const Kvs::Test::Schema::ValueType&) {
+            iterating.set_value();
+            updated.get_future().wait();
+            ++visited;
+        });
+    });
+    iterating.get_future().wait();
+    // the writer neither waits for the reader nor changes what it iterates
+    objectToTest.Put(key2, value);
+    objectToTest.Remove(key1);
+    updated.set_value();
+    reader.join();
+    EXPECT_EQ(visited, 1);
+    EXPECT_EQ(objectToTest.Size(), 1);
+    EXPECT_FALSE(objectToTest.Get(key1, value));
+}
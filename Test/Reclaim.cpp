@@ -0,0 +1,77 @@
+#include "Kvs/Reclaim/Epoch.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace // anonymous
+{
+
+/// @brief Counts its own destruction so tests can tell when the epoch freed it
+struct Counted
+{
+    explicit Counted(std::atomic<int>& freed) : m_freed(freed) { }
+    ~Counted() { ++m_freed; }
+    std::atomic<int>& m_freed;
+};
+
+} // namespace anonymous
+
+TEST(Epoch, FreesAfterSynchronize)
+{
+    std::atomic<int> freed(0);
+    Kvs::Reclaim::Epoch::Retire(new Counted(freed));
+    Kvs::Reclaim::Epoch::Retire(new Counted(freed));
+    EXPECT_EQ(freed, 0);
+    Kvs::Reclaim::Epoch::Synchronize();
+    EXPECT_EQ(freed, 2);
+    EXPECT_EQ(Kvs::Reclaim::Epoch::Pending(), 0);
+}
+
+TEST(Epoch, GuardsNest)
+{
+    auto start = Kvs::Reclaim::Epoch::Current();
+    {
+        Kvs::Reclaim::Epoch::Guard outer;
+        {
+            Kvs::Reclaim::Epoch::Guard inner;
+        }
+    }
+    // both guards have been left, so nothing holds the epoch back
+    Kvs::Reclaim::Epoch::Synchronize();
+    EXPECT_GE(Kvs::Reclaim::Epoch::Current(), start + 2);
+}
+
+TEST(Epoch, ReaderDelaysReclamation)
+{
+    std::atomic<int> freed(0);
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::thread reader([&] {
+        Kvs::Reclaim::Epoch::Guard guard;
+        entered.set_value();
+        release.get_future().wait();
+    });
+    entered.get_future().wait();
+    for (size_t i = 0; i < 4 * Kvs::Reclaim::Epoch::BatchSize; ++i)
+    {
+        Kvs::Reclaim::Epoch::Retire(new Counted(freed));
+    }
+    // batches tried to reclaim, but the reader has held the epoch throughout
+    EXPECT_EQ(freed, 0);
+    release.set_value();
+    reader.join();
+    Kvs::Reclaim::Epoch::Synchronize();
+    EXPECT_EQ(freed, 4 * Kvs::Reclaim::Epoch::BatchSize);
+}
+
+TEST(Epoch, AdoptsObjectsOfExitedThreads)
+{
+    std::atomic<int> freed(0);
+    std::thread retirer([&] {
+        Kvs::Reclaim::Epoch::Retire(new Counted(freed));
+    });
+    retirer.join();
+    Kvs::Reclaim::Epoch::Synchronize();
+    EXPECT_EQ(freed, 1);
+}
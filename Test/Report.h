@@ -0,0 +1,322 @@
+/// @file
+/// @brief Defines and implements the Kvs::Test::ThroughputReport, Kvs::Test::CounterReport,
+/// Kvs::Test::MemoryReport and Kvs::Test::ContentionReport classes
+
+#pragma once
+
+#include "gtestcout.h"
+#include "PerfCounters.h"
+#include "Footprint.h"
+#include "Kvs/Lock/Instrumented.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <set>
+#include <map>
+#include <vector>
+
+namespace Kvs { namespace Test {
+
+/// @brief Collects throughput results per test case and prints them ranked
+class ThroughputReport
+{
+public:
+
+    /// @brief Records the throughput of one key->value store type in one test case
+    void Record(const std::string& testCase, const std::string& storeType, size_t opsPerSec)
+    {
+        m_results[testCase].insert(std::make_pair(storeType, opsPerSec));
+    }
+
+    /// @brief Prints every test case with its store types ranked by throughput
+    void Print(const std::string& title) const
+    {
+        GTEST_COUT << "*** " << title << " ***" << std::endl;
+        for (const auto& pair1 : m_results)
+        {
+            GTEST_COUT << "  Results for " << pair1.first << " test case:" << std::endl;
+            for (const auto& pair2 : pair1.second)
+            {
+                GTEST_COUT << "    " << std::setw(8) << pair2.second << " ops/sec: " << pair2.first << std::endl;
+            }
+        }
+    }
+
+protected:
+
+    /// @brief Pairs a store type with its throughput
+    using TestTypeAndThroughput_t = std::pair<std::string, size_t>;
+
+    /// @brief Orders results by descending throughput
+    struct TestTypeAndThroughputCompare
+    {
+        bool operator () (const TestTypeAndThroughput_t& lhs, const TestTypeAndThroughput_t& rhs) const
+        {
+            return lhs.second > rhs.second;
+        }
+    };
+
+    /// @brief The ranked results of a single test case
+    using TestResultsPerTestType_t = std::multiset<TestTypeAndThroughput_t, TestTypeAndThroughputCompare>;
+
+    /// @brief The results of every test case
+    std::map<std::string, TestResultsPerTestType_t> m_results;
+};
+
+/// @brief Collects hardware counters per test case and prints them normalized per operation
+class CounterReport
+{
+public:
+
+    /// @brief Records the summed counters of one key->value store type in one test case
+    void Record(const std::string& testCase, const std::string& storeType,
+                const PerfCounters::Values& values, size_t operations)
+    {
+        m_results[testCase].push_back(Entry{ storeType, values, operations });
+        m_anyValid = m_anyValid || values.Any();
+    }
+
+    /// @brief Remembers why counters could not be opened, reported if none ever were
+    void RecordError(const std::string& error)
+    {
+        if (m_error.empty())
+        {
+            m_error = error;
+        }
+    }
+
+    /// @brief Prints every test case with each store type's counters per operation
+    void Print(const std::string& title) const
+    {
+        GTEST_COUT << "*** " << title << " ***" << std::endl;
+        if (!m_anyValid)
+        {
+            GTEST_COUT << "  Hardware counters unavailable"
+                       << (m_error.empty() ? "" : " (" + m_error + ")") << std::endl;
+            return;
+        }
+        for (const auto& pair : m_results)
+        {
+            GTEST_COUT << "  Results for " << pair.first << " test case (per operation):" << std::endl;
+            GTEST_COUT << "    " << std::setw(9) << "cycles" << std::setw(9) << "instrs" << std::setw(7) << "IPC"
+                       << std::setw(9) << "LLC-miss" << std::setw(9) << "dTLB-miss" << std::setw(9) << "br-miss" << std::endl;
+            for (const auto& entry : pair.second)
+            {
+                std::ostringstream line;
+                line << std::fixed << std::setprecision(2);
+                Column(line, entry, PerfCounters::Cycles, 9);
+                Column(line, entry, PerfCounters::Instructions, 9);
+                const auto& values = entry.values;
+                if (values.valid[PerfCounters::Cycles] && values.valid[PerfCounters::Instructions]
+                    && values.counts[PerfCounters::Cycles])
+                {
+                    line << std::setw(7) << static_cast<double>(values.counts[PerfCounters::Instructions])
+                                            / values.counts[PerfCounters::Cycles];
+                }
+                else
+                {
+                    line << std::setw(7) << "n/a";
+                }
+                Column(line, entry, PerfCounters::LlcMisses, 9);
+                Column(line, entry, PerfCounters::DtlbMisses, 9);
+                Column(line, entry, PerfCounters::BranchMisses, 9);
+                GTEST_COUT << "    " << line.str() << ": " << entry.storeType << std::endl;
+            }
+        }
+    }
+
+protected:
+
+    /// @brief The counters of a single store type in a single test case
+    struct Entry
+    {
+        std::string storeType;
+        PerfCounters::Values values;
+        size_t operations;
+    };
+
+    /// @brief Prints one event normalized per operation, or n/a
+    static void Column(std::ostream& line, const Entry& entry, PerfCounters::Event event, int width)
+    {
+        if (entry.values.valid[event] && entry.operations)
+        {
+            line << std::setw(width) << static_cast<double>(entry.values.counts[event]) / entry.operations;
+        }
+        else
+        {
+            line << std::setw(width) << "n/a";
+        }
+    }
+
+    /// @brief The results of every test case
+    std::map<std::string, std::vector<Entry>> m_results;
+
+    /// @brief Whether any recorded run counted anything
+    bool m_anyValid = false;
+
+    /// @brief The first reason counters could not be opened
+    std::string m_error;
+};
+
+/// @brief Collects memory footprints per test case and prints them ranked by bytes per entry
+class MemoryReport
+{
+public:
+
+    /// @brief Records the footprint of one key->value store type in one test case
+    void Record(const std::string& testCase, const std::string& storeType, const Footprint& footprint)
+    {
+        m_results[testCase].push_back(std::make_pair(storeType, footprint));
+    }
+
+    /// @brief Prints every test case, then what each Compound front-end adds over its back-end alone
+    void Print(const std::string& title) const
+    {
+        GTEST_COUT << "*** " << title << " ***" << std::endl;
+        for (const auto& pair : m_results)
+        {
+            auto entries = pair.second;
+            std::sort(entries.begin(), entries.end(),
+                [] (const Entry_t& lhs, const Entry_t& rhs) { return lhs.second.BytesPerEntry() < rhs.second.BytesPerEntry(); }
+            );
+            GTEST_COUT << "  Results for " << pair.first << " test case:" << std::endl;
+            GTEST_COUT << "    " << std::setw(12) << "bytes/entry" << std::setw(13) << "allocs/entry"
+                       << std::setw(13) << "peak heap MB" << std::setw(13) << "peak RSS MB" << std::endl;
+            for (const auto& entry : entries)
+            {
+                const auto& footprint = entry.second;
+                std::ostringstream line;
+                line << std::fixed << std::setprecision(1)
+                     << std::setw(12) << footprint.BytesPerEntry()
+                     << std::setw(13) << footprint.AllocationsPerEntry()
+                     << std::setw(13) << footprint.peakHeapBytes / 1048576.0;
+                if (footprint.rssAvailable)
+                {
+                    line << std::setw(13) << footprint.peakRssBytes / 1048576.0;
+                }
+                else
+                {
+                    line << std::setw(13) << "n/a";
+                }
+                GTEST_COUT << "    " << line.str() << ": " << entry.first << std::endl;
+            }
+            PrintFrontEndOverhead(pair.second);
+        }
+    }
+
+protected:
+
+    /// @brief Pairs a store type with its footprint
+    using Entry_t = std::pair<std::string, Footprint>;
+
+    /// @brief Prints the bytes per entry each Compound store needs beyond its stand-alone back-end
+    static void PrintFrontEndOverhead(const std::vector<Entry_t>& entries)
+    {
+        bool header = false;
+        for (const auto& entry : entries)
+        {
+            auto backEnd = CompoundBackEndName(entry.first);
+            auto match = std::find_if(entries.begin(), entries.end(),
+                [&] (const Entry_t& other) { return !backEnd.empty() && other.first == backEnd; }
+            );
+            if (match == entries.end())
+            {
+                continue;
+            }
+            if (!header)
+            {
+                GTEST_COUT << "    Compound front-end overhead over the stand-alone back-end:" << std::endl;
+                header = true;
+            }
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(1) << std::setw(12)
+                 << entry.second.BytesPerEntry() - match->second.BytesPerEntry();
+            GTEST_COUT << "    " << line.str() << " bytes/entry: " << entry.first << std::endl;
+        }
+    }
+
+    /// @brief The results of every test case
+    std::map<std::string, std::vector<Entry_t>> m_results;
+};
+
+/// @brief Collects lock contention per test case and prints it ranked by contended ratio
+class ContentionReport
+{
+public:
+
+    /// @brief Records the summed contention of one key->value store type's locks in one test case
+    void Record(const std::string& testCase, const std::string& storeType,
+                const Kvs::Lock::ContentionStats& stats, size_t seconds)
+    {
+        m_results[testCase].push_back(Entry{ storeType, stats, seconds });
+    }
+
+    /// @brief Prints every test case, or nothing if no instrumented lock was used
+    void Print(const std::string& title) const
+    {
+        if (m_results.empty())
+        {
+            return;
+        }
+        GTEST_COUT << "*** " << title << " ***" << std::endl;
+        for (const auto& pair : m_results)
+        {
+            auto entries = pair.second;
+            std::sort(entries.begin(), entries.end(),
+                [] (const Entry& lhs, const Entry& rhs) { return lhs.stats.ContendedRatio() > rhs.stats.ContendedRatio(); }
+            );
+            GTEST_COUT << "  Results for " << pair.first << " test case:" << std::endl;
+            GTEST_COUT << "    " << std::setw(11) << "acquires/s" << std::setw(11) << "contended"
+                       << std::setw(10) << "wait p50" << std::setw(10) << "wait p99"
+                       << std::setw(10) << "hold p50" << std::setw(10) << "hold p99" << std::endl;
+            for (const auto& entry : entries)
+            {
+                std::ostringstream line;
+                line << std::setw(11) << entry.stats.acquisitions / std::max<size_t>(1, entry.seconds)
+                     << std::setw(10) << std::fixed << std::setprecision(2) << entry.stats.ContendedRatio() * 100 << "%"
+                     << std::setw(10) << Nanoseconds(entry.stats.waitNs.Percentile(50))
+                     << std::setw(10) << Nanoseconds(entry.stats.waitNs.Percentile(99))
+                     << std::setw(10) << Nanoseconds(entry.stats.holdNs.Percentile(50))
+                     << std::setw(10) << Nanoseconds(entry.stats.holdNs.Percentile(99));
+                GTEST_COUT << "    " << line.str() << ": " << entry.storeType << std::endl;
+            }
+        }
+        GTEST_COUT << "  (times are upper bounds of power-of-two buckets)" << std::endl;
+    }
+
+protected:
+
+    /// @brief The contention of a single store type in a single test case
+    struct Entry
+    {
+        std::string storeType;
+        Kvs::Lock::ContentionStats stats;
+        size_t seconds;
+    };
+
+    /// @brief Formats a bucket bound compactly, e.g. "<512ns" or "<33us"
+    static std::string Nanoseconds(uint64_t nanoseconds)
+    {
+        std::ostringstream text;
+        if (nanoseconds < 100000)
+        {
+            text << "<" << nanoseconds << "ns";
+        }
+        else if (nanoseconds < 100000000)
+        {
+            text << "<" << (nanoseconds + 999) / 1000 << "us";
+        }
+        else
+        {
+            text << "<" << (nanoseconds + 999999) / 1000000 << "ms";
+        }
+        return text.str();
+    }
+
+    /// @brief The results of every test case
+    std::map<std::string, std::vector<Entry>> m_results;
+};
+
+} } // namespace Kvs::Test
@@ -4,7 +4,9 @@
 #pragma once
 
 #include "Kvs/TypedKeyValueStore.h"
+#include <algorithm>
 #include <memory>
+#include <string_view>
 #include <string.h>
 
 namespace Kvs { namespace Test {
@@ -32,6 +34,22 @@ public:
         {
             return memcmp(this, &rhs, sizeof(rhs)) == 0;
         }
+
+        /// @brief Comparison operator against the characters spelling a key
+        bool operator==(std::string_view rhs) const
+        {
+            return Compare(rhs) == 0;
+        }
+
+        /// @brief Compares with the characters spelling a key as memcmp() compares keys:
+        /// as if the characters were followed by zeros, and cut to the key's size
+        int Compare(std::string_view rhs) const
+        {
+            static const char Zeros[sizeof(field)] = { };
+            const size_t size = std::min(rhs.size(), sizeof(field));
+            const int compared = size ? memcmp(field, rhs.data(), size) : 0;
+            return compared ? compared : memcmp(field + size, Zeros, sizeof(field) - size);
+        }
     };
 
     /// @brief Defines the value which are a group of fake fields
@@ -56,11 +74,26 @@ public:
     /// @brief A comparison functor for Schema::KeyType
     struct CompareKeyType
     {
+        /// @brief Declares that keys may be compared with the characters spelling a key too
+        using is_transparent = void;
+
         /// @brief The comparison function
         bool operator()(const KeyType& lhs, const KeyType& rhs) const
         {
             return memcmp(&lhs, &rhs, sizeof(rhs)) < 0;
         }
+
+        /// @brief The comparison function against the characters spelling a key
+        bool operator()(const KeyType& lhs, std::string_view rhs) const
+        {
+            return lhs.Compare(rhs) < 0;
+        }
+
+        /// @brief The comparison function of the characters spelling a key against a key
+        bool operator()(std::string_view lhs, const KeyType& rhs) const
+        {
+            return rhs.Compare(lhs) > 0;
+        }
     };
 
     /// @brief Definition of a TypedKeyValueStore with the key and value types provided
@@ -0,0 +1,75 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+namespace // anonymous
+{
+
+/// @brief Makes a key that sorts by the provided index
+Kvs::Test::Schema::KeyType MakeKey(size_t index)
+{
+    Kvs::Test::Schema::KeyType key = { };
+    snprintf(key.field, sizeof(key.field), "key%06zu", index);
+    return key;
+}
+
+} // namespace anonymous
+
+TEST(SkipList, ForEachIsOrdered)
+{
+    auto store = Kvs::Test::Create<Kvs::Test::SkipList<Kvs::Lock::None>>();
+    auto& objectToTest = dynamic_cast<Kvs::Test::Schema::KeyValueStoreType&>(*store);
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    const size_t Keys = 1000;
+    for (size_t i = 0; i < Keys; ++i)
+    {
+        // insert out of order
+        objectToTest.Put(MakeKey((i * 7919) % Keys), value);
+    }
+    EXPECT_EQ(objectToTest.Size(), Keys);
+    size_t index = 0;
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType&) {
+        EXPECT_EQ(key, MakeKey(index));
+        ++index;
+    });
+    EXPECT_EQ(index, Keys);
+}
+
+TEST(SkipList, ConcurrentPutsAndRemoves)
+{
+    auto store = Kvs::Test::Create<Kvs::Test::SkipList<Kvs::Lock::Spin>>();
+    auto& objectToTest = dynamic_cast<Kvs::Test::Schema::KeyValueStoreType&>(*store);
+    const size_t Threads = 4;
+    const size_t KeysPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < Threads; ++thread)
+    {
+        threads.emplace_back([&, thread] {
+            Kvs::Test::Schema::ValueType value = { 3.14, thread, 'p' };
+            // interleave the threads' keys so they write next to each other
+            for (size_t i = 0; i < KeysPerThread; ++i)
+            {
+                objectToTest.Put(MakeKey(i * Threads + thread), value);
+            }
+            for (size_t i = 0; i < KeysPerThread; i += 2)
+            {
+                EXPECT_TRUE(objectToTest.Remove(MakeKey(i * Threads + thread)));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(objectToTest.Size(), Threads * KeysPerThread / 2);
+    size_t visited = 0;
+    Kvs::Test::Schema::KeyType previous = { };
+    objectToTest.ForEach([&] (const Kvs::Test::Schema::KeyType& key, const Kvs::Test::Schema::ValueType& value) {
+        EXPECT_TRUE(Kvs::Test::Schema::CompareKeyType()(previous, key));
+        previous = key;
+        ++visited;
+    });
+    EXPECT_EQ(visited, Threads * KeysPerThread / 2);
+}
@@ -0,0 +1,92 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Kvs/KeyValueStore/Statistics.h"
+#include "gtest/gtest.h"
+
+namespace // anonymous
+{
+
+using Stats = Kvs::KeyValueStore::OperationStats;
+using StatisticsStore = Kvs::KeyValueStore::Statistics<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType>;
+using CompoundStore = Kvs::KeyValueStore::Compound<Kvs::Test::Schema::KeyType, Kvs::Test::Schema::ValueType, Kvs::Lock::None>;
+
+} // namespace anonymous
+
+TEST(Statistics, CountsOperations)
+{
+    auto store = std::dynamic_pointer_cast<StatisticsStore>(
+        Kvs::Test::Create<Kvs::Test::Stats_StdUnorderedMap<Kvs::Lock::None>>());
+    ASSERT_TRUE(store);
+    Kvs::Test::Schema::KeyType key1 = { "test1" };
+    Kvs::Test::Schema::KeyType key2 = { "test2" };
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    EXPECT_TRUE(store->Put(key1, value));
+    EXPECT_TRUE(store->Get(key1, value));
+    EXPECT_FALSE(store->Get(key2, value));
+    EXPECT_FALSE(store->Remove(key2));
+    EXPECT_TRUE(store->Remove(key1));
+    EXPECT_EQ(store->Size(), 0);
+    auto stats = store->GetStats();
+    EXPECT_EQ(stats.calls[Stats::Put], 1);
+    EXPECT_EQ(stats.successes[Stats::Put], 1);
+    EXPECT_EQ(stats.calls[Stats::Get], 2);
+    EXPECT_EQ(stats.successes[Stats::Get], 1);
+    EXPECT_EQ(stats.GetHitRatio(), 0.5);
+    EXPECT_EQ(stats.calls[Stats::Remove], 2);
+    EXPECT_EQ(stats.successes[Stats::Remove], 1);
+    EXPECT_EQ(stats.calls[Stats::Size], 1);
+    EXPECT_EQ(stats.Accesses(), 5);
+    // the first call of each timed operation is always sampled
+    EXPECT_EQ(stats.latency[Stats::Put].Samples(), 1);
+    EXPECT_EQ(stats.latency[Stats::Get].Samples(), 1);
+    EXPECT_GT(stats.latency[Stats::Get].Percentile(50), 0);
+}
+
+TEST(Statistics, LatencyBuckets)
+{
+    EXPECT_EQ(Kvs::Log2Histogram::Bucket(0), 0);
+    EXPECT_EQ(Kvs::Log2Histogram::Bucket(1), 1);
+    EXPECT_EQ(Kvs::Log2Histogram::Bucket(100), 7);
+    EXPECT_EQ(Kvs::Log2Histogram::Bucket(128), 8);
+    EXPECT_EQ(Kvs::Log2Histogram::Bucket(~uint64_t(0)), Kvs::Log2Histogram::BucketCount - 1);
+    Kvs::Log2Histogram histogram;
+    histogram.Record(100);
+    histogram.Record(100);
+    histogram.Record(1000);
+    EXPECT_EQ(histogram.Samples(), 3);
+    EXPECT_EQ(histogram.Percentile(50), 128);
+    EXPECT_EQ(histogram.Percentile(99), 1024);
+}
+
+TEST(Statistics, CompoundBackEnds)
+{
+    auto store = std::dynamic_pointer_cast<StatisticsStore>(
+        Kvs::Test::Create<Kvs::Test::Stats_Compound_ArrayTable_StdMap<Kvs::Lock::None>>());
+    ASSERT_TRUE(store);
+    auto compound = std::dynamic_pointer_cast<CompoundStore>(store->GetKeyValueStore());
+    ASSERT_TRUE(compound);
+    Kvs::Test::Schema::KeyType keyA1 = { "a1" };
+    Kvs::Test::Schema::KeyType keyA2 = { "a2" };
+    Kvs::Test::Schema::KeyType keyB1 = { "b1" };
+    Kvs::Test::Schema::ValueType value = { 3.14, 3, 'p' };
+    EXPECT_TRUE(store->Put(keyA1, value));
+    EXPECT_TRUE(store->Put(keyA2, value));
+    EXPECT_TRUE(store->Put(keyB1, value));
+    EXPECT_TRUE(store->Get(keyA1, value));
+    auto backEnds = Kvs::KeyValueStore::GetBackEndStats(*compound);
+    ASSERT_EQ(backEnds.size(), 2);
+    for (const auto& backEnd : backEnds)
+    {
+        if (backEnd.frontEndKey.field[0] == 'a')
+        {
+            EXPECT_EQ(backEnd.size, 2);
+            EXPECT_EQ(backEnd.accesses, 3);
+        }
+        else
+        {
+            EXPECT_EQ(backEnd.size, 1);
+            EXPECT_EQ(backEnd.accesses, 1);
+        }
+    }
+    EXPECT_EQ(store->GetStats().Accesses(), 4);
+}
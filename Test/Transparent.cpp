@@ -0,0 +1,131 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Random.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace // anonymous
+{
+
+using Key = Kvs::Test::Schema::KeyType;
+
+/// @brief Keys held by the stores the benchmark looks up, and lookups per way of looking up
+const size_t BenchmarkKeys = 1 << 16;
+const size_t BenchmarkGets = 1 << 18;
+
+/// @brief Characters spelling each key, as a slice of a received message would hold them
+const size_t KeyCharacters = 12;
+
+/// @brief Writes the characters spelling the key of the provided index, whose first bytes
+/// vary so a Compound store spreads keys over its back-ends
+void Spell(size_t index, char* characters)
+{
+    char spelled[KeyCharacters + 1];
+    snprintf(spelled, sizeof(spelled), "%c%c%c%09zu", char('A' + index % 26), char('A' + index / 26 % 26), char('A' + index / 676 % 26), index);
+    memcpy(characters, spelled, KeyCharacters);
+}
+
+/// @brief The ways the benchmark looks a key up from its characters
+enum class Lookup
+{
+    MakeKeyThenGet,
+    GetCharacters,
+    ContainsCharacters
+};
+
+const char* Name(Lookup lookup)
+{
+    switch (lookup)
+    {
+        case Lookup::MakeKeyThenGet: return "MakeKey+Get";
+        case Lookup::GetCharacters: return "Get(string_view)";
+        default: return "Contains(string_view)";
+    }
+}
+
+/// @brief Returns the nanoseconds per lookup of the keys spelled in the buffer, looked up the provided way
+double TimeLookups(const Kvs::Test::Schema::KeyValueStoreType& store, const std::string& buffer, Lookup lookup)
+{
+    // the best of a few rounds, since the first pays for faulting pages in
+    double best = 0.0;
+    for (size_t round = 0; round < 3; ++round)
+    {
+        size_t found = 0;
+        Kvs::Test::Schema::ValueType value;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < buffer.size(); offset += KeyCharacters)
+        {
+            const std::string_view characters(buffer.data() + offset, KeyCharacters);
+            switch (lookup)
+            {
+                case Lookup::MakeKeyThenGet: found += store.Get(Kvs::MakeKey<Key>(characters), value); break;
+                case Lookup::GetCharacters: found += store.Get(characters, value); break;
+                case Lookup::ContainsCharacters: found += store.Contains(characters); break;
+            }
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_EQ(found, BenchmarkGets);
+        best = round && best < elapsed.count() ? best : elapsed.count();
+    }
+    return best / BenchmarkGets;
+}
+
+/// @brief Prints the cost of looking up keys by their characters in the store created by the factory
+template <typename KeyValueStoreType>
+void Benchmark(const char* name)
+{
+    auto objectToTest = Kvs::Test::Factory<KeyValueStoreType>::Create();
+    Kvs::Test::Schema::ValueType value = { 3.14, 0, 'p' };
+    char characters[KeyCharacters];
+    for (size_t i = 0; i < BenchmarkKeys; ++i)
+    {
+        Spell(i, characters);
+        ASSERT_TRUE(objectToTest->Put(Kvs::MakeKey<Key>(std::string_view(characters, KeyCharacters)), value));
+    }
+    Kvs::Test::XorShift random(1);
+    std::string buffer(BenchmarkGets * KeyCharacters, '\0');
+    for (size_t offset = 0; offset < buffer.size(); offset += KeyCharacters)
+    {
+        Spell(random.Next(BenchmarkKeys), &buffer[offset]);
+    }
+    GTEST_COUT << name << ": ";
+    for (Lookup lookup : { Lookup::MakeKeyThenGet, Lookup::GetCharacters, Lookup::ContainsCharacters })
+    {
+        std::cout << TimeLookups(*objectToTest, buffer, lookup) << " ns/" << Name(lookup)
+                  << (lookup == Lookup::ContainsCharacters ? "\n" : ", ");
+    }
+}
+
+} // namespace anonymous
+
+TEST(Transparent, CharactersHashAndCompareAsTheirKey)
+{
+    Kvs::Hash::Jenkins::OneAtATime<Key> hash;
+    Kvs::Hash::FirstByte<Key> firstByte;
+    Kvs::Test::Schema::CompareKeyType less;
+    for (std::string_view characters : { "", "a", "test", "0123456789abcdefghijklmnopqrstuv", "0123456789abcdefghijklmnopqrstuvwxyz" })
+    {
+        const Key key = Kvs::MakeKey<Key>(characters);
+        EXPECT_EQ(hash(characters), hash(key));
+        EXPECT_EQ(firstByte(characters), firstByte(key));
+        EXPECT_TRUE(key == characters);
+        EXPECT_FALSE(less(key, characters));
+        EXPECT_FALSE(less(characters, key));
+    }
+    const Key key = { "test" };
+    EXPECT_TRUE(less(std::string_view("tes"), key));
+    EXPECT_TRUE(less(key, std::string_view("test1")));
+    EXPECT_TRUE(less(key, std::string_view("tesu")));
+    EXPECT_FALSE(key == std::string_view("test1"));
+}
+
+TEST(Transparent, LookupLatencyByCharacters)
+{
+    Benchmark<Kvs::Test::StdMap<Kvs::Lock::None>>("StdMap");
+    Benchmark<Kvs::Test::StdUnorderedMap<Kvs::Lock::None>>("StdUnorderedMap");
+    Benchmark<Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::None>>("Compound_ArrayTable_StdMap");
+}
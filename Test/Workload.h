@@ -0,0 +1,556 @@
+/// @file
+/// @brief Defines and implements a YCSB-style workload generator and driver
+
+#pragma once
+
+#include "Schema.h"
+#include "Random.h"
+#include "Histogram.h"
+#include "PerfCounters.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Kvs { namespace Test { namespace Workload {
+
+/// @brief Generates the provided number of random, zero-padded keys
+inline std::vector<Schema::KeyType> GenerateKeys(uint64_t seed, size_t totalKeys)
+{
+    XorShift random(seed);
+    std::vector<Schema::KeyType> keys;
+    keys.reserve(totalKeys);
+    for (size_t keyIndex = 0; keyIndex < totalKeys; ++keyIndex)
+    {
+        Schema::KeyType key;
+        auto buffer = reinterpret_cast<uint8_t*>(&key);
+        memset(buffer, 0, sizeof(key));
+        auto keyLength = random.Next(sizeof(key)-1) + 1;
+        for (size_t c = 0; c < keyLength; ++c)
+        {
+            buffer[c] = 'A' + random.Next('Z' - 'A');
+        }
+        keys.emplace_back(key);
+    }
+    return keys;
+}
+
+/// @brief The ways a key can be chosen for a request
+enum class Distribution
+{
+    Uniform,    ///< every loaded key is equally likely
+    Zipfian,    ///< a few loaded keys are very popular, the rest are not
+    Latest,     ///< the most recently inserted keys are the most popular
+    Hotspot     ///< a fixed fraction of requests goes to a fixed fraction of keys
+};
+
+/// @brief The kinds of request a workload issues
+enum class Operation : uint8_t
+{
+    Read,
+    Update,
+    Insert,
+    Scan,
+    ReadModifyWrite,
+    Count       ///< not an operation, the number of operations
+};
+
+/// @brief Returns a printable name for the provided operation
+inline const char* Name(Operation operation)
+{
+    switch (operation)
+    {
+        case Operation::Read:            return "read";
+        case Operation::Update:          return "update";
+        case Operation::Insert:          return "insert";
+        case Operation::Scan:            return "scan";
+        case Operation::ReadModifyWrite: return "readmodifywrite";
+        default:                         return "unknown";
+    }
+}
+
+/// @brief Returns a printable name for the provided distribution
+inline const char* Name(Distribution distribution)
+{
+    switch (distribution)
+    {
+        case Distribution::Uniform: return "uniform";
+        case Distribution::Zipfian: return "zipfian";
+        case Distribution::Latest:  return "latest";
+        case Distribution::Hotspot: return "hotspot";
+        default:                    return "unknown";
+    }
+}
+
+/// @brief Describes the request mix and key distribution of a workload
+struct Mix
+{
+    /// @{
+    /// Proportion of each operation; they should add up to 1.0
+    double read;
+    double update;
+    double insert;
+    double scan;
+    double readModifyWrite;
+    /// @}
+
+    /// @brief How the key of each request is chosen
+    Distribution distribution;
+
+    /// @brief Skew of the Zipfian and Latest distributions, in (0, 1)
+    double zipfianTheta;
+
+    /// @brief Fraction of the keys that are hot in the Hotspot distribution
+    double hotSetFraction;
+
+    /// @brief Fraction of the requests that go to hot keys in the Hotspot distribution
+    double hotOperationFraction;
+
+    /// @brief Scans read a uniformly chosen number of keys in [1, maxScanLength]
+    size_t maxScanLength;
+
+    /// @brief Returns a copy of this mix using the provided distribution
+    Mix With(Distribution newDistribution) const
+    {
+        Mix mix = *this;
+        mix.distribution = newDistribution;
+        return mix;
+    }
+};
+
+/// @brief Returns a mix with the provided operation proportions and YCSB's default settings
+inline Mix MakeMix(double read, double update, double insert, double scan, double readModifyWrite,
+                   Distribution distribution)
+{
+    Mix mix;
+    mix.read = read;
+    mix.update = update;
+    mix.insert = insert;
+    mix.scan = scan;
+    mix.readModifyWrite = readModifyWrite;
+    mix.distribution = distribution;
+    mix.zipfianTheta = 0.99;
+    mix.hotSetFraction = 0.2;
+    mix.hotOperationFraction = 0.8;
+    mix.maxScanLength = 100;
+    return mix;
+}
+
+/// @brief The standard YCSB core workloads
+/// @note Scans read consecutive keys in load order since
+/// Kvs::TypedKeyValueStore has no ordered range interface
+/// @{
+/// @brief Update heavy: 50% reads, 50% updates
+inline Mix WorkloadA() { return MakeMix(0.50, 0.50, 0.00, 0.00, 0.00, Distribution::Zipfian); }
+/// @brief Read mostly: 95% reads, 5% updates
+inline Mix WorkloadB() { return MakeMix(0.95, 0.05, 0.00, 0.00, 0.00, Distribution::Zipfian); }
+/// @brief Read only: 100% reads
+inline Mix WorkloadC() { return MakeMix(1.00, 0.00, 0.00, 0.00, 0.00, Distribution::Zipfian); }
+/// @brief Read latest: 95% reads, 5% inserts, recent keys are popular
+inline Mix WorkloadD() { return MakeMix(0.95, 0.00, 0.05, 0.00, 0.00, Distribution::Latest); }
+/// @brief Short ranges: 95% scans, 5% inserts
+inline Mix WorkloadE() { return MakeMix(0.00, 0.00, 0.05, 0.95, 0.00, Distribution::Zipfian); }
+/// @brief Read-modify-write: 50% reads, 50% read-modify-writes
+inline Mix WorkloadF() { return MakeMix(0.50, 0.00, 0.00, 0.00, 0.50, Distribution::Zipfian); }
+/// @}
+
+/// @brief Generates Zipfian distributed ranks in [0, items) where rank 0 is the most popular
+/// Based on "Quickly Generating Billion-Record Synthetic Databases" by Gray et al.,
+/// which is also what YCSB uses.
+class Zipfian
+{
+public:
+    /// @brief Constructor, O(items) to compute the zeta constant
+    Zipfian(uint64_t items, double theta)
+        : m_items(items)
+        , m_theta(theta)
+        , m_alpha(1.0 / (1.0 - theta))
+        , m_zetaN(Zeta(items, theta))
+    {
+        double zeta2 = Zeta(2, theta);
+        m_eta = (1.0 - std::pow(2.0 / items, 1.0 - theta)) / (1.0 - zeta2 / m_zetaN);
+        m_threshold = 1.0 + std::pow(0.5, theta);
+    }
+
+    /// @brief Returns the next rank
+    uint64_t Next(XorShift& random) const
+    {
+        double u = random.NextDouble();
+        double uz = u * m_zetaN;
+        if (uz < 1.0)
+        {
+            return 0;
+        }
+        if (uz < m_threshold)
+        {
+            return 1;
+        }
+        auto rank = static_cast<uint64_t>(m_items * std::pow(m_eta * u - m_eta + 1.0, m_alpha));
+        return rank < m_items ? rank : m_items - 1;
+    }
+
+protected:
+
+    /// @brief Computes the generalized harmonic number of order theta
+    static double Zeta(uint64_t items, double theta)
+    {
+        double sum = 0.0;
+        for (uint64_t i = 1; i <= items; ++i)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+    /// @brief Number of distinct ranks
+    uint64_t m_items;
+    /// @brief Skew
+    double m_theta;
+    /// @brief Precomputed 1 / (1 - theta)
+    double m_alpha;
+    /// @brief Precomputed zeta(items, theta)
+    double m_zetaN;
+    /// @brief Precomputed eta constant
+    double m_eta;
+    /// @brief Precomputed 1 + 0.5^theta
+    double m_threshold;
+};
+
+/// @brief Precomputes a stream of Zipfian distributed key indexes, index 0 the most popular
+inline std::vector<uint32_t> MakeZipfianKeyIndexStream(uint64_t seed, size_t totalKeys, double theta, size_t length)
+{
+    XorShift random(seed);
+    Zipfian zipfian(totalKeys, theta);
+    std::vector<uint32_t> stream(length);
+    for (auto& keyIndex : stream)
+    {
+        keyIndex = static_cast<uint32_t>(zipfian.Next(random));
+    }
+    return stream;
+}
+
+/// @brief A single precomputed request
+struct Request
+{
+    /// @brief What to do
+    Operation operation;
+    /// @brief Number of keys to read when operation is Operation::Scan
+    uint16_t scanLength;
+    /// @brief Key index, or a rank relative to the newest key for Distribution::Latest
+    uint32_t key;
+};
+
+/// @brief Precomputes a stream of requests so that measured loops
+/// do no more than read the next one
+/// @note Inserts carry no key since they must claim a fresh one at run time
+inline std::vector<Request> MakeRequestStream(const Mix& mix, size_t recordCount, uint64_t seed, size_t length)
+{
+    XorShift random(seed);
+    Zipfian zipfian(recordCount, mix.zipfianTheta);
+    uint64_t hotKeys = std::max<uint64_t>(1, static_cast<uint64_t>(recordCount * mix.hotSetFraction));
+    std::vector<Request> stream(length);
+    for (auto& request : stream)
+    {
+        double choice = random.NextDouble();
+        if ((choice -= mix.read) < 0)
+        {
+            request.operation = Operation::Read;
+        }
+        else if ((choice -= mix.update) < 0)
+        {
+            request.operation = Operation::Update;
+        }
+        else if ((choice -= mix.insert) < 0)
+        {
+            request.operation = Operation::Insert;
+        }
+        else if ((choice -= mix.scan) < 0)
+        {
+            request.operation = Operation::Scan;
+        }
+        else
+        {
+            request.operation = Operation::ReadModifyWrite;
+        }
+        request.scanLength = static_cast<uint16_t>(random.Next(mix.maxScanLength) + 1);
+        switch (mix.distribution)
+        {
+            case Distribution::Uniform:
+                request.key = random.Next(recordCount);
+                break;
+            case Distribution::Zipfian:
+            case Distribution::Latest:
+                request.key = zipfian.Next(random);
+                break;
+            case Distribution::Hotspot:
+                if (random.NextDouble() < mix.hotOperationFraction || hotKeys == recordCount)
+                {
+                    request.key = random.Next(hotKeys);
+                }
+                else
+                {
+                    request.key = hotKeys + random.Next(recordCount - hotKeys);
+                }
+                break;
+        }
+    }
+    return stream;
+}
+
+/// @brief The outcome of running a workload
+struct Result
+{
+    /// @brief Completed requests per operation
+    std::array<size_t, static_cast<size_t>(Operation::Count)> operations;
+
+    /// @brief Keys read by all completed scans
+    size_t scannedKeys;
+
+    /// @brief Latency in nanoseconds of a sample of the requests
+    Histogram latency;
+
+    /// @brief Hardware counters summed over all threads, if they were available
+    PerfCounters::Values counters;
+
+    /// @brief Why hardware counters could not be opened, if they could not
+    std::string counterError;
+
+    /// @brief How long the workload ran
+    double seconds;
+
+    /// @brief Total completed requests
+    size_t Total() const
+    {
+        size_t total = 0;
+        for (auto count : operations)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    /// @brief Completed requests per second
+    size_t Throughput() const
+    {
+        return static_cast<size_t>(Total() / seconds);
+    }
+};
+
+/// @brief Loads a key->value store and drives a workload mix against it from several threads
+class Driver
+{
+public:
+
+    /// @brief Length of the precomputed request stream each thread cycles through
+    /// @note Must be a power of two so the stream position can wrap with a mask
+    static const size_t RequestStreamLength = 1 << 16;
+
+    /// @brief One in this many requests has its latency measured
+    /// @note Must be a power of two; sampling keeps clock reads off most requests
+    static const size_t LatencySampleInterval = 64;
+
+    /// @brief Constructor
+    /// @param keys the key pool; the first recordCount keys are loaded and
+    /// the remainder is claimed by inserts (wrapping around when exhausted)
+    Driver(Schema::KeyValueStoreSharedPtr keyValueStore,
+           const std::vector<Schema::KeyType>& keys,
+           const Mix& mix,
+           size_t recordCount)
+        : m_keyValueStore(keyValueStore)
+        , m_keys(keys)
+        , m_mix(mix)
+        , m_recordCount(recordCount)
+        , m_inserted(recordCount)
+        , m_stopped(false)
+    {
+
+    }
+
+    /// @brief Puts the first recordCount keys
+    void Load()
+    {
+        Schema::ValueType value = Schema::ValueType();
+        for (size_t keyIndex = 0; keyIndex < m_recordCount; ++keyIndex)
+        {
+            m_keyValueStore->Put(m_keys[keyIndex], value);
+        }
+    }
+
+    /// @brief Runs the workload from the provided number of threads for the provided duration
+    Result Run(size_t threadCount, std::chrono::milliseconds duration, uint64_t seed)
+    {
+        std::vector<ThreadOperations> counters(threadCount);
+        std::vector<std::vector<Request>> streams;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            streams.emplace_back(MakeRequestStream(m_mix, m_recordCount, seed + i, RequestStreamLength));
+        }
+        std::vector<std::thread> threads;
+        std::promise<void> startSignal;
+        std::shared_future<void> startFlag(startSignal.get_future());
+        m_stopped.store(false, std::memory_order_relaxed);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            const auto& stream = streams[i];
+            auto& counter = counters[i];
+            threads.emplace_back(
+                [=, &stream, &counter] { this->WorkerThread(startFlag, stream, counter); }
+            );
+        }
+        auto start = std::chrono::steady_clock::now();
+        startSignal.set_value(); // and they're off!
+        std::this_thread::sleep_for(duration);
+        m_stopped.store(true, std::memory_order_relaxed);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        Result result = Result();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& counter : counters)
+        {
+            for (size_t op = 0; op < counter.operations.size(); ++op)
+            {
+                result.operations[op] += counter.operations[op];
+            }
+            result.scannedKeys += counter.scannedKeys;
+            result.latency.Merge(counter.latency);
+            result.counters += counter.counters;
+            if (result.counterError.empty())
+            {
+                result.counterError = counter.counterError;
+            }
+        }
+        return result;
+    }
+
+protected:
+
+    /// @brief Per-thread operation counters padded to their own cache lines
+    struct alignas(64) ThreadOperations
+    {
+        /// @brief Completed requests per operation
+        std::array<size_t, static_cast<size_t>(Operation::Count)> operations;
+        /// @brief Keys read by all completed scans
+        size_t scannedKeys;
+        /// @brief Latency in nanoseconds of a sample of the requests
+        Histogram latency;
+        /// @brief Hardware counters over the measured phase
+        PerfCounters::Values counters;
+        /// @brief Why hardware counters could not be opened, if they could not
+        std::string counterError;
+    };
+
+    /// @brief Resolves the key index of a read, update, scan or read-modify-write request
+    size_t KeyIndex(const Request& request) const
+    {
+        if (m_mix.distribution == Distribution::Latest)
+        {
+            size_t newest = m_inserted.load(std::memory_order_relaxed) - 1;
+            return (newest - request.key) % m_keys.size();
+        }
+        return request.key;
+    }
+
+    /// @brief Issues a single request
+    void Execute(const Request& request, Schema::ValueType& value, size_t& scannedKeys)
+    {
+        switch (request.operation)
+        {
+            case Operation::Read:
+                m_keyValueStore->Get(m_keys[KeyIndex(request)], value);
+                break;
+            case Operation::Update:
+                m_keyValueStore->Put(m_keys[KeyIndex(request)], value);
+                break;
+            case Operation::Insert:
+            {
+                size_t keyIndex = m_inserted.fetch_add(1, std::memory_order_relaxed) % m_keys.size();
+                m_keyValueStore->Put(m_keys[keyIndex], value);
+                break;
+            }
+            case Operation::Scan:
+            {
+                size_t keyIndex = KeyIndex(request);
+                for (size_t i = 0; i < request.scanLength; ++i)
+                {
+                    m_keyValueStore->Get(m_keys[(keyIndex + i) % m_keys.size()], value);
+                }
+                scannedKeys += request.scanLength;
+                break;
+            }
+            case Operation::ReadModifyWrite:
+            {
+                const auto& key = m_keys[KeyIndex(request)];
+                m_keyValueStore->Get(key, value);
+                ++value.field2;
+                m_keyValueStore->Put(key, value);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /// @brief Issues requests from the provided stream until stopped
+    /// @note Counts are kept in locals and published once so the
+    /// measured loop never writes to memory shared with other threads
+    void WorkerThread(std::shared_future<void> start, const std::vector<Request>& stream, ThreadOperations& counter)
+    {
+        std::array<size_t, static_cast<size_t>(Operation::Count)> operations = {};
+        size_t scannedKeys = 0;
+        size_t position = 0;
+        Histogram latency;
+        PerfCounters perfCounters;
+        Schema::ValueType value = Schema::ValueType();
+        start.wait();
+        perfCounters.Start();
+        while (!m_stopped.load(std::memory_order_relaxed))
+        {
+            const Request& request = stream[position & (RequestStreamLength - 1)];
+            if ((position & (LatencySampleInterval - 1)) == 0)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                Execute(request, value, scannedKeys);
+                auto elapsed = std::chrono::steady_clock::now() - begin;
+                latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            }
+            else
+            {
+                Execute(request, value, scannedKeys);
+            }
+            ++operations[static_cast<size_t>(request.operation)];
+            ++position;
+        }
+        perfCounters.Stop();
+        counter.operations = operations;
+        counter.scannedKeys = scannedKeys;
+        counter.latency = latency;
+        counter.counters = perfCounters.Read();
+        counter.counterError = perfCounters.Error();
+    }
+
+    /// @brief The key->value store under test
+    Schema::KeyValueStoreSharedPtr m_keyValueStore;
+
+    /// @brief The key pool
+    const std::vector<Schema::KeyType>& m_keys;
+
+    /// @brief The request mix
+    Mix m_mix;
+
+    /// @brief Number of keys loaded before running
+    size_t m_recordCount;
+
+    /// @brief Number of keys claimed so far by loading and inserts
+    std::atomic<size_t> m_inserted;
+
+    /// @brief flag to inform threads to stop running
+    std::atomic<bool> m_stopped;
+};
+
+} } } // namespace Kvs::Test::Workload
@@ -0,0 +1,163 @@
+#include "Schema.h"
+#include "Factories.h"
+#include "Workload.h"
+#include "Report.h"
+#include "Kvs/KeyValueStoreUser.h"
+#include "gtest/gtest.h"
+#include "gtestcout.h"
+#include <vector>
+#include <chrono>
+
+namespace // anonymous
+{
+
+/// @brief Keys loaded before each workload runs
+const size_t RecordCount = 10000;
+
+/// @brief Keys available to inserts beyond the loaded ones
+const size_t InsertHeadroom = 10000;
+
+/// @brief Number of threads issuing requests
+const size_t WorkerThreads = 4;
+
+/// @brief How long each workload runs
+const std::chrono::milliseconds TimeToRun(1000);
+
+/// @brief The shared key pool, generated once in YcsbEnvironment::SetUp()
+static std::vector<Kvs::Test::Schema::KeyType> Keys;
+
+/// @brief The seed used to generate the keys and every thread's request stream
+static uint64_t Seed;
+
+static Kvs::Test::ThroughputReport TestResultsThroughput;
+
+/// @brief The global setup/teardown class
+class YcsbEnvironment : public ::testing::Environment
+{
+public:
+    // Populate the static Keys container for all tests to share
+    virtual void SetUp()
+    {
+        Seed = time(nullptr);
+        Keys = Kvs::Test::Workload::GenerateKeys(Seed, RecordCount + InsertHeadroom);
+    }
+
+    virtual void TearDown()
+    {
+        GTEST_COUT << "Kvs::Test::NoOp is the calibration baseline: "
+                   << "the most the harness itself can drive" << std::endl;
+        TestResultsThroughput.Print("YCSB Throughput");
+    }
+};
+
+/// @brief This call registers the global test environment data
+auto env = ::testing::AddGlobalTestEnvironment(new YcsbEnvironment);
+
+/// @brief This fixture captures the common data and methods for each test case
+template<typename KeyValueStoreType>
+class YcsbFixture : public ::testing::Test,
+                              public Kvs::KeyValueStoreUser<Kvs::Test::Schema>
+{
+public:
+    /// @brief Setup each test by constructing the key->value store
+    YcsbFixture()
+    {
+        this->AttachKeyValueStore(Kvs::Test::Create<KeyValueStoreType>());
+    }
+
+    /// @brief Loads the store, runs the provided mix and records the results
+    void RunWorkload(const Kvs::Test::Workload::Mix& mix)
+    {
+        Kvs::Test::Workload::Driver driver(m_KeyValueStore, Keys, mix, RecordCount);
+        driver.Load();
+        auto result = driver.Run(WorkerThreads, TimeToRun, Seed);
+        for (size_t op = 0; op < result.operations.size(); ++op)
+        {
+            if (result.operations[op])
+            {
+                GTEST_COUT << Kvs::Test::Workload::Name(static_cast<Kvs::Test::Workload::Operation>(op))
+                           << ": " << result.operations[op] << std::endl;
+            }
+        }
+        GTEST_COUT << "Total: " << result.Total()
+                   << " (" << result.Throughput() << " ops/sec, "
+                   << Kvs::Test::Workload::Name(mix.distribution) << ")" << std::endl;
+
+        const auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        TestResultsThroughput.Record(test_info->name(), test_info->type_param(), result.Throughput());
+    }
+};
+
+/// @brief add new Key Value Store implementations using Kvs::Test::Schema here:
+/// @note that multi-threaded Kvs::Lock::None tests are not correct and may crash
+typedef ::testing::Types<
+    Kvs::Test::NoOp<Kvs::Lock::None>,
+    Kvs::Test::StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::GnuTrie<Kvs::Lock::StdMutex>,
+    Kvs::Test::GnuTree<Kvs::Lock::StdMutex>,
+    Kvs::Test::GnuCcHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::GnuGpHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuTree<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuTrie<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuCcHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_StdUnorderedMap_GnuGpHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_GnuTree<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_GnuTrie<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_GnuCcHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_ArrayTable_GnuGpHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_StdMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_StdUnorderedMap<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_GnuTree<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_GnuTrie<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_GnuCcHashTable<Kvs::Lock::StdMutex>,
+    Kvs::Test::Compound_GnuTrie_GnuGpHashTable<Kvs::Lock::StdMutex>
+> KeyValueStoreTypes;
+
+TYPED_TEST_CASE(YcsbFixture, KeyValueStoreTypes);
+
+TYPED_TEST(YcsbFixture, WorkloadA)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadA());
+}
+
+TYPED_TEST(YcsbFixture, WorkloadAUniform)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadA().With(Kvs::Test::Workload::Distribution::Uniform));
+}
+
+TYPED_TEST(YcsbFixture, WorkloadAHotspot)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadA().With(Kvs::Test::Workload::Distribution::Hotspot));
+}
+
+TYPED_TEST(YcsbFixture, WorkloadB)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadB());
+}
+
+TYPED_TEST(YcsbFixture, WorkloadC)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadC());
+}
+
+TYPED_TEST(YcsbFixture, WorkloadD)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadD());
+}
+
+TYPED_TEST(YcsbFixture, WorkloadE)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadE());
+}
+
+TYPED_TEST(YcsbFixture, WorkloadF)
+{
+    this->RunWorkload(Kvs::Test::Workload::WorkloadF());
+}
+
+} // namespace anonymous